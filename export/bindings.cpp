@@ -1,17 +1,117 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
+#include "pybind11/numpy.h"
+#include "async_operations.h"
+#include "batch.h"
+#include "classifier.h"
+#include "estimate.h"
+#include "event_builder.h"
+#include "generator.h"
 #include "interval.h"
+#include "materialized_view.h"
+#include "parallel.h"
 #include "product_algebra.h"
+#include "serialization.h"
 #include "set.h"
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 namespace py = pybind11;
 
+// Convert the flat sets of simple sets from and to Python sets, like std::set.
+namespace pybind11 {
+    namespace detail {
+        template<typename Key, typename Compare>
+        struct type_caster<FlatSet<Key, Compare>> : set_caster<FlatSet<Key, Compare>, Key> {
+        };
+    }
+}
+
+/**
+ * A composite set that is computed on another thread.
+ */
+struct FutureCompositeSet {
+    std::shared_future<AbstractCompositeSetPtr_t> future;
+};
+
+/**
+ * A `BudgetScope` that Python enters and exits with a `with` statement.
+ */
+struct PythonBudgetScope {
+    ResourceBudget budget;
+    std::unique_ptr<BudgetScope> scope;
+    // the usage when the scope was exited
+    BudgetUsage exited_usage;
+};
+
+// Helper: The Python budget scopes entered on this thread, innermost last. A `BudgetScope` restores the control of
+//   its thread, hence the scopes have to be exited in reverse order and on the thread that entered them.
+static thread_local std::vector<const PythonBudgetScope *> entered_budget_scopes;
+
+// Helper: Convert the usage of a budget to a dictionary.
+static py::dict to_dict(const BudgetUsage &usage) {
+    py::dict result;
+    result["simple_sets"] = usage.simple_sets;
+    result["bytes"] = usage.bytes;
+    result["seconds"] = std::chrono::duration<double>(usage.elapsed).count();
+    return result;
+}
+
+// Helper: Wrap a Python progress callback such that it is called with the GIL held and released with the GIL held,
+// since it is called and destroyed on the thread of the operation.
+static ProgressCallback_t to_progress_callback(const py::object &progress) {
+    if (progress.is_none()) {
+        return nullptr;
+    }
+    auto callback = std::shared_ptr<py::object>(new py::object(progress), [](py::object *object) {
+        py::gil_scoped_acquire acquire;
+        delete object;
+    });
+    return [callback](const std::string &stage, size_t done, size_t total) {
+        py::gil_scoped_acquire acquire;
+        (*callback)(stage, done, total);
+    };
+}
+
+// Helper: convert numpy arrays (one per variable) to columns. Continuous columns are read as float64, all others as
+// int64; the converted arrays are kept in 'converted' and must outlive the use of 'column_map'.
+static size_t to_column_map(std::map<AbstractVariablePtr_t, py::array> const &columns,
+                            std::vector<py::array> &converted, ColumnMap &column_map) {
+    py::ssize_t rows = -1;
+    for (auto const &[variable, array] : columns) {
+        py::array column;
+        if (dynamic_cast<Continuous *>(variable.get()) != nullptr) {
+            auto typed = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(array);
+            if (!typed) {
+                throw py::value_error("cannot convert the column of " + *variable->name + " to float64");
+            }
+            column_map[variable] = typed.data();
+            column = typed;
+        } else {
+            auto typed = py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>::ensure(array);
+            if (!typed) {
+                throw py::value_error("cannot convert the column of " + *variable->name + " to int64");
+            }
+            column_map[variable] = typed.data();
+            column = typed;
+        }
+        if (column.ndim() != 1 || (rows >= 0 && column.shape(0) != rows)) {
+            throw py::value_error("all columns must be one dimensional and of the same length");
+        }
+        rows = column.shape(0);
+        converted.push_back(column);
+    }
+    return rows < 0 ? 0 : static_cast<size_t>(rows);
+}
+
 PYBIND11_MODULE(random_events_lib, handle) {
     handle.doc()= "A module for handling random events";
 
     py::class_<AbstractSimpleSet, std::shared_ptr<AbstractSimpleSet>>(handle, "AbstractSimpleSet")
         .def("intersection_with", &AbstractSimpleSet::intersection_with)
         .def("complement", [](AbstractSimpleSet &x){return * x.complement();})
+        .def("complement_pieces", &AbstractSimpleSet::complement_pieces)
         .def("contains", &AbstractSimpleSet::contains)
         .def("is_empty", &AbstractSimpleSet::is_empty)
         .def("difference_with", [](AbstractSimpleSet &x, AbstractSimpleSet &y) {
@@ -29,6 +129,10 @@ PYBIND11_MODULE(random_events_lib, handle) {
             [](AbstractCompositeSet &x, SimpleSetSet_t const &v){x.simple_sets = make_shared_simple_set_set(v);})
         .def("is_empty", &AbstractCompositeSet::is_empty)
         .def("is_disjoint", &AbstractCompositeSet::is_disjoint)
+        .def("intersects", &AbstractCompositeSet::intersects)
+        .def("is_disjoint_from", &AbstractCompositeSet::is_disjoint_from)
+        .def("is_subset_of", &AbstractCompositeSet::is_subset_of)
+        .def("contains", &AbstractCompositeSet::contains)
         .def("simplify", &AbstractCompositeSet::simplify)
         .def("make_disjoint", &AbstractCompositeSet::make_disjoint)
         .def("intersection_with", pybind11::overload_cast<const AbstractCompositeSetPtr_t&>(&AbstractCompositeSet::intersection_with), "Intersect this with another composite set.")
@@ -145,12 +249,12 @@ PYBIND11_MODULE(random_events_lib, handle) {
             return std::make_shared<SimpleEvent>(p);
         }))
         .def_property("variable_map", [](SimpleEvent const &x){return * x.variable_map;},
-            [](SimpleEvent x, VariableMap const &v){x.variable_map = std::make_shared<VariableMap>(v);})
+            [](SimpleEvent &x, VariableMap const &v){x.variable_map = std::make_shared<VariableMap>(v);})
         .def("marginal", [](const SimpleEvent &x, VariableSet const &y) {
             auto const p = make_shared_variable_set(y);
             return x.marginal(p);
         })
-        .def("fill_missing_variables", [](const SimpleEvent &e, const VariableSet &v) {
+        .def("fill_missing_variables", [](SimpleEvent &e, const VariableSet &v) {
             auto const p = make_shared_variable_set(v);
             e.fill_missing_variables(p);})
         .def("__hash__", [](SimpleEvent const &x) {
@@ -168,14 +272,23 @@ PYBIND11_MODULE(random_events_lib, handle) {
             return make_shared_event(p);
         }))
         .def("simplify_once", &Event::simplify_once)
-        .def("fill_missing_variables", [](const Event &e, const VariableSet &v) {
+        .def("fill_missing_variables", [](Event &e, const VariableSet &v) {
             auto const p = make_shared_variable_set(v);
             e.fill_missing_variables(p);
         })
         .def("marginal", [](const Event &x, VariableSet const &y) {
             auto const p = make_shared_variable_set(y);
             return x.marginal(p);
-        });
+        })
+        .def("contains_points", [](const Event &x, std::map<AbstractVariablePtr_t, py::array> const &columns) {
+            std::vector<py::array> converted;
+            ColumnMap column_map;
+            auto rows = to_column_map(columns, converted, column_map);
+            auto mask = x.contains_points(column_map, rows);
+            py::array_t<bool> result(static_cast<py::ssize_t>(mask.size()));
+            std::copy(mask.begin(), mask.end(), result.mutable_data());
+            return result;
+        }, "Check which points of a columnar batch (one array per variable) are contained in this event.");
 
 
     py::class_<AbstractVariable, std::shared_ptr<AbstractVariable>>(handle, "AbstractVariable")
@@ -228,4 +341,254 @@ PYBIND11_MODULE(random_events_lib, handle) {
         .def_property("name", [](Integer const &x){return *x.name;},
             [](Integer &x, std::string const &v){x.name = std::make_shared<std::string>(v);});
 
+    py::class_<EventClassifier, std::shared_ptr<EventClassifier>>(handle, "EventClassifier")
+        .def(py::init([](std::vector<EventPtr_t> const &events, size_t leaf_size, size_t max_depth) {
+            return make_shared_event_classifier(events, leaf_size, max_depth);
+        }), py::arg("events"), py::arg("leaf_size") = 4, py::arg("max_depth") = 48)
+        .def_property_readonly("variables", &EventClassifier::get_variables)
+        .def("node_count", &EventClassifier::node_count)
+        .def("depth", &EventClassifier::depth)
+        .def("classify", [](const EventClassifier &x, std::map<AbstractVariablePtr_t, py::array> const &columns,
+                            size_t threads) {
+            std::vector<py::array> converted;
+            ColumnMap column_map;
+            auto rows = to_column_map(columns, converted, column_map);
+            std::vector<std::int64_t> labels;
+            {
+                py::gil_scoped_release release;
+                labels = x.classify(column_map, rows, threads);
+            }
+            py::array_t<std::int64_t> result(static_cast<py::ssize_t>(labels.size()));
+            std::copy(labels.begin(), labels.end(), result.mutable_data());
+            return result;
+        }, py::arg("columns"), py::arg("threads") = 0,
+        "Classify a columnar batch of points (one array per variable) into the index of the event containing each "
+        "point or -1.");
+
+    py::enum_<SetOperation>(handle, "SetOperation")
+        .value("INTERSECTION", SetOperation::INTERSECTION)
+        .value("UNION", SetOperation::UNION)
+        .value("DIFFERENCE", SetOperation::DIFFERENCE)
+        .value("COMPLEMENT", SetOperation::COMPLEMENT)
+        .value("MAKE_DISJOINT", SetOperation::MAKE_DISJOINT)
+        .value("SIMPLIFY", SetOperation::SIMPLIFY);
+
+    py::class_<BatchOperation>(handle, "BatchOperation")
+        .def(py::init([](SetOperation operation, AbstractCompositeSetPtr_t const &lhs,
+                         AbstractCompositeSetPtr_t const &rhs) {
+            return BatchOperation{operation, lhs, rhs};
+        }), py::arg("operation"), py::arg("lhs"), py::arg("rhs") = nullptr)
+        .def_readwrite("operation", &BatchOperation::operation)
+        .def_readwrite("lhs", &BatchOperation::lhs)
+        .def_readwrite("rhs", &BatchOperation::rhs);
+
+    py::class_<WorkStealingExecutor, std::shared_ptr<WorkStealingExecutor>>(handle, "WorkStealingExecutor")
+        .def(py::init([](size_t threads, bool pin_threads) {
+            return make_shared_work_stealing_executor(threads, pin_threads);
+        }), py::arg("threads") = 0, py::arg("pin_threads") = false)
+        .def("size", &WorkStealingExecutor::size);
+
+    handle.def("execute_batch", [](std::vector<BatchOperation> const &operations,
+                                   WorkStealingExecutorPtr_t const &executor) {
+        py::gil_scoped_release release;
+        return execute_batch(operations, executor);
+    }, py::arg("operations"), py::arg("executor") = nullptr,
+    "Run many independent set operations on a work stealing executor and return their results in order.");
+
+    py::class_<PieceGenerator, PieceGeneratorPtr_t>(handle, "PieceGenerator")
+        .def("__iter__", [](PieceGeneratorPtr_t const &x) { return x; })
+        .def("__next__", [](PieceGenerator &x) {
+            auto piece = x.next();
+            if (piece == nullptr) {
+                throw py::stop_iteration();
+            }
+            return piece;
+        })
+        .def("count", &PieceGenerator::count, "Consume the remaining simple sets and return their number.");
+
+    handle.def("generate_complement", &generate_complement, py::arg("set"),
+               "Iterate over the complement of a composite set as disjoint simple sets, one at a time.");
+    handle.def("generate_difference", &generate_difference, py::arg("lhs"), py::arg("rhs"),
+               "Iterate over lhs \\ rhs as disjoint simple sets, one at a time.");
+
+    py::class_<EventBuilder, EventBuilderPtr_t>(handle, "EventBuilder")
+        .def(py::init())
+        .def("add", py::overload_cast<const SimpleEventPtr_t &>(&EventBuilder::add), py::arg("simple_event"),
+             "Add the elements of a simple event that are not in the event yet.")
+        .def("add", py::overload_cast<const EventPtr_t &>(&EventBuilder::add), py::arg("event"),
+             "Add the elements of every simple event of an event that are not in the event yet.")
+        .def("build", &EventBuilder::build, "Create the disjoint event of the pieces collected so far.")
+        .def("__len__", &EventBuilder::size);
+
+    py::enum_<ViewInput>(handle, "ViewInput")
+        .value("LHS", ViewInput::LHS)
+        .value("RHS", ViewInput::RHS);
+
+    py::class_<MaterializedView, MaterializedViewPtr_t>(handle, "MaterializedView")
+        .def(py::init<SetOperation, const AbstractCompositeSetPtr_t &, const AbstractCompositeSetPtr_t &>(),
+             py::arg("operation"), py::arg("lhs"), py::arg("rhs") = nullptr)
+        .def("insert", &MaterializedView::insert, py::arg("input"), py::arg("piece"),
+             "Add a piece to an operand, update the result and return the id of the piece.")
+        .def("erase", &MaterializedView::erase, py::arg("input"), py::arg("id"),
+             "Remove a piece from an operand and update the result.")
+        .def("ids", &MaterializedView::ids, py::arg("input"))
+        .def("result", &MaterializedView::result)
+        .def("__len__", &MaterializedView::size);
+
+    handle.def("serialize", [](AbstractCompositeSetPtr_t const &set) {
+        return py::bytes(serialize(set));
+    }, py::arg("set"), "Serialize an interval, set or event into compact, versioned bytes.");
+    handle.def("deserialize", [](std::string const &data) {
+        return deserialize(data);
+    }, py::arg("data"), "Deserialize an interval, set or event from bytes created by serialize.");
+    handle.def("serialize_many", [](std::vector<AbstractCompositeSetPtr_t> const &sets) {
+        std::ostringstream stream(std::ios::binary);
+        Serializer serializer(stream);
+        for (auto const &set : sets) {
+            serializer.write(set);
+        }
+        return py::bytes(stream.str());
+    }, py::arg("sets"), "Serialize many sets into one stream that stores their variables and universes once.");
+    handle.def("deserialize_many", [](std::string const &data) {
+        std::istringstream stream(data, std::ios::binary);
+        Deserializer deserializer(stream);
+        std::vector<AbstractCompositeSetPtr_t> sets;
+        while (!deserializer.at_end()) {
+            sets.push_back(deserializer.read_set());
+        }
+        return sets;
+    }, py::arg("data"), "Deserialize the sets of a stream created by serialize_many.");
+
+    py::class_<CostEstimate>(handle, "CostEstimate")
+        .def_readonly("expected_pieces", &CostEstimate::expected_pieces)
+        .def_readonly("max_pieces", &CostEstimate::max_pieces)
+        .def_readonly("work", &CostEstimate::work);
+
+    handle.def("estimate_cost", &estimate_cost, py::arg("operation"), py::arg("lhs"), py::arg("rhs") = nullptr,
+               "Predict the number of simple sets of the result and the work of an operation without running it.");
+    handle.def("estimate_overlap", [](AbstractCompositeSetPtr_t const &lhs, AbstractCompositeSetPtr_t const &rhs,
+                                      size_t samples) {
+        return estimate_overlap(*lhs, *rhs, samples);
+    }, py::arg("lhs"), py::arg("rhs"), py::arg("samples") = 256);
+
+    py::register_exception<OperationCancelled>(handle, "OperationCancelled");
+
+    py::class_<CancellationToken>(handle, "CancellationToken")
+        .def(py::init())
+        .def("cancel", &CancellationToken::cancel)
+        .def("cancel_after", [](CancellationToken &x, double seconds) {
+            x.cancel_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(seconds)));
+        }, py::arg("seconds"))
+        .def("is_cancelled", &CancellationToken::is_cancelled);
+
+    py::register_exception<BudgetExceeded>(handle, "BudgetExceeded");
+
+    py::class_<ResourceBudget>(handle, "ResourceBudget")
+        .def(py::init([](size_t max_simple_sets, size_t max_bytes, double max_seconds) {
+            ResourceBudget budget;
+            budget.max_simple_sets = max_simple_sets;
+            budget.max_bytes = max_bytes;
+            budget.max_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(max_seconds));
+            return budget;
+        }), py::arg("max_simple_sets") = 0, py::arg("max_bytes") = 0, py::arg("max_seconds") = 0.,
+        "Limits of the resources of set operations; 0 means unlimited.")
+        .def_readwrite("max_simple_sets", &ResourceBudget::max_simple_sets)
+        .def_readwrite("max_bytes", &ResourceBudget::max_bytes)
+        .def_property("max_seconds", [](const ResourceBudget &x) {
+            return std::chrono::duration<double>(x.max_duration).count();
+        }, [](ResourceBudget &x, double seconds) {
+            x.max_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(seconds));
+        });
+
+    py::class_<PythonBudgetScope>(handle, "BudgetScope")
+        .def(py::init([](const ResourceBudget &budget) { return PythonBudgetScope{budget, nullptr, {}}; }),
+             py::arg("budget"))
+        .def("__enter__", [](PythonBudgetScope &x) -> PythonBudgetScope & {
+            if (x.scope != nullptr) {
+                throw std::runtime_error("The budget scope was already entered.");
+            }
+            x.scope = std::make_unique<BudgetScope>(x.budget);
+            entered_budget_scopes.push_back(&x);
+            return x;
+        }, py::return_value_policy::reference)
+        .def("__exit__", [](PythonBudgetScope &x, py::args) {
+            if (x.scope == nullptr) {
+                return;
+            }
+            if (entered_budget_scopes.empty() || entered_budget_scopes.back() != &x) {
+                throw std::runtime_error("Budget scopes have to be exited in reverse order of entering them, on the "
+                                         "thread that entered them.");
+            }
+            entered_budget_scopes.pop_back();
+            x.exited_usage = x.scope->usage();
+            x.scope.reset();
+        })
+        .def("usage", [](const PythonBudgetScope &x) {
+            return to_dict(x.scope != nullptr ? x.scope->usage() : x.exited_usage);
+        }, "The simple sets, bytes and seconds used inside of the scope so far.");
+
+    py::class_<FutureCompositeSet>(handle, "FutureCompositeSet")
+        .def("done", [](const FutureCompositeSet &x) {
+            return x.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        })
+        .def("result", [](const FutureCompositeSet &x) {
+            {
+                py::gil_scoped_release release;
+                x.future.wait();
+            }
+            return x.future.get();
+        }, "Wait for the result; raises OperationCancelled if the operation was cancelled.");
+
+    handle.def("make_disjoint_async", [](AbstractCompositeSetPtr_t const &set, CancellationToken const &token,
+                                         py::object const &progress) {
+        return FutureCompositeSet{make_disjoint_async(set, token, to_progress_callback(progress)).share()};
+    }, py::arg("set"), py::arg("token") = CancellationToken(), py::arg("progress") = py::none());
+    handle.def("simplify_async", [](AbstractCompositeSetPtr_t const &set, CancellationToken const &token,
+                                    py::object const &progress) {
+        return FutureCompositeSet{simplify_async(set, token, to_progress_callback(progress)).share()};
+    }, py::arg("set"), py::arg("token") = CancellationToken(), py::arg("progress") = py::none());
+    handle.def("complement_async", [](AbstractCompositeSetPtr_t const &set, CancellationToken const &token,
+                                      py::object const &progress) {
+        return FutureCompositeSet{complement_async(set, token, to_progress_callback(progress)).share()};
+    }, py::arg("set"), py::arg("token") = CancellationToken(), py::arg("progress") = py::none());
+    handle.def("shutdown_async_operations", []() {
+        py::gil_scoped_release release;
+        shutdown_async_operations();
+    }, "Cancel the unfinished asynchronous operations and wait for their threads.");
+
+    // the operations may call back into Python, hence they are stopped while the interpreter still runs
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() {
+        py::gil_scoped_release release;
+        shutdown_async_operations();
+    }));
+
+    handle.def("operation_statistics", []() {
+        auto const &statistics = operation_statistics();
+        return std::map<std::string, std::uint64_t>{
+                {"union_calls", statistics.union_calls.load()},
+                {"union_inputs", statistics.union_inputs.load()},
+                {"dominated_removed", statistics.dominated_removed.load()},
+                {"hull_fast_paths", statistics.hull_fast_paths.load()}};
+    }, "The counters of the set operations of this process.");
+    handle.def("reset_operation_statistics", []() { operation_statistics().reset(); },
+               "Set the counters of the set operations to zero.");
+
+    handle.def("parallel_options", []() {
+        auto options = get_parallel_options();
+        return std::map<std::string, size_t>{
+                {"threads", options.threads},
+                {"sequential_cutoff", options.sequential_cutoff}};
+    }, "The settings of the parallel execution of the set operations.");
+    handle.def("set_parallel_options", [](size_t threads, size_t sequential_cutoff) {
+        ParallelOptions options;
+        options.threads = threads;
+        options.sequential_cutoff = sequential_cutoff;
+        set_parallel_options(options);
+    }, py::arg("threads") = 0, py::arg("sequential_cutoff") = ParallelOptions().sequential_cutoff,
+    "Set the number of threads of the set operations (0 uses the hardware concurrency, 1 disables parallelism) and "
+    "the number of work items below which loops run sequentially.");
+
 }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cancellation.h"
+#include "sigma_algebra.h"
+#include <future>
+
+// The operations below run on a pool of threads owned by the library, one thread per hardware thread; operations
+// beyond that wait in a queue. Dropping the future does not wait for the operation; cancel its token to stop it.
+// At exit, the unfinished operations are cancelled and the threads joined.
+
+/**
+ * Cancel the tokens of all unfinished asynchronous operations and wait until their threads finished.
+ * This runs at exit; embedders that have to stop the operations earlier (for instance before an interpreter shuts
+ * down) call it themselves. Later operations start new threads.
+ */
+void shutdown_async_operations();
+
+/**
+ * Make a composite set disjoint in the background.
+ * The operation checks the token between its rounds and between pairs of simple sets and reports its rounds to the
+ * progress callback.
+ *
+ * @param set The composite set.
+ * @param token The token that stops the operation; the future then throws `OperationCancelled`.
+ * @param progress The callback that is told how far the operation got, or an empty function.
+ * @return The future disjoint composite set.
+ */
+std::future<AbstractCompositeSetPtr_t> make_disjoint_async(const AbstractCompositeSetPtr_t &set,
+                                                           const CancellationToken &token = CancellationToken(),
+                                                           const ProgressCallback_t &progress = nullptr);
+
+/**
+ * Simplify a composite set in the background.
+ * `Event::simplify` checks the token between its merge rounds and between pairs of simple events.
+ *
+ * @param set The composite set.
+ * @param token The token that stops the operation; the future then throws `OperationCancelled`.
+ * @param progress The callback that is told how far the operation got, or an empty function.
+ * @return The future simplified composite set.
+ */
+std::future<AbstractCompositeSetPtr_t> simplify_async(const AbstractCompositeSetPtr_t &set,
+                                                      const CancellationToken &token = CancellationToken(),
+                                                      const ProgressCallback_t &progress = nullptr);
+
+/**
+ * Complement a composite set in the background.
+ * The operation checks the token between the simple sets it complements and reports them to the progress callback.
+ *
+ * @param set The composite set.
+ * @param token The token that stops the operation; the future then throws `OperationCancelled`.
+ * @param progress The callback that is told how far the operation got, or an empty function.
+ * @return The future complement.
+ */
+std::future<AbstractCompositeSetPtr_t> complement_async(const AbstractCompositeSetPtr_t &set,
+                                                        const CancellationToken &token = CancellationToken(),
+                                                        const ProgressCallback_t &progress = nullptr);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "sigma_algebra.h"
+#include "parallel.h"
+#include <vector>
+
+/**
+ * The operations that a batch can run.
+ */
+enum class SetOperation {
+    /**
+     * lhs ∩ rhs.
+     */
+    INTERSECTION,
+
+    /**
+     * lhs ∪ rhs.
+     */
+    UNION,
+
+    /**
+     * lhs \ rhs.
+     */
+    DIFFERENCE,
+
+    /**
+     * The complement of lhs; rhs is ignored.
+     */
+    COMPLEMENT,
+
+    /**
+     * lhs as disjoint union; rhs is ignored.
+     */
+    MAKE_DISJOINT,
+
+    /**
+     * The simplified lhs; rhs is ignored.
+     */
+    SIMPLIFY
+};
+
+/**
+ * Description of one independent operation of a batch.
+ */
+struct BatchOperation {
+    SetOperation operation = SetOperation::INTERSECTION;
+    AbstractCompositeSetPtr_t lhs;
+    AbstractCompositeSetPtr_t rhs;
+};
+
+/**
+ * Run many independent set operations on a work stealing executor.
+ *
+ * The operations run concurrently and only read their operands (see `AbstractCompositeSet` for the guarantees), so
+ * the same composite set may appear in many operations. Neighbouring operations start on the same thread, hence
+ * listing operations on the same operands next to each other keeps those operands in one cache.
+ *
+ * @param operations The operations.
+ * @param executor The executor to run on; nullptr uses `default_work_stealing_executor`.
+ * @return The result of every operation, in the order of the operations.
+ * @throws std::invalid_argument If an operation misses an operand; nothing runs in this case. If operations throw,
+ * all other operations still run and the exception of the first failing operation is rethrown.
+ */
+std::vector<AbstractCompositeSetPtr_t> execute_batch(const std::vector<BatchOperation> &operations,
+                                                     const WorkStealingExecutorPtr_t &executor = nullptr);
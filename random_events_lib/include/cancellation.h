@@ -0,0 +1,296 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// FORWARD DECLARATIONS
+struct OperationControl;
+struct BudgetState;
+
+
+// TYPEDEFS
+using OperationControlPtr_t = std::shared_ptr<OperationControl>;
+using BudgetStatePtr_t = std::shared_ptr<BudgetState>;
+
+/**
+ * Function that is told how far a long-running operation got.
+ * The arguments are the stage of the operation, the units of work done in that stage and the total units of work of
+ * that stage, or 0 if the total is not known in advance.
+ */
+using ProgressCallback_t = std::function<void(const std::string &stage, size_t done, size_t total)>;
+
+/**
+ * Thrown by operations that noticed that their cancellation token was cancelled.
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    explicit OperationCancelled(const std::string &what) : std::runtime_error(what) {}
+};
+
+/**
+ * Limits of the resources a set operation may use. A limit of 0 means unlimited.
+ */
+struct ResourceBudget {
+
+    /**
+     * Maximal number of simple sets the operation may produce, intermediate results included.
+     */
+    size_t max_simple_sets = 0;
+
+    /**
+     * Maximal number of bytes the simple sets produced by the operation may take, intermediate results included.
+     * The bytes are estimated with `AbstractSimpleSet::memory_usage`.
+     */
+    size_t max_bytes = 0;
+
+    /**
+     * Maximal wall time of the operation.
+     */
+    std::chrono::steady_clock::duration max_duration = std::chrono::steady_clock::duration::zero();
+};
+
+/**
+ * The resources an operation used so far.
+ */
+struct BudgetUsage {
+
+    /**
+     * Number of simple sets produced, intermediate results included.
+     */
+    size_t simple_sets = 0;
+
+    /**
+     * Estimated bytes of these simple sets.
+     */
+    size_t bytes = 0;
+
+    /**
+     * Wall time since the budget was installed.
+     */
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::duration::zero();
+};
+
+/**
+ * Thrown by operations that exceeded a limit of their `ResourceBudget`.
+ */
+class BudgetExceeded : public std::runtime_error {
+public:
+
+    /**
+     * @param resource The exceeded limit: "simple_sets", "bytes" or "time".
+     * @param stage The stage of the operation that exceeded it.
+     * @param usage The resources used up to that point.
+     */
+    BudgetExceeded(const std::string &resource, const std::string &stage, const BudgetUsage &usage);
+
+    /**
+     * The exceeded limit: "simple_sets", "bytes" or "time".
+     */
+    std::string resource;
+
+    /**
+     * The stage of the operation that exceeded the limit.
+     */
+    std::string stage;
+
+    /**
+     * The resources used up to the point where the limit was exceeded.
+     */
+    BudgetUsage usage;
+};
+
+/**
+ * Shared flag that asks operations to stop.
+ * Copies of a token share the flag, hence a caller keeps one copy and hands another one to the operation. A token can
+ * also cancel itself at a deadline.
+ */
+class CancellationToken {
+public:
+
+    CancellationToken();
+
+    /**
+     * Ask the operations that use this token to stop.
+     */
+    void cancel();
+
+    /**
+     * Cancel this token automatically at a point in time.
+     *
+     * @param deadline The point in time.
+     */
+    void cancel_at(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Cancel this token automatically after some time.
+     *
+     * @param timeout The time from now on.
+     */
+    void cancel_after(std::chrono::steady_clock::duration timeout);
+
+    /**
+     * @return True if the token was cancelled or its deadline passed.
+     */
+    bool is_cancelled() const;
+
+private:
+
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::atomic<std::chrono::steady_clock::rep> deadline{std::chrono::steady_clock::time_point::max()
+                                                                     .time_since_epoch().count()};
+    };
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * The resources that operations under one `BudgetScope` used. Budgets of nested scopes are charged together with the
+ * budgets of the enclosing scopes.
+ */
+struct BudgetState {
+    ResourceBudget budget;
+
+    std::chrono::steady_clock::time_point start;
+
+    std::atomic<size_t> simple_sets{0};
+
+    std::atomic<size_t> bytes{0};
+
+    BudgetStatePtr_t enclosing;
+
+    /**
+     * @return The resources used so far.
+     */
+    BudgetUsage usage() const;
+};
+
+/**
+ * The cancellation token, the progress callback and the budget of a running operation.
+ */
+struct OperationControl {
+    CancellationToken token;
+
+    ProgressCallback_t progress;
+
+    /**
+     * The budget or nullptr if the operation is unlimited.
+     */
+    BudgetStatePtr_t budget;
+
+    /**
+     * Serializes the calls of the progress callback, which may come from several threads.
+     */
+    std::mutex progress_mutex;
+};
+
+/**
+ * Install the control of an operation on the calling thread while an instance of this lives.
+ * The set operations check the installed token at their checkpoints (`checkpoint`) and report their progress to the
+ * installed callback (`report_progress`). `parallel_for` installs the control of the calling thread on its helpers.
+ */
+class ControlScope {
+public:
+
+    explicit ControlScope(OperationControlPtr_t control);
+
+    ~ControlScope();
+
+    ControlScope(const ControlScope &) = delete;
+
+    ControlScope &operator=(const ControlScope &) = delete;
+
+private:
+    OperationControlPtr_t previous;
+};
+
+/**
+ * Limit the resources of the set operations on the calling thread while an instance of this lives.
+ * The scope keeps the token and the progress callback of the control installed before. `difference_with`,
+ * `complement`, `make_disjoint`, `Event::simplify` and `Event::marginal` charge the simple sets they produce to the
+ * budget and throw `BudgetExceeded` as soon as a limit is exceeded; the time limit is checked at every `checkpoint`.
+ */
+class BudgetScope {
+public:
+
+    explicit BudgetScope(const ResourceBudget &budget);
+
+    BudgetScope(const BudgetScope &) = delete;
+
+    BudgetScope &operator=(const BudgetScope &) = delete;
+
+    /**
+     * @return The resources used under this scope so far.
+     */
+    BudgetUsage usage() const;
+
+private:
+    BudgetStatePtr_t state;
+
+    ControlScope scope;
+};
+
+/**
+ * @return The control installed on the calling thread or nullptr.
+ */
+const OperationControlPtr_t &current_operation_control();
+
+/**
+ * Stop the running operation if its token was cancelled or its time budget is used up. Cheap if no control is
+ * installed.
+ *
+ * @throws OperationCancelled If the token of the installed control was cancelled.
+ * @throws BudgetExceeded If the installed budget has no time left.
+ */
+void checkpoint();
+
+/**
+ * @return True if a budget is installed, hence operations have to charge what they produce.
+ */
+bool has_budget();
+
+/**
+ * Charge simple sets produced by the running operation to the installed budgets. Does nothing if no budget is
+ * installed.
+ *
+ * @param stage The stage of the operation that produced them.
+ * @param simple_sets The number of simple sets.
+ * @param bytes Their estimated bytes.
+ * @throws BudgetExceeded If a limit of an installed budget is exceeded.
+ */
+void charge_budget(const char *stage, size_t simple_sets, size_t bytes);
+
+/**
+ * Charge a range of pointers to simple sets produced by the running operation to the installed budgets. Their bytes
+ * are only estimated if a budget is installed.
+ *
+ * @param stage The stage of the operation that produced them.
+ * @param simple_sets The pointers to the simple sets.
+ * @throws BudgetExceeded If a limit of an installed budget is exceeded.
+ */
+template<typename Range>
+void charge_budget(const char *stage, const Range &simple_sets) {
+    if (!has_budget()) {
+        return;
+    }
+    size_t bytes = 0;
+    for (auto const &simple_set : simple_sets) {
+        bytes += simple_set->memory_usage();
+    }
+    charge_budget(stage, simple_sets.size(), bytes);
+}
+
+/**
+ * Tell the installed progress callback how far the running operation got. Does nothing if no callback is installed.
+ *
+ * @param stage The stage of the operation.
+ * @param done The units of work done in that stage.
+ * @param total The total units of work of that stage or 0 if unknown.
+ */
+void report_progress(const char *stage, size_t done, size_t total);
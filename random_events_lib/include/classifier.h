@@ -0,0 +1,134 @@
+#pragma once
+
+#include "product_algebra.h"
+#include <cstdint>
+#include <vector>
+
+// FORWARD DECLARATIONS
+class EventClassifier;
+
+
+// TYPEDEFS
+using EventClassifierPtr_t = std::shared_ptr<EventClassifier>;
+
+template<typename... Args>
+EventClassifierPtr_t make_shared_event_classifier(Args &&... args) {
+    return std::make_shared<EventClassifier>(std::forward<Args>(args)...);
+}
+
+/**
+ * Decision tree that tells which of K events contains a point.
+ *
+ * The tree is compiled once from the simple events of all events. Inner nodes split on an interval boundary
+ * (`x < threshold`) or on the membership of a single symbolic element (`x == element`), leaves hold the few simple
+ * events that remain possible and are tested exactly. Nodes and leaf contents are stored in flat arrays.
+ *
+ * The events are expected to be pairwise disjoint. If a point lies in several events, the one with the lowest index is
+ * reported.
+ */
+class EventClassifier {
+public:
+
+    /**
+     * Compile a classifier.
+     *
+     * @param events The events to classify into.
+     * @param leaf_size The maximum number of simple events in a leaf.
+     * @param max_depth The maximum depth of the tree.
+     */
+    explicit EventClassifier(const std::vector<EventPtr_t> &events, size_t leaf_size = 4, size_t max_depth = 48);
+
+    /**
+     * @return All variables of the classifier in name order. Points passed to `classify` follow this order.
+     */
+    const std::vector<AbstractVariablePtr_t> &get_variables() const;
+
+    /**
+     * @return The number of nodes of the tree.
+     */
+    size_t node_count() const;
+
+    /**
+     * @return The depth of the tree.
+     */
+    size_t depth() const;
+
+    /**
+     * Classify a single point in O(depth).
+     * The point assigns one value to every variable of `get_variables()`, in that order. Symbolic variables are
+     * assigned the index of their element.
+     *
+     * @param point The point.
+     * @return The index of the event containing the point or -1 if no event does.
+     */
+    std::int64_t classify(const std::vector<double> &point) const;
+
+    /**
+     * Classify a columnar batch of points.
+     * Every variable that is constrained by any event needs a column. The rows are split among threads.
+     *
+     * @param columns One column per constrained variable.
+     * @param rows The number of rows of every column.
+     * @param threads The number of threads; 0 uses the hardware concurrency.
+     * @return For every row the index of the event containing it or -1.
+     */
+    std::vector<std::int64_t> classify(const ColumnMap &columns, size_t rows, size_t threads = 0) const;
+
+private:
+
+    /**
+     * A node of the tree.
+     * Inner nodes send a point to `first` if the test holds and to `second` otherwise.
+     * Leaves (variable < 0) refer to the range [first, second) of `leaf_boxes`.
+     */
+    struct Node {
+        std::int32_t variable;
+        std::uint32_t first;
+        std::uint32_t second;
+        double threshold;
+    };
+
+    /**
+     * Constraint of a box on one variable. Refers to the range [begin, end) of `bounds` for interval variables and of
+     * `elements` for symbolic variables.
+     */
+    struct Constraint {
+        std::uint32_t variable;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    /**
+     * Bounds of a simple interval in branch free form.
+     */
+    struct Bounds {
+        double lower;
+        double upper;
+        bool lower_closed;
+        bool upper_closed;
+    };
+
+    std::vector<AbstractVariablePtr_t> variables;
+    std::vector<bool> is_symbolic;
+
+    /**
+     * True for every variable that is constrained by at least one box.
+     */
+    std::vector<bool> is_constrained;
+
+    std::vector<std::int64_t> labels;
+    std::vector<std::uint32_t> constraint_offsets;
+    std::vector<Constraint> constraints;
+    std::vector<Bounds> bounds;
+    std::vector<int> elements;
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> leaf_boxes;
+    size_t tree_depth = 0;
+
+    struct Builder;
+
+    bool box_contains(std::uint32_t box, const double *point) const;
+
+    std::int64_t classify_point(const double *point) const;
+};
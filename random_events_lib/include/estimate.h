@@ -0,0 +1,123 @@
+#pragma once
+
+#include "batch.h"
+#include "sigma_algebra.h"
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * The shape of the simple sets of a composite set, as far as the cost of operations is concerned.
+ */
+enum class SetKind {
+    /**
+     * Unions of simple intervals.
+     */
+    INTERVAL,
+
+    /**
+     * Unions of elements of a finite universe.
+     */
+    SET,
+
+    /**
+     * Unions of simple events (boxes over variables).
+     */
+    PRODUCT
+};
+
+/**
+ * Cheap statistics of a composite set that the cost estimates are computed from.
+ * Collecting them walks the simple sets once and never runs a set operation.
+ */
+struct SetStatistics {
+
+    SetKind kind = SetKind::INTERVAL;
+
+    /**
+     * Number of simple sets.
+     */
+    size_t pieces = 0;
+
+    /**
+     * Average number of simple sets (intervals or elements) inside one simple set; 1 for intervals and sets.
+     * Operations on two simple sets walk about this many simple sets of every operand.
+     */
+    double piece_cost = 1;
+
+    /**
+     * For every variable the total number of simple sets of its assignments over all simple events. Intervals and
+     * sets report their simple sets under the empty name. The more fragmented a variable, the more cells it can be
+     * cut into.
+     */
+    std::map<std::string, size_t> fragmentation;
+
+    /**
+     * For every variable assigned a set, the size of its universe, which bounds the cells it can be cut into.
+     */
+    std::map<std::string, size_t> universe_sizes;
+
+    /**
+     * Whether the set is known to be disjoint.
+     */
+    bool disjoint = false;
+};
+
+/**
+ * Prediction of the result and the work of a set operation.
+ */
+struct CostEstimate {
+
+    /**
+     * Expected number of simple sets of the result.
+     */
+    double expected_pieces = 0;
+
+    /**
+     * Upper bound of the number of simple sets of the result.
+     */
+    double max_pieces = 0;
+
+    /**
+     * Rough number of elementary operations on simple sets (intersections, differences and comparisons), weighted
+     * by the size of the simple sets. Only meaningful relative to other estimates.
+     */
+    double work = 0;
+};
+
+/**
+ * Collect the statistics of a composite set.
+ *
+ * @param set The composite set.
+ * @return The statistics.
+ */
+SetStatistics collect_statistics(const AbstractCompositeSet &set);
+
+/**
+ * Estimate how likely a simple set of one composite set intersects a simple set of another one.
+ * Pairs whose operand cannot overlap the hull of the other composite set count as disjoint; the remaining pairs are
+ * sampled deterministically. If both arguments are the same set, pairs of distinct simple sets are sampled.
+ *
+ * @param lhs The first composite set.
+ * @param rhs The second composite set.
+ * @param samples The maximal number of pairs that are tested.
+ * @return The estimated fraction of intersecting pairs in [0, 1].
+ */
+double estimate_overlap(const AbstractCompositeSet &lhs, const AbstractCompositeSet &rhs, size_t samples = 256);
+
+/**
+ * Estimate the result size and the work of a set operation without running it.
+ *
+ * The upper bound holds for the set operations of this library: it is the smaller of the worst case of the
+ * algorithm (every piece of lhs split by every overlapping piece of rhs) and the number of cells the endpoints of
+ * both operands cut the space into. The expectation assumes that a piece overlaps pieces of the other operand at the
+ * sampled rate and that every overlap cuts it into half of the worst case.
+ *
+ * @param operation The operation.
+ * @param lhs The left hand side.
+ * @param rhs The right hand side; ignored by unary operations.
+ * @return The estimate.
+ * @throws std::invalid_argument If an operand is missing.
+ */
+CostEstimate estimate_cost(SetOperation operation, const AbstractCompositeSetPtr_t &lhs,
+                           const AbstractCompositeSetPtr_t &rhs = nullptr);
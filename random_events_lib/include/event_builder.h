@@ -0,0 +1,85 @@
+#pragma once
+
+#include "product_algebra.h"
+#include "spatial_index.h"
+#include <cstddef>
+#include <vector>
+
+// FORWARD DECLARATIONS
+class EventBuilder;
+
+
+// TYPEDEFS
+using EventBuilderPtr_t = std::shared_ptr<EventBuilder>;
+
+template<typename... Args>
+EventBuilderPtr_t make_shared_event_builder(Args &&... args) {
+    return std::make_shared<EventBuilder>(std::forward<Args>(args)...);
+}
+
+/**
+ * Builds a disjoint event from simple events that arrive one at a time.
+ *
+ * The pieces collected so far are pairwise disjoint and never change. A new simple event is cut by the pieces whose
+ * bounding boxes overlap it and only its remaining parts are added, hence every insertion costs about the number of
+ * overlapping pieces instead of a `make_disjoint` of everything. The pieces are indexed in levels of doubling size
+ * (each level a `SpatialIndex`), plus a small buffer of recent pieces that is scanned linearly; a full buffer is
+ * merged into the levels like a binary counter, hence every piece is indexed O(log n) times.
+ *
+ * A builder is not thread safe.
+ */
+class EventBuilder {
+public:
+
+    /**
+     * Add the elements of a simple event that are not in the event yet.
+     *
+     * @param simple_event The simple event.
+     */
+    void add(const SimpleEventPtr_t &simple_event);
+
+    /**
+     * Add the elements of every simple event of an event that are not in the event yet.
+     *
+     * @param event The event.
+     */
+    void add(const EventPtr_t &event);
+
+    /**
+     * @return The number of disjoint pieces collected so far.
+     */
+    size_t size() const;
+
+    /**
+     * Create the event of the pieces collected so far. The builder can continue to add simple events afterwards.
+     *
+     * @return The event, marked disjoint.
+     */
+    EventPtr_t build() const;
+
+private:
+
+    /**
+     * Number of recent pieces that are scanned linearly before they are indexed.
+     */
+    static constexpr size_t BUFFER_SIZE = 64;
+
+    /**
+     * Indexed pieces; level k is empty or holds the pieces of 2^k full buffers.
+     */
+    struct Level {
+        SimpleSetSetPtr_t pieces;
+        SpatialIndexPtr_t index;
+    };
+
+    std::vector<Level> levels;
+
+    std::vector<AbstractSimpleSetPtr_t> buffer;
+
+    size_t pieces = 0;
+
+    /**
+     * Merge the buffer into the levels.
+     */
+    void flush();
+};
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/**
+ * Sorted set of unique elements stored in one contiguous vector.
+ *
+ * The container offers the interface of std::set that the library uses. Elements are kept sorted and unique with
+ * respect to `Compare`; of equivalent elements, the one inserted first is kept, like in std::set.
+ *
+ * - Lookups (`find`, `count`, `lower_bound`) are binary searches.
+ * - Range inserts append the new elements, sort them and merge them with the existing ones in linear time. Inserting
+ *   single elements in increasing order only appends.
+ * - Iteration and indexed access walk contiguous memory.
+ *
+ * Unlike std::set, inserting and erasing invalidate iterators. Elements cannot be modified through iterators.
+ *
+ * Every flat set carries a stamp that changes with every modification. Stamps are drawn from one process wide
+ * sequence, hence caches keyed on the stamp neither survive an edit that keeps the size nor mistake a new flat set at
+ * a reused address for an old one.
+ */
+namespace flat_set_detail {
+
+/**
+ * @return A stamp that was never returned before in this process; 0 is never returned.
+ */
+inline std::uint64_t next_stamp() noexcept {
+    // every thread reserves a block of stamps at a time, such that concurrent modifications do not contend
+    constexpr std::uint64_t BLOCK = 1024;
+    static std::atomic<std::uint64_t> counter{1};
+    thread_local std::uint64_t next = 0;
+    thread_local std::uint64_t last = 0;
+    if (next == last) {
+        next = counter.fetch_add(BLOCK, std::memory_order_relaxed);
+        last = next + BLOCK;
+    }
+    return next++;
+}
+
+}
+
+template<typename Key, typename Compare = std::less<Key>>
+class FlatSet {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Key &;
+    using const_reference = const Key &;
+    using iterator = typename std::vector<Key>::const_iterator;
+    using const_iterator = iterator;
+    using reverse_iterator = typename std::vector<Key>::const_reverse_iterator;
+    using const_reverse_iterator = reverse_iterator;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare &compare_) : compare(compare_) {}
+
+    template<typename InputIterator>
+    FlatSet(InputIterator first, InputIterator last) {
+        insert(first, last);
+    }
+
+    FlatSet(std::initializer_list<Key> keys) {
+        insert(keys.begin(), keys.end());
+    }
+
+    /**
+     * Copies keep the stamp, as they have the same elements.
+     */
+    FlatSet(const FlatSet &other) = default;
+
+    FlatSet &operator=(const FlatSet &other) = default;
+
+    /**
+     * The moved-from flat set is emptied and hence gets a new stamp.
+     */
+    FlatSet(FlatSet &&other) noexcept
+            : elements(std::move(other.elements)), compare(std::move(other.compare)), stamp(other.stamp) {
+        other.elements.clear();
+        other.touch();
+    }
+
+    FlatSet &operator=(FlatSet &&other) noexcept {
+        if (this != &other) {
+            elements = std::move(other.elements);
+            compare = std::move(other.compare);
+            stamp = other.stamp;
+            other.elements.clear();
+            other.touch();
+        }
+        return *this;
+    }
+
+    iterator begin() const noexcept {
+        return elements.cbegin();
+    }
+
+    iterator end() const noexcept {
+        return elements.cend();
+    }
+
+    iterator cbegin() const noexcept {
+        return elements.cbegin();
+    }
+
+    iterator cend() const noexcept {
+        return elements.cend();
+    }
+
+    reverse_iterator rbegin() const noexcept {
+        return elements.crbegin();
+    }
+
+    reverse_iterator rend() const noexcept {
+        return elements.crend();
+    }
+
+    bool empty() const noexcept {
+        return elements.empty();
+    }
+
+    size_type size() const noexcept {
+        return elements.size();
+    }
+
+    /**
+     * @return The stamp of the current elements. Two flat sets with the same stamp contain the same elements.
+     */
+    std::uint64_t version() const noexcept {
+        return stamp;
+    }
+
+    /**
+     * @param position The position in iteration order.
+     * @return The element at that position.
+     */
+    const Key &operator[](size_type position) const {
+        return elements[position];
+    }
+
+    /**
+     * Reserve memory for a number of elements.
+     */
+    void reserve(size_type capacity) {
+        elements.reserve(capacity);
+    }
+
+    void clear() noexcept {
+        elements.clear();
+        touch();
+    }
+
+    void swap(FlatSet &other) noexcept {
+        elements.swap(other.elements);
+        std::swap(compare, other.compare);
+        std::swap(stamp, other.stamp);
+    }
+
+    /**
+     * Insert an element unless an equivalent element is already contained.
+     *
+     * @param key The element.
+     * @return The position of the (inserted or already contained) element and true if it was inserted.
+     */
+    std::pair<iterator, bool> insert(const Key &key) {
+        return insert_unique(key);
+    }
+
+    std::pair<iterator, bool> insert(Key &&key) {
+        return insert_unique(std::move(key));
+    }
+
+    /**
+     * Insert an element; the hint is ignored. Provided for std::inserter.
+     */
+    iterator insert(const_iterator /*hint*/, const Key &key) {
+        return insert_unique(key).first;
+    }
+
+    /**
+     * Insert a range of elements by sorting them and merging them with the contained elements.
+     * Of equivalent elements, contained ones and then earlier ones of the range are kept.
+     *
+     * @param first The begin of the range.
+     * @param last The end of the range.
+     */
+    template<typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        const auto old_size = static_cast<difference_type>(elements.size());
+        elements.insert(elements.end(), first, last);
+        auto middle = elements.begin() + old_size;
+        if (middle == elements.end()) {
+            return;
+        }
+        touch();
+
+        // 1) Sort the new elements; stable, such that earlier ones come first among equivalent ones
+        if (!std::is_sorted(middle, elements.end(), compare)) {
+            std::stable_sort(middle, elements.end(), compare);
+        }
+
+        // 2) Merge them with the contained elements unless they all go behind them; the merge puts contained elements
+        //    first among equivalent ones
+        auto unique_from = middle == elements.begin() ? middle : std::prev(middle);
+        if (middle != elements.begin() && compare(*middle, *std::prev(middle))) {
+            std::inplace_merge(elements.begin(), middle, elements.end(), compare);
+            unique_from = elements.begin();
+        }
+
+        // 3) Keep the first of every group of equivalent elements
+        auto const equivalent = [this](const Key &lhs, const Key &rhs) {
+            return !compare(lhs, rhs) && !compare(rhs, lhs);
+        };
+        elements.erase(std::unique(unique_from, elements.end(), equivalent), elements.end());
+    }
+
+    void insert(std::initializer_list<Key> keys) {
+        insert(keys.begin(), keys.end());
+    }
+
+    /**
+     * Erase the element equivalent to a key.
+     *
+     * @return The number of erased elements (0 or 1).
+     */
+    size_type erase(const Key &key) {
+        auto position = find(key);
+        if (position == end()) {
+            return 0;
+        }
+        elements.erase(position);
+        touch();
+        return 1;
+    }
+
+    iterator erase(const_iterator position) {
+        touch();
+        return elements.erase(position);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        if (first != last) {
+            touch();
+        }
+        return elements.erase(first, last);
+    }
+
+    iterator lower_bound(const Key &key) const {
+        return std::lower_bound(elements.cbegin(), elements.cend(), key, compare);
+    }
+
+    iterator upper_bound(const Key &key) const {
+        return std::upper_bound(elements.cbegin(), elements.cend(), key, compare);
+    }
+
+    iterator find(const Key &key) const {
+        auto position = lower_bound(key);
+        if (position != end() && !compare(key, *position)) {
+            return position;
+        }
+        return end();
+    }
+
+    size_type count(const Key &key) const {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    bool contains(const Key &key) const {
+        return find(key) != end();
+    }
+
+    key_compare key_comp() const {
+        return compare;
+    }
+
+private:
+
+    std::vector<Key> elements;
+
+    Compare compare;
+
+    std::uint64_t stamp = flat_set_detail::next_stamp();
+
+    /**
+     * Take a new stamp after a modification.
+     */
+    void touch() noexcept {
+        stamp = flat_set_detail::next_stamp();
+    }
+
+    template<typename K>
+    std::pair<iterator, bool> insert_unique(K &&key) {
+        // appending in increasing order is the common case and needs no search
+        if (elements.empty() || compare(elements.back(), key)) {
+            elements.push_back(std::forward<K>(key));
+            touch();
+            return {std::prev(elements.cend()), true};
+        }
+        auto position = lower_bound(key);
+        if (position != end() && !compare(key, *position)) {
+            return {position, false};
+        }
+        touch();
+        return {elements.insert(position, std::forward<K>(key)), true};
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "sigma_algebra.h"
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/**
+ * Pull based source of the disjoint simple sets of a result that is computed one simple set at a time.
+ *
+ * Consumers that look at every simple set once (to count them, to stream them elsewhere or to find the first one with
+ * some property) never hold the whole result. A generator keeps its operands alive and a small amount of pending
+ * work, but no simple set it already produced. A generator can be consumed once; `begin` continues where the last
+ * consumer stopped.
+ */
+class PieceGenerator {
+public:
+
+    /**
+     * Input iterator over the remaining simple sets of a generator.
+     */
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = AbstractSimpleSetPtr_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const AbstractSimpleSetPtr_t *;
+        using reference = const AbstractSimpleSetPtr_t &;
+
+        /**
+         * Create the end iterator.
+         */
+        iterator() = default;
+
+        /**
+         * Create an iterator at the next simple set of a generator.
+         *
+         * @param generator The generator.
+         */
+        explicit iterator(PieceGenerator *generator);
+
+        reference operator*() const {
+            return piece;
+        }
+
+        pointer operator->() const {
+            return &piece;
+        }
+
+        iterator &operator++();
+
+        bool operator==(const iterator &other) const {
+            return generator == other.generator;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return generator != other.generator;
+        }
+
+    private:
+        PieceGenerator *generator = nullptr;
+        AbstractSimpleSetPtr_t piece;
+    };
+
+    virtual ~PieceGenerator() = default;
+
+    /**
+     * Compute the next simple set.
+     *
+     * @return The next non-empty simple set or nullptr if there is none left.
+     */
+    virtual AbstractSimpleSetPtr_t next() = 0;
+
+    iterator begin();
+
+    iterator end();
+
+    /**
+     * Consume the remaining simple sets.
+     *
+     * @return Their number.
+     */
+    size_t count();
+
+    /**
+     * Consume the remaining simple sets into a composite set.
+     *
+     * @param empty An empty composite set of the right type that is filled.
+     * @return The filled composite set, marked disjoint.
+     */
+    AbstractCompositeSetPtr_t collect(const AbstractCompositeSetPtr_t &empty);
+};
+
+/**
+ * Produce the simple sets of an already materialized set of simple sets.
+ *
+ * @param simple_sets The simple sets.
+ * @return The generator.
+ */
+PieceGeneratorPtr_t generate_pieces(const SimpleSetSetPtr_t &simple_sets);
+
+/**
+ * Produce the parts of the simple sets of a source that lie outside of every subtrahend, one at a time.
+ * Every simple set is cut by the subtrahends in order, depth first; a part is only cut by the subtrahends that
+ * intersect it. The parts are disjoint if the simple sets of the source are.
+ *
+ * @param source The generator of the simple sets to cut.
+ * @param subtrahends The simple sets to cut away.
+ * @return The generator.
+ */
+PieceGeneratorPtr_t generate_carving(const PieceGeneratorPtr_t &source,
+                                     std::vector<AbstractSimpleSetPtr_t> subtrahends);
+
+/**
+ * Produce the complement of a composite set as disjoint simple sets, one at a time.
+ * The complement of the first simple set is cut by every other simple set depth first, hence only one path of cuts
+ * is pending at any time. The simple sets differ from the ones of `AbstractCompositeSet::complement`, their union is
+ * the same.
+ *
+ * @param set The composite set; the complement of the empty set is empty, like in `complement`.
+ * @return The generator.
+ */
+PieceGeneratorPtr_t generate_complement(const AbstractCompositeSetPtr_t &set);
+
+/**
+ * Produce lhs \ rhs as disjoint simple sets, one at a time.
+ * Every simple set of lhs is cut depth first by the simple sets of rhs that may overlap it and, unless lhs is known
+ * to be disjoint, by the earlier simple sets of lhs.
+ *
+ * @param lhs The composite set to subtract from.
+ * @param rhs The composite set to subtract.
+ * @return The generator.
+ */
+PieceGeneratorPtr_t generate_difference(const AbstractCompositeSetPtr_t &lhs, const AbstractCompositeSetPtr_t &rhs);
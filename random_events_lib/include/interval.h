@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "sigma_algebra.h"
@@ -53,6 +55,18 @@ inline BorderType invert_border(const BorderType border) {
     return border == BorderType::OPEN ? BorderType::CLOSED : BorderType::OPEN;
 }
 
+/**
+ * The bit pattern of a bound, with -0.0 mapped to 0.0 such that equal bounds have equal bits.
+ * @param bound The bound.
+ * @return The bits of the bound.
+ */
+inline std::uint64_t bound_bits(const double bound) {
+    const double normalized = bound == 0.0 ? 0.0 : bound;
+    std::uint64_t bits;
+    std::memcpy(&bits, &normalized, sizeof(bits));
+    return bits;
+}
+
 
 /**
  * Class that represents a simple interval.
@@ -160,6 +174,96 @@ public:
         return resulting_intervals;
     };
 
+    /**
+     * Form the difference with another simple interval directly.
+     * The result consists of at most two pieces: the part left of and the part right of the other interval.
+     *
+     * @param other The other simple interval.
+     * @return The difference as disjoint set of at most two simple intervals.
+     */
+    SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t &other) override {
+        const auto derived_other = (SimpleInterval *) other.get();
+        auto result = make_shared_simple_set_set();
+
+        if (is_empty()) {
+            return result;
+        }
+
+        // if the intervals do not overlap, the difference is this interval
+        const bool separated_left = derived_other->upper < lower or (derived_other->upper == lower and (
+                derived_other->right == BorderType::OPEN or left == BorderType::OPEN));
+        const bool separated_right = upper < derived_other->lower or (upper == derived_other->lower and (
+                right == BorderType::OPEN or derived_other->left == BorderType::OPEN));
+        if (derived_other->is_empty() or separated_left or separated_right) {
+            result->insert(share_more());
+            return result;
+        }
+
+        // the part left of the other interval; empty if the other interval starts before this one
+        auto left_piece = make_shared(lower, derived_other->lower, left, invert_border(derived_other->left));
+        if (!left_piece->is_empty()) {
+            result->insert(left_piece);
+        }
+
+        // the part right of the other interval; empty if the other interval ends after this one
+        auto right_piece = make_shared(derived_other->upper, upper, invert_border(derived_other->right), right);
+        if (!right_piece->is_empty()) {
+            result->insert(right_piece);
+        }
+
+        return result;
+    };
+
+    /**
+     * Check if this simple interval is contained in another simple interval by comparing the bounds.
+     *
+     * @param other The other simple interval.
+     * @return True if this is a subset of other.
+     */
+    bool is_subset_of(const AbstractSimpleSetPtr_t &other) override {
+        const auto derived_other = (SimpleInterval *) other.get();
+        if (is_empty()) {
+            return true;
+        }
+        if (derived_other->is_empty()) {
+            return false;
+        }
+        const bool lower_inside = derived_other->lower < lower or (derived_other->lower == lower and (
+                derived_other->left == BorderType::CLOSED or left == BorderType::OPEN));
+        const bool upper_inside = upper < derived_other->upper or (upper == derived_other->upper and (
+                derived_other->right == BorderType::CLOSED or right == BorderType::OPEN));
+        return lower_inside and upper_inside;
+    };
+
+    /**
+     * Check if this simple interval overlaps another simple interval by comparing the bounds.
+     *
+     * @param other The other simple interval.
+     * @return True if the intersection is not empty.
+     */
+    bool intersects(const AbstractSimpleSetPtr_t &other) override {
+        const auto derived_other = (SimpleInterval *) other.get();
+        if (is_empty() or derived_other->is_empty()) {
+            return false;
+        }
+        const bool separated_left = derived_other->upper < lower or (derived_other->upper == lower and (
+                derived_other->right == BorderType::OPEN or left == BorderType::OPEN));
+        const bool separated_right = upper < derived_other->lower or (upper == derived_other->lower and (
+                right == BorderType::OPEN or derived_other->left == BorderType::OPEN));
+        return not separated_left and not separated_right;
+    };
+
+    /**
+     * @return A fingerprint of the bounds. Border types are ignored, like in ordering.
+     */
+    std::uint64_t fingerprint() const override {
+        return combine_fingerprints(combine_fingerprints(0, bound_bits(lower)), bound_bits(upper));
+    };
+
+    size_t memory_usage() const override {
+        return sizeof(SimpleInterval);
+    };
+
     bool contains(const ElementaryVariant *element) override {
         return false;
     };
@@ -272,16 +376,18 @@ public:
         this->simple_sets->insert(simple_interval);
     }
 
-    ~Interval() override {
-        simple_sets->clear();
-    };
-
     bool operator <(const AbstractCompositeSet &other) {
         const auto derived_other = (Interval *) &other;
         return *this < *derived_other;
     };
 
     AbstractCompositeSetPtr_t simplify() override {
+        if (is_known_simplified()) {
+            auto copy = Interval::make_shared(make_shared_simple_set_set(*simple_sets));
+            copy->mark_simplified();
+            return copy;
+        }
+
         auto result = make_shared_simple_set_set();
         bool first_iteration = true;
 
@@ -301,19 +407,179 @@ public:
                 last_simple_interval->upper == current_simple_interval->lower and not (
                   last_simple_interval->right == BorderType::OPEN and
                   current_simple_interval->left == BorderType::OPEN))) {
-                last_simple_interval->upper = current_simple_interval->upper;
-                last_simple_interval->right = current_simple_interval->right;
+                // Merge into a new interval, the simple intervals may be shared with other sets
+                if (current_simple_interval->upper > last_simple_interval->upper or (
+                    current_simple_interval->upper == last_simple_interval->upper and
+                    current_simple_interval->right == BorderType::CLOSED)) {
+                    auto merged = SimpleInterval::make_shared(last_simple_interval->lower,
+                                                              current_simple_interval->upper,
+                                                              last_simple_interval->left,
+                                                              current_simple_interval->right);
+                    result->erase(std::prev(result->end()));
+                    result->insert(merged);
+                }
                   } else {
                       result->insert(current_simple_interval);
                   }
         }
-        return Interval::make_shared(result);
+        auto simplified = Interval::make_shared(result);
+        simplified->mark_simplified();
+        return simplified;
     };
 
     AbstractCompositeSetPtr_t make_new_empty() const override {
         return Interval::make_shared();
     };
 
+    /**
+     * Drop every simple interval that is contained in another one in a single sweep.
+     * Simple intervals are ordered by their lower bound, hence a simple interval is compared only to the one with the
+     * largest upper bound so far. This misses some containments with equal bounds but different borders, which
+     * does not affect correctness.
+     *
+     * @return The number of dropped simple intervals.
+     */
+    size_t remove_dominated_simple_sets() override {
+        if (simple_sets->size() < 2) {
+            return 0;
+        }
+
+        std::vector<AbstractSimpleSetPtr_t> dominated;
+        SimpleIntervalPtr_t reach = nullptr;
+        for (const auto &simple_set: *simple_sets) {
+            auto current = std::static_pointer_cast<SimpleInterval>(simple_set);
+            if (reach != nullptr and current->is_subset_of(reach)) {
+                dominated.push_back(current);
+                continue;
+            }
+            if (reach == nullptr or current->upper > reach->upper or (
+                current->upper == reach->upper and current->right == BorderType::CLOSED)) {
+                reach = current;
+            }
+        }
+
+        if (not dominated.empty()) {
+            // the dominated simple intervals were found in order, hence one merge-like pass removes them
+            SimpleSetSet_t kept;
+            kept.reserve(simple_sets->size() - dominated.size());
+            auto next_dominated = dominated.begin();
+            for (const auto &simple_set: *simple_sets) {
+                if (next_dominated != dominated.end() and *next_dominated == simple_set) {
+                    ++next_dominated;
+                } else {
+                    kept.insert(simple_set);
+                }
+            }
+            simple_sets->swap(kept);
+        }
+        return dominated.size();
+    };
+
+    /**
+     * Check if this interval overlaps another interval.
+     * If both intervals are known to be disjoint, their simple intervals are swept in order and every simple interval
+     * is looked at once. Otherwise all pairs are tested.
+     *
+     * @param other The other interval.
+     * @return True if the intersection is not empty.
+     */
+    bool intersects(const AbstractCompositeSetPtr_t &other) override {
+        if (not is_known_disjoint() or not other->is_known_disjoint()) {
+            return AbstractCompositeSet::intersects(other);
+        }
+
+        auto it = simple_sets->begin();
+        auto other_it = other->simple_sets->begin();
+        while (it != simple_sets->end() and other_it != other->simple_sets->end()) {
+            if ((*it)->intersects(*other_it)) {
+                return true;
+            }
+            // the simple interval that ends first cannot overlap any later one of the other interval; of two that end
+            // at the same value, the one that excludes it (or is empty) ends first
+            auto current = static_cast<SimpleInterval *>(it->get());
+            auto other_current = static_cast<SimpleInterval *>(other_it->get());
+            if (current->upper < other_current->upper or (current->upper == other_current->upper and (
+                    current->right == BorderType::OPEN or current->is_empty()))) {
+                ++it;
+            } else {
+                ++other_it;
+            }
+        }
+        return false;
+    };
+
+    /**
+     * Check if this interval is contained in another interval in one sweep.
+     * The simple intervals of the other interval are merged into maximal runs on the fly and every simple interval of
+     * this has to lie inside one run.
+     *
+     * @param other The other interval.
+     * @return True if every element of this is an element of other.
+     */
+    bool is_subset_of(const AbstractCompositeSetPtr_t &other) override {
+        auto it = simple_sets->begin();
+
+        // Helper: Consume the simple intervals of this inside the run; false if one of them sticks out of it
+        auto consume = [&](const SimpleInterval &run) {
+            for (; it != simple_sets->end(); ++it) {
+                auto current = static_cast<SimpleInterval *>(it->get());
+                if (current->is_empty()) {
+                    continue;
+                }
+                const bool lower_inside = run.lower < current->lower or (run.lower == current->lower and (
+                        run.left == BorderType::CLOSED or current->left == BorderType::OPEN));
+                const bool upper_inside = current->upper < run.upper or (current->upper == run.upper and (
+                        run.right == BorderType::CLOSED or current->right == BorderType::OPEN));
+                if (lower_inside and upper_inside) {
+                    continue;
+                }
+                const bool after_run = current->lower > run.upper or (current->lower == run.upper and (
+                        current->left == BorderType::OPEN or run.right == BorderType::OPEN));
+                return after_run;
+            }
+            return true;
+        };
+
+        bool has_run = false;
+        SimpleInterval run;
+        for (const auto &simple_set: *other->simple_sets) {
+            auto current = static_cast<SimpleInterval *>(simple_set.get());
+            if (current->is_empty()) {
+                continue;
+            }
+            const bool connected = has_run and (run.upper > current->lower or (run.upper == current->lower and not (
+                    run.right == BorderType::OPEN and current->left == BorderType::OPEN)));
+            if (connected) {
+                if (current->lower == run.lower and current->left == BorderType::CLOSED) {
+                    run.left = BorderType::CLOSED;
+                }
+                if (current->upper > run.upper) {
+                    run.upper = current->upper;
+                    run.right = current->right;
+                } else if (current->upper == run.upper and current->right == BorderType::CLOSED) {
+                    run.right = BorderType::CLOSED;
+                }
+                continue;
+            }
+            if (has_run and not consume(run)) {
+                return false;
+            }
+            run = SimpleInterval(current->lower, current->upper, current->left, current->right);
+            has_run = true;
+        }
+        if (has_run and not consume(run)) {
+            return false;
+        }
+
+        // everything left over lies outside of all runs
+        for (; it != simple_sets->end(); ++it) {
+            if (not(*it)->is_empty()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
     double lower() const {
         return std::dynamic_pointer_cast<SimpleInterval>(*simple_sets->begin())->lower;
     };
@@ -322,6 +588,8 @@ public:
         return std::dynamic_pointer_cast<SimpleInterval>(*simple_sets->rbegin())->upper;
     };
 
+    using AbstractCompositeSet::contains;
+
     bool contains(double element) const {
         for (const auto &simple_set: *simple_sets) {
             auto simple_interval = std::static_pointer_cast<SimpleInterval>(simple_set);
@@ -336,6 +604,19 @@ public:
     static std::shared_ptr<Interval> make_shared(Args &&... args) {
         return std::make_shared<Interval>(std::forward<Args>(args)...);
     }
+protected:
+
+    /**
+     * @return The closed hull [lower, upper] of this.
+     */
+    AbstractSimpleSetPtr_t compute_hull() const override {
+        auto lower = std::static_pointer_cast<SimpleInterval>(*simple_sets->begin())->lower;
+        auto upper = lower;
+        for (const auto &simple_set: *simple_sets) {
+            upper = std::max(upper, std::static_pointer_cast<SimpleInterval>(simple_set)->upper);
+        }
+        return SimpleInterval::make_shared(lower, upper, BorderType::CLOSED, BorderType::CLOSED);
+    };
 
 };
 
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "batch.h"
+#include "sigma_algebra.h"
+#include "spatial_index.h"
+#include <cstddef>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// FORWARD DECLARATIONS
+class MaterializedView;
+
+
+// TYPEDEFS
+using MaterializedViewPtr_t = std::shared_ptr<MaterializedView>;
+
+template<typename... Args>
+MaterializedViewPtr_t make_shared_materialized_view(Args &&... args) {
+    return std::make_shared<MaterializedView>(std::forward<Args>(args)...);
+}
+
+/**
+ * The operands of a materialized view.
+ */
+enum class ViewInput {
+    LHS,
+    RHS
+};
+
+/**
+ * The result of a set operation that is kept up to date while its operands change by a few simple sets at a time.
+ *
+ * The operands are held as pieces (simple sets) with ids. Every piece of the result remembers the pieces it was
+ * derived from, hence a change of an operand only touches the result pieces of the pieces it overlaps:
+ * - lhs ∩ rhs keeps the intersection of every overlapping pair of pieces.
+ * - lhs \ rhs keeps every piece of lhs carved by the pieces of rhs that overlap it. Adding a piece to rhs carves the
+ *   affected parts once more, removing one recomputes the pieces of lhs it had cut.
+ * - lhs ∪ rhs keeps the pieces of lhs and the pieces of rhs \ lhs.
+ * - complement(lhs) keeps universe \ lhs, where the universe is the first piece of lhs and its complement. The
+ *   universe is fixed by that piece, hence it spans the variables of the first piece and later pieces are expected
+ *   to assign the same variables.
+ *
+ * The pieces of the operands and the pieces of the minuend that are carved are indexed by their bounding boxes
+ * (for events), hence an update only visits the pieces its delta may overlap instead of the whole view.
+ *
+ * The simple sets of the result are disjoint if the pieces of the operands are; the view tracks overlapping pieces
+ * and marks the result disjoint when this holds. A view is not thread safe.
+ */
+class MaterializedView {
+public:
+
+    /**
+     * Create a view and compute its result once.
+     * The simple sets of the operands become pieces with ids 0, 1, ... in their order.
+     *
+     * @param operation INTERSECTION, UNION, DIFFERENCE or COMPLEMENT.
+     * @param lhs The left operand.
+     * @param rhs The right operand; ignored for COMPLEMENT.
+     */
+    MaterializedView(SetOperation operation, const AbstractCompositeSetPtr_t &lhs,
+                     const AbstractCompositeSetPtr_t &rhs = nullptr);
+
+    /**
+     * Add a piece to an operand and update the result.
+     *
+     * @param input The operand.
+     * @param piece The simple set.
+     * @return The id of the piece, unique within the operand.
+     */
+    size_t insert(ViewInput input, const AbstractSimpleSetPtr_t &piece);
+
+    /**
+     * Remove a piece from an operand and update the result.
+     *
+     * @param input The operand.
+     * @param id The id of the piece.
+     */
+    void erase(ViewInput input, size_t id);
+
+    /**
+     * @return The ids of the pieces of an operand in increasing order.
+     */
+    std::vector<size_t> ids(ViewInput input) const;
+
+    /**
+     * @return The number of simple sets of the result.
+     */
+    size_t size() const;
+
+    /**
+     * @return A new composite set with the simple sets of the result.
+     */
+    AbstractCompositeSetPtr_t result() const;
+
+private:
+
+    /**
+     * Simple sets by id that can be searched for the ones that may overlap a simple set.
+     *
+     * Simple events are indexed in levels of doubling size (each level a `SpatialIndex`), plus a small buffer of
+     * recent ones that is scanned linearly, like in `EventBuilder`. Erased ids are skipped until they make up half of
+     * the entries, then the levels are rebuilt from the remaining ones. Other simple sets stay in the buffer.
+     */
+    class PieceIndex {
+    public:
+
+        /**
+         * @param indexed True if the simple sets are simple events that can be indexed by bounding boxes.
+         */
+        explicit PieceIndex(bool indexed = false);
+
+        void insert(size_t id, const AbstractSimpleSetPtr_t &simple_set);
+
+        void erase(size_t id);
+
+        /**
+         * @param simple_set The simple set to query with.
+         * @return The ids of the simple sets that may overlap it in increasing order.
+         */
+        std::vector<size_t> candidates(const AbstractSimpleSetPtr_t &simple_set) const;
+
+    private:
+
+        /**
+         * Number of recent simple sets that are scanned linearly before they are indexed.
+         */
+        static constexpr size_t BUFFER_SIZE = 64;
+
+        /**
+         * Level k is empty or holds about 2^k full buffers; `ids` maps the simple sets kept by the level (equivalent
+         * ones are kept once) to their ids.
+         */
+        struct Level {
+            SimpleSetSetPtr_t simple_sets;
+            SpatialIndexPtr_t index;
+            std::unordered_map<const AbstractSimpleSet *, std::vector<size_t>> ids;
+        };
+
+        bool indexed;
+
+        std::unordered_map<size_t, AbstractSimpleSetPtr_t> live;
+
+        std::vector<std::pair<size_t, AbstractSimpleSetPtr_t>> buffer;
+
+        std::vector<Level> levels;
+
+        /**
+         * Number of entries in the buffer and the levels, erased ones included.
+         */
+        size_t stored = 0;
+
+        /**
+         * Build a level from the live entries among some entries and count them as stored.
+         */
+        Level make_level(const std::vector<std::pair<size_t, AbstractSimpleSetPtr_t>> &entries);
+
+        /**
+         * Merge the buffer into the levels.
+         */
+        void flush();
+
+        /**
+         * Rebuild the levels from the live entries only.
+         */
+        void rebuild();
+    };
+
+    /**
+     * A piece of the minuend of a difference and the parts of it that are left.
+     */
+    struct Carving {
+        AbstractSimpleSetPtr_t source;
+        std::vector<AbstractSimpleSetPtr_t> parts;
+
+        /**
+         * The ids of the subtrahends that cut the source.
+         */
+        std::set<size_t> cuts;
+    };
+
+    SetOperation operation;
+
+    /**
+     * An empty composite set of the type of the result.
+     */
+    AbstractCompositeSetPtr_t empty;
+
+    /**
+     * The pieces of lhs and rhs by id.
+     */
+    std::map<size_t, AbstractSimpleSetPtr_t> pieces[2];
+
+    size_t next_id[2] = {0, 0};
+
+    /**
+     * The pieces of lhs and rhs, indexed.
+     */
+    PieceIndex piece_index[2];
+
+    /**
+     * The sources of the carvings by the id of their carving, indexed.
+     */
+    PieceIndex source_index;
+
+    /**
+     * Number of overlapping pairs of pieces of lhs and rhs.
+     */
+    size_t overlaps[2] = {0, 0};
+
+    /**
+     * INTERSECTION: the intersection of the pieces (lhs id, rhs id).
+     */
+    std::map<std::pair<size_t, size_t>, AbstractSimpleSetPtr_t> intersections;
+
+    /**
+     * DIFFERENCE, UNION and COMPLEMENT: the carved pieces of the minuend by id.
+     */
+    std::map<size_t, Carving> carvings;
+
+    /**
+     * Whether the universe of COMPLEMENT is known yet.
+     */
+    bool has_universe = false;
+
+    /**
+     * The operand whose pieces are carved or -1 for the universe of COMPLEMENT.
+     */
+    int minuend() const;
+
+    /**
+     * The operand whose pieces cut the minuend or -1 for INTERSECTION.
+     */
+    int subtrahend() const;
+
+    /**
+     * Carve the source of a carving by every current subtrahend that overlaps it.
+     */
+    void carve(Carving &carving) const;
+
+    /**
+     * @return The non-empty simple sets of the result.
+     */
+    std::vector<AbstractSimpleSetPtr_t> collect() const;
+};
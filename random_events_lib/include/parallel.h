@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// FORWARD DECLARATIONS
+class ThreadPool;
+class WorkStealingExecutor;
+
+
+// TYPEDEFS
+using ThreadPoolPtr_t = std::shared_ptr<ThreadPool>;
+using WorkStealingExecutorPtr_t = std::shared_ptr<WorkStealingExecutor>;
+
+template<typename... Args>
+WorkStealingExecutorPtr_t make_shared_work_stealing_executor(Args &&... args) {
+    return std::make_shared<WorkStealingExecutor>(std::forward<Args>(args)...);
+}
+
+/**
+ * Settings of the parallel execution of set operations.
+ */
+struct ParallelOptions {
+
+    /**
+     * Number of threads that work on one operation, including the calling thread.
+     * 0 uses every hardware thread and 1 runs everything on the calling thread.
+     */
+    size_t threads = 0;
+
+    /**
+     * Loops with fewer independent work items than this run on the calling thread, since handing them out costs
+     * more than it saves.
+     */
+    size_t sequential_cutoff = 32;
+};
+
+/**
+ * @return The settings of the parallel execution of this process.
+ */
+ParallelOptions get_parallel_options();
+
+/**
+ * Change the settings of the parallel execution of this process.
+ * The shared thread pool is replaced if the number of threads changes; operations that are running keep the old pool.
+ *
+ * @param options The new settings.
+ */
+void set_parallel_options(const ParallelOptions &options);
+
+/**
+ * While an instance of this lives, `parallel_for` on the creating thread runs sequentially.
+ * Executors that already keep every core busy with independent work use this to avoid oversubscription.
+ */
+class SequentialScope {
+public:
+    SequentialScope();
+
+    ~SequentialScope();
+
+    SequentialScope(const SequentialScope &) = delete;
+
+    SequentialScope &operator=(const SequentialScope &) = delete;
+
+private:
+    bool previous;
+};
+
+/**
+ * @return True if the calling thread is inside a `SequentialScope`.
+ */
+bool in_sequential_scope();
+
+/**
+ * Fixed number of worker threads that run submitted tasks in submission order.
+ */
+class ThreadPool {
+public:
+
+    /**
+     * Start the worker threads.
+     *
+     * @param workers The number of worker threads.
+     */
+    explicit ThreadPool(size_t workers);
+
+    /**
+     * Run the remaining tasks and join the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @return The number of worker threads.
+     */
+    size_t size() const;
+
+    /**
+     * Queue a task for the worker threads. Tasks must not throw.
+     *
+     * @param task The task.
+     */
+    void submit(std::function<void()> task);
+
+private:
+
+    std::vector<std::thread> workers;
+
+    std::deque<std::function<void()>> tasks;
+
+    std::mutex mutex;
+
+    std::condition_variable wake_up;
+
+    bool stopping = false;
+
+    void work();
+};
+
+/**
+ * Fixed set of threads that run batches of independent work items with work stealing.
+ *
+ * Every thread (the calling thread included) starts with a contiguous block of the items, hence neighbouring items,
+ * which often share operands, stay on one core. A thread that runs out of items steals the upper half of the
+ * remaining block of another thread. Items run inside a `SequentialScope` and under the `OperationControl` of the
+ * thread that called `run`.
+ *
+ * One batch runs at a time; concurrent calls of `run` wait for each other.
+ */
+class WorkStealingExecutor {
+public:
+
+    /**
+     * Start the worker threads.
+     *
+     * @param threads The number of threads that work on a batch, including the calling thread; 0 uses every
+     * hardware thread.
+     * @param pin_threads Whether to pin every worker thread to one core (Linux only, ignored elsewhere).
+     */
+    explicit WorkStealingExecutor(size_t threads = 0, bool pin_threads = false);
+
+    /**
+     * Join the worker threads.
+     */
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+
+    WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+    /**
+     * @return The number of threads that work on a batch, including the calling thread.
+     */
+    size_t size() const;
+
+    /**
+     * Call a function for every index in [0, count) and wait until all calls finished.
+     * Every index runs even if another one throws; the exception of the smallest failing index is rethrown.
+     *
+     * @param count The number of indices.
+     * @param function The function to call with every index.
+     */
+    void run(size_t count, const std::function<void(size_t)> &function);
+
+private:
+
+    struct Batch;
+
+    std::vector<std::thread> workers;
+
+    std::shared_ptr<Batch> current;
+
+    size_t generation = 0;
+
+    bool stopping = false;
+
+    std::mutex mutex;
+
+    std::condition_variable wake_up;
+
+    /**
+     * Serializes the batches.
+     */
+    std::mutex run_mutex;
+
+    void work(size_t slot);
+};
+
+/**
+ * @return The thread pool shared by the set operations, sized by `get_parallel_options`.
+ */
+ThreadPoolPtr_t default_thread_pool();
+
+/**
+ * @return The work stealing executor shared by batches, sized by `get_parallel_options`.
+ */
+WorkStealingExecutorPtr_t default_work_stealing_executor();
+
+/**
+ * Run chunks of work on the calling thread and the shared thread pool.
+ * The helpers run under the `OperationControl` of the calling thread.
+ *
+ * The chunks are claimed one after another by the calling thread and by helpers on the pool, hence nested calls from
+ * inside a chunk cannot deadlock: the caller only waits for chunks that are already running. The first exception
+ * thrown by a chunk is rethrown after every claimed chunk finished; unclaimed chunks are skipped.
+ *
+ * @param chunks The number of chunks.
+ * @param threads The maximal number of threads, including the calling thread.
+ * @param run_chunk The function that runs a chunk given its number.
+ */
+void run_chunks(size_t chunks, size_t threads, const std::function<void(size_t)> &run_chunk);
+
+/**
+ * Call a function for every index in [0, count) using the settings of `get_parallel_options`.
+ *
+ * Calls for different indices may run concurrently and in any order. To keep results deterministic, every call
+ * writes to its own slot of a preallocated output, which the caller combines in index order afterwards.
+ *
+ * @param count The number of indices.
+ * @param function The function to call with every index.
+ * @param grain The number of consecutive indices a thread claims at once.
+ */
+template<typename Function>
+void parallel_for(size_t count, Function &&function, size_t grain = 1) {
+    auto options = get_parallel_options();
+    if (count < std::max<size_t>(options.sequential_cutoff, 2) || options.threads == 1 || in_sequential_scope()) {
+        for (size_t index = 0; index < count; ++index) {
+            function(index);
+        }
+        return;
+    }
+
+    grain = std::max<size_t>(grain, 1);
+    run_chunks((count + grain - 1) / grain, options.threads, [&](size_t chunk) {
+        auto end = std::min(count, (chunk + 1) * grain);
+        for (size_t index = chunk * grain; index < end; ++index) {
+            function(index);
+        }
+    });
+}
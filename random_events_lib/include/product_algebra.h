@@ -1,15 +1,20 @@
 #pragma once
 
 #include "sigma_algebra.h"
+#include <atomic>
 #include <map>
 #include <memory>
 #include "variable.h"
 #include <variant>
+#include <vector>
+#include <cstdint>
+#include <functional>
 #include "variable.h"
 
 // FORWARD DECLARATIONS
 class SimpleEvent;
 class Event;
+class SpatialIndex;
 
 
 // TYPEDEFS
@@ -35,6 +40,60 @@ VariableSetPtr_t make_shared_variable_set(Args &&... args) {
     return std::make_shared<VariableSet>(std::forward<Args>(args)...);
 }
 
+/**
+ * A read-only column of a columnar batch of points.
+ * `Continuous` variables are given as doubles, `Integer` variables as int64 values and `Symbolic` variables as the
+ * int64 index of their element.
+ */
+using Column_t = std::variant<const double *, const std::int64_t *>;
+
+/**
+ * Columnar batch of points: one contiguous column per variable, all of the same length.
+ */
+using ColumnMap = std::map<AbstractVariablePtr_t, Column_t, PointerLess<AbstractVariablePtr_t>>;
+
+/**
+ * Row indices of a columnar batch of points that are still under consideration.
+ */
+using RowSelection = std::vector<std::uint32_t>;
+
+/**
+ * A variable of a simple event together with the assignment that is kept in the pieces emitted after it, the
+ * assignment that is peeled off into a piece of its own and the assignment used in the pieces emitted before it.
+ *
+ * When complementing a simple event, `kept` is the original assignment, `peeled` is its complement and `unpeeled` is
+ * the domain of the variable.
+ * When forming the difference A \ B, `kept` is A ∩ B, `peeled` is A \ B and `unpeeled` is A.
+ */
+struct VariablePeel {
+    AbstractVariablePtr_t variable;
+    AbstractCompositeSetPtr_t kept;
+    AbstractCompositeSetPtr_t peeled;
+    AbstractCompositeSetPtr_t unpeeled;
+};
+
+using VariablePeels = std::vector<VariablePeel>;
+
+/**
+ * Strategy that decides in which order the variables of a simple event are peeled off.
+ * The strategy reorders the peels in place. Every order yields a correct disjoint decomposition, but the number and
+ * shape of the pieces depend on it.
+ */
+using VariableOrderingStrategy_t = std::function<void(VariablePeels &)>;
+
+/**
+ * Peel off the variables in name order (the order of `PointerLess`).
+ */
+void name_ordering(VariablePeels &peels);
+
+/**
+ * Peel off the cheap variables first.
+ * Variables whose peeled assignment is empty (the kept assignment is the full domain) come first, followed by the
+ * variables ordered by the number of simple sets in the peeled and then in the kept assignment.
+ * Ties keep the name order, hence the ordering is deterministic.
+ */
+void cost_aware_ordering(VariablePeels &peels);
+
 struct VariableMapHash {
     std::size_t operator()(const VariableMap &vm) const {
         std::size_t seed = 0;
@@ -57,9 +116,26 @@ public:
      */
     explicit SimpleEvent(const VariableSetPtr_t &variables);
 
+    /**
+     * Create a simple event that shares the variable map of another one.
+     */
+    SimpleEvent(const SimpleEvent &other);
+
+    SimpleEvent &operator=(const SimpleEvent &other);
+
+    /**
+     * The assignments of this simple event. The map may be shared with other simple events, hence it is replaced
+     * instead of modified.
+     */
     VariableMapPtr_t variable_map;
 
-    void fill_missing_variables(const VariableSetPtr_t &variables) const;
+    /**
+     * Assign every variable that is missing in this simple event to its domain.
+     * The variable map is copied before it is extended (copy on write), so simple events sharing it are not affected.
+     *
+     * @param variables The variables this simple event should have.
+     */
+    void fill_missing_variables(const VariableSetPtr_t &variables);
 
     VariableSetPtr_t get_variables() const;
 
@@ -70,17 +146,114 @@ public:
 
     AbstractSimpleSetPtr_t intersection_with(const AbstractSimpleSetPtr_t &other) override;
 
+    /**
+     * Complement this simple event using the `cost_aware_ordering`.
+     *
+     * @return The complement as disjoint set of simple events.
+     */
     SimpleSetSetPtr_t complement() override;
 
+    /**
+     * Complement this simple event.
+     *
+     * @param ordering The strategy that decides in which order the variables are peeled off.
+     * @return The complement as disjoint set of simple events.
+     */
+    SimpleSetSetPtr_t complement(const VariableOrderingStrategy_t &ordering);
+
+    /**
+     * Produce the complement of this using the `cost_aware_ordering`, one simple event at a time.
+     * The complements of the assignments are computed up front; every simple event is built when it is asked for.
+     *
+     * @return The generator of the complement.
+     */
+    PieceGeneratorPtr_t complement_pieces() override;
+
+    /**
+     * Form the difference with another simple event using the `cost_aware_ordering`.
+     *
+     * @param other The other simple event.
+     * @return The difference as disjoint set of at most v simple events.
+     */
+    SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t &other) override;
+
+    /**
+     * Form the difference with another simple event in one pass.
+     * Variables where the other event does not constrain this one are skipped.
+     *
+     * @param other The other simple event.
+     * @param ordering The strategy that decides in which order the variables are peeled off.
+     * @return The difference as disjoint set of at most v simple events.
+     */
+    SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t &other, const VariableOrderingStrategy_t &ordering);
+
+    /**
+     * Check if this simple event is contained in another one, variable by variable.
+     * A variable missing in the other event is unconstrained by it; a variable missing in this event is assigned its
+     * domain.
+     *
+     * @param other The other simple event.
+     * @return True if this is a subset of other.
+     */
+    bool is_subset_of(const AbstractSimpleSetPtr_t &other) override;
+
+    /**
+     * Check if this simple event overlaps another one, variable by variable, without forming the intersection.
+     * A variable missing in one of the simple events is unconstrained by it.
+     *
+     * @param other The other simple event.
+     * @return True if the intersection is not empty.
+     */
+    bool intersects(const AbstractSimpleSetPtr_t &other) override;
+
     bool contains(const ElementaryVariant *element) override;
 
+    /**
+     * Filter a selection of rows of a columnar batch down to the rows contained in this simple event.
+     * The variables are evaluated one after another and rows rejected by one variable are not looked at again.
+     * Variables assigned to their full domain need no column.
+     *
+     * @param columns The columns of the batch.
+     * @param selection The rows to test, in increasing order. Overwritten with the contained rows.
+     * @param dense True if the selection contains every row of the batch, which enables contiguous scans.
+     */
+    void filter_contained(const ColumnMap &columns, RowSelection &selection, bool dense = false) const;
+
     bool is_empty() override;
 
     std::string *non_empty_to_string() override;
 
+    /**
+     * Combine the names of the variables and the fingerprints of their assignments.
+     * The fingerprint is cached together with a digest of the variables and the versions of their assignments, hence
+     * replacing the variable map, overwriting an assignment or modifying one in place recomputes it. Checking the
+     * digest walks the variable map but neither hashes names nor locks assignments. Concurrent calls are safe.
+     *
+     * @return The fingerprint.
+     */
+    std::uint64_t fingerprint() const override;
+
+    /**
+     * @return The estimated bytes of this and of the assignments of its variables.
+     */
+    size_t memory_usage() const override;
+
     bool operator==(const AbstractSimpleSet &other) override;
 
+    /**
+     * Order simple events by their fingerprint and, if the fingerprints are equal, lexicographically by their
+     * variable maps. Comparing cached fingerprints first spares tree operations on sets of simple events from comparing
+     * the assignments of both variable maps.
+     *
+     * @param other The other simple event.
+     * @return True if this is ordered before other.
+     */
     bool operator<(const AbstractSimpleSet &other) override;
+
+private:
+
+    mutable std::atomic<std::uint64_t> cached_fingerprint{0};
+    mutable std::atomic<std::uint64_t> fingerprint_digest{0};
 };
 
 class Event: public AbstractCompositeSet {
@@ -90,12 +263,32 @@ public:
     explicit Event(const SimpleSetSetPtr_t &simple_events);
     explicit Event(const SimpleEventPtr_t &simple_event);
 
-    void fill_missing_variables(const VariableSetPtr_t &variable_set) const;
+    /**
+     * Assign every variable that is missing in a simple event of this to its domain.
+     * Simple events that miss variables are replaced by filled copies; the simple events themselves may be shared
+     * with other events and are not modified.
+     *
+     * @param variable_set The variables every simple event should have.
+     */
+    void fill_missing_variables(const VariableSetPtr_t &variable_set);
 
-    void fill_missing_variables() const;
+    /**
+     * Assign the variables that some simple event of this constrains to their domain in every other simple event.
+     */
+    void fill_missing_variables();
 
     VariableSet get_variables_from_simple_events() const;
 
+    /**
+     * Project this event onto some variables.
+     *
+     * Simple events with equal projections are collapsed (sort and unique, O(n log n)) before the distinct
+     * projections are made disjoint. The result is cached per set of variables; the cache is dropped as soon as the
+     * simple events are modified or replaced. Every call returns a new event, so callers may modify it.
+     *
+     * @param variables The variables to keep.
+     * @return The marginal event.
+     */
     AbstractCompositeSetPtr_t marginal(const VariableSetPtr_t &variables) const;
 
     AbstractCompositeSetPtr_t simplify() override;
@@ -103,4 +296,74 @@ public:
     std::tuple<EventPtr_t , bool> simplify_once();
 
     AbstractCompositeSetPtr_t make_new_empty() const override;
+
+    /**
+     * Create an equal event of pairwise disjoint simple events.
+     *
+     * Every simple event contributes the part that no earlier simple event covers. That part is carved out by cutting
+     * at the faces of the overlapping earlier simple events, one variable at a time (k-d style); the bounding box
+     * index restricts the cuts to simple events that actually overlap. Finally, pieces that agree on all but one
+     * variable (equal slabs) are merged.
+     *
+     * Size of the result: simple events that overlap no other simple event are kept as they are. Every piece lies
+     * inside a cell of the grid spanned by all interval endpoints and symbolic elements, hence the result never
+     * exceeds ∏ c_v simple events, where c_v is 2 k_v + 1 for an interval variable with k_v distinct finite endpoints
+     * and the size of the domain for a symbolic variable.
+     *
+     * @return The disjoint event.
+     */
+    AbstractCompositeSetPtr_t make_disjoint() const override;
+
+    /**
+     * Drop every simple event that is contained in another simple event of this.
+     * For many simple events, containment is only tested against the simple events whose bounding boxes overlap.
+     *
+     * @return The number of dropped simple events.
+     */
+    size_t remove_dominated_simple_sets() override;
+
+    /**
+     * Check which points of a columnar batch are contained in this event.
+     * Rows already accepted by one simple event are not tested against the following ones.
+     *
+     * @param columns One column per constrained variable.
+     * @param rows The number of rows of every column.
+     * @return A mask with one entry per row that is 1 if the point is contained in this and 0 otherwise.
+     */
+    std::vector<std::uint8_t> contains_points(const ColumnMap &columns, size_t rows) const;
+
+    /**
+     * Build a bounding box index over the simple events of this.
+     * While the index is up to date, intersection, difference and containment only touch simple events whose boxes
+     * overlap. The index goes stale (and is ignored) as soon as the simple events are modified or replaced.
+     */
+    void build_index();
+
+    /**
+     * @return The index over the simple events or nullptr if none was built or it is stale.
+     */
+    std::shared_ptr<SpatialIndex> get_index() const;
+
+    std::optional<std::vector<AbstractSimpleSetPtr_t>>
+    overlap_candidates(const AbstractSimpleSetPtr_t &simple_set) const override;
+
+protected:
+
+    /**
+     * The hull of an event is a simple event over the variables that every simple event constrains. Interval
+     * variables are assigned the hull of their assignments and symbolic variables the union of their assignments.
+     *
+     * @return The hull.
+     */
+    AbstractSimpleSetPtr_t compute_hull() const override;
+
+private:
+    std::shared_ptr<SpatialIndex> index;
+
+    struct MarginalCache;
+
+    /**
+     * Marginals of this event, shared by copies of this event and guarded by a mutex.
+     */
+    std::shared_ptr<MarginalCache> marginal_cache;
 };
\ No newline at end of file
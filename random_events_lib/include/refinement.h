@@ -0,0 +1,41 @@
+#pragma once
+
+#include "product_algebra.h"
+#include <vector>
+
+/**
+ * A cell of the common refinement of several events.
+ *
+ * The atom is the set of points that lies inside exactly the events marked in its signature and outside all others.
+ * It is given as an event of pairwise disjoint simple events.
+ */
+struct RefinementAtom {
+
+    /**
+     * For every input event, true if the atom lies inside of it.
+     */
+    std::vector<bool> signature;
+
+    /**
+     * The points of the atom.
+     */
+    EventPtr_t event;
+};
+
+/**
+ * Compute the common refinement (the atoms) of several events.
+ *
+ * The refinement is built directly instead of intersecting and subtracting all 2^N combinations of events. The
+ * variables are processed one after another in name order. On every variable, the simple events that are still
+ * possible cut the axis into elementary cells (the distinct interval endpoints and the open gaps between them, or
+ * the elements of a symbolic domain). Cells that are covered by the same simple events share their refinement of the
+ * remaining variables, which is computed once and memoized. Cells whose refinements coincide are merged again, hence
+ * every atom is described by few, maximal simple events.
+ *
+ * Variables that are missing in a simple event are unconstrained by it.
+ *
+ * @param events The events to refine.
+ * @param include_outside Whether to include the atom that lies outside of all events.
+ * @return The non-empty atoms ordered by their signature.
+ */
+std::vector<RefinementAtom> common_refinement(const std::vector<EventPtr_t> &events, bool include_outside = true);
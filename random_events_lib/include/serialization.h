@@ -0,0 +1,224 @@
+#pragma once
+
+#include "product_algebra.h"
+#include "set.h"
+#include "variable.h"
+#include <cstdint>
+#include <initializer_list>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * The kinds of records of a serialized stream.
+ */
+enum class RecordKind : std::uint8_t {
+    INTERVAL = 0,
+    SET = 1,
+    SIMPLE_EVENT = 2,
+    EVENT = 3,
+
+    /**
+     * A set of variables (a schema).
+     */
+    VARIABLES = 4
+};
+
+/**
+ * Writes intervals, sets, simple events, events and variables to a stream in a compact, versioned binary format.
+ *
+ * The stream starts with a header (the magic "REV" and the format version) followed by records. Every record is
+ * its kind, the length of its payload and the payload, hence the payload is encoded in memory and moved to and from
+ * the stream in one call. Inside the payload
+ * - counts, ids and indices are unsigned LEB128 varints, signed values are zigzag encoded,
+ * - the endpoints of an interval are delta encoded against the previous endpoint when they are integral and
+ *   written as raw little endian doubles otherwise; infinite endpoints take no bytes,
+ * - variables and universes of sets are dictionary encoded: they are written once per stream and referenced by id
+ *   afterwards, hence millions of events over the same variables only pay for them once.
+ *
+ * A serializer is not thread safe.
+ */
+class Serializer {
+public:
+
+    /**
+     * Create a serializer and write the header.
+     *
+     * @param stream The stream to write to.
+     */
+    explicit Serializer(std::ostream &stream);
+
+    /**
+     * Write an `Interval`, a `Set` or an `Event` as one record.
+     *
+     * @param set The composite set.
+     */
+    void write(const AbstractCompositeSetPtr_t &set);
+
+    /**
+     * Write a simple event as one record.
+     *
+     * @param simple_event The simple event.
+     */
+    void write(const SimpleEventPtr_t &simple_event);
+
+    /**
+     * Write a set of variables as one record.
+     *
+     * @param variables The variables.
+     */
+    void write(const VariableSetPtr_t &variables);
+
+private:
+
+    std::ostream &stream;
+
+    /**
+     * The payload of the current record.
+     */
+    std::string buffer;
+
+    /**
+     * The ids of the variables (by name) and universes written so far.
+     */
+    std::map<AbstractVariablePtr_t, size_t, PointerLess<AbstractVariablePtr_t>> variable_ids;
+    std::map<AllSetElementsPtr_t, size_t> universe_ids;
+
+    void write_varint(std::uint64_t value);
+
+    void write_signed(std::int64_t value);
+
+    void write_double(double value);
+
+    void write_string(const std::string &value);
+
+    void write_universe(const AllSetElementsPtr_t &universe);
+
+    void write_variable(const AbstractVariablePtr_t &variable);
+
+    void write_interval(const AbstractCompositeSet &interval);
+
+    void write_set(const Set &set);
+
+    void write_simple_event(const SimpleEvent &simple_event);
+
+    /**
+     * Write the kind, length and payload of the current record to the stream.
+     */
+    void flush(RecordKind kind);
+};
+
+/**
+ * Reads the records written by a `Serializer`.
+ * Malformed, truncated or unknown input raises `std::invalid_argument`.
+ *
+ * A deserializer is not thread safe.
+ */
+class Deserializer {
+public:
+
+    /**
+     * Create a deserializer and read the header.
+     *
+     * @param stream The stream to read from.
+     */
+    explicit Deserializer(std::istream &stream);
+
+    /**
+     * @return True if there are no records left.
+     */
+    bool at_end();
+
+    /**
+     * @return The kind of the next record.
+     */
+    RecordKind next_kind();
+
+    /**
+     * Read an `Interval`, a `Set` or an `Event` record.
+     *
+     * @return The composite set; an event is marked disjoint if it was known to be disjoint when written.
+     */
+    AbstractCompositeSetPtr_t read_set();
+
+    /**
+     * Read a simple event record.
+     *
+     * @return The simple event.
+     */
+    SimpleEventPtr_t read_simple_event();
+
+    /**
+     * Read a variables record.
+     *
+     * @return The variables.
+     */
+    VariableSetPtr_t read_variables();
+
+private:
+
+    std::istream &stream;
+
+    /**
+     * The payload of the current record and the read position in it.
+     */
+    std::string buffer;
+    size_t position = 0;
+
+    /**
+     * The variables and universes read so far, by id.
+     */
+    std::vector<AbstractVariablePtr_t> variables;
+    std::vector<AllSetElementsPtr_t> universes;
+
+    std::uint64_t read_varint();
+
+    std::int64_t read_signed();
+
+    double read_double();
+
+    std::string read_string();
+
+    AllSetElementsPtr_t read_universe();
+
+    AbstractVariablePtr_t read_variable();
+
+    IntervalPtr_t read_interval();
+
+    SetPtr_t read_set_payload();
+
+    SimpleEventPtr_t read_simple_event_payload();
+
+    /**
+     * Read the next record into the buffer.
+     * The payload is read in bounded chunks, hence a declared length beyond the end of the stream raises
+     * `std::invalid_argument` after reading what is there instead of allocating the declared length up front.
+     *
+     * @param expected The kinds the caller can read.
+     * @return The kind of the record.
+     */
+    RecordKind load(std::initializer_list<RecordKind> expected);
+
+    /**
+     * Check that the whole payload of the current record was read.
+     */
+    void finish() const;
+};
+
+/**
+ * Serialize a single `Interval`, `Set` or `Event` into a self-contained byte string.
+ *
+ * @param set The composite set.
+ * @return The bytes.
+ */
+std::string serialize(const AbstractCompositeSetPtr_t &set);
+
+/**
+ * Deserialize the first composite set of a byte string created by `serialize` or a `Serializer`.
+ *
+ * @param data The bytes.
+ * @return The composite set.
+ */
+AbstractCompositeSetPtr_t deserialize(const std::string &data);
@@ -55,6 +55,37 @@ public:
 
     SimpleSetSetPtr_t complement() override;
 
+    /**
+     * Form the difference with another set element directly.
+     *
+     * @param other The other set element.
+     * @return The empty set if both elements are equal and this element otherwise.
+     */
+    SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t &other) override;
+
+    /**
+     * A set element is a subset of another set element if both are equal.
+     *
+     * @param other The other set element.
+     * @return True if this is a subset of other.
+     */
+    bool is_subset_of(const AbstractSimpleSetPtr_t &other) override;
+
+    /**
+     * Two set elements intersect if both are equal and not empty.
+     *
+     * @param other The other set element.
+     * @return True if the intersection is not empty.
+     */
+    bool intersects(const AbstractSimpleSetPtr_t &other) override;
+
+    /**
+     * @return A fingerprint of the element index.
+     */
+    std::uint64_t fingerprint() const override;
+
+    size_t memory_usage() const override;
+
     bool contains(const ElementaryVariant *element) override;
 
     bool is_empty() override;
@@ -113,6 +144,39 @@ public:
 
     AbstractCompositeSetPtr_t make_new_empty() const override;
 
+    /**
+     * The elements of a set are unique, hence none of them is dominated by another.
+     *
+     * @return 0
+     */
+    size_t remove_dominated_simple_sets() override;
+
+    /**
+     * Check if this set shares an element with another set by walking both (ordered) sets in lock-step.
+     *
+     * @param other The other set.
+     * @return True if the intersection is not empty.
+     */
+    bool intersects(const AbstractCompositeSetPtr_t &other) override;
+
+    /**
+     * Check if every element of this set is an element of another set by walking both (ordered) sets in lock-step.
+     *
+     * @param other The other set.
+     * @return True if this is a subset of other.
+     */
+    bool is_subset_of(const AbstractCompositeSetPtr_t &other) override;
+
+    using AbstractCompositeSet::contains;
+
+    /**
+     * Check if an element is contained in this set.
+     *
+     * @param element_index The index of the element in the all_elements set.
+     * @return True if the element is contained in this.
+     */
+    bool contains(int element_index) const;
+
     std::string *to_string() override;
 
 };
\ No newline at end of file
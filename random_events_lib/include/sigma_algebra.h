@@ -1,14 +1,20 @@
 #pragma once
 
+#include "flat_set.h"
+#include <atomic>
+#include <cstdint>
 #include <set>
 #include <vector>
 #include <tuple>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 
 // FORWARD DECLARATIONS
 class AbstractSimpleSet;
 class AbstractCompositeSet;
+class PieceGenerator;
 
 
 // TYPE DEFINITIONS
@@ -21,8 +27,9 @@ struct PointerLess {
 
 typedef std::shared_ptr<AbstractSimpleSet> AbstractSimpleSetPtr_t;
 typedef std::shared_ptr<AbstractCompositeSet> AbstractCompositeSetPtr_t;
+typedef std::shared_ptr<PieceGenerator> PieceGeneratorPtr_t;
 
-typedef std::set<AbstractSimpleSetPtr_t, PointerLess<AbstractSimpleSetPtr_t>> SimpleSetSet_t;
+typedef FlatSet<AbstractSimpleSetPtr_t, PointerLess<AbstractSimpleSetPtr_t>> SimpleSetSet_t;
 typedef std::shared_ptr<SimpleSetSet_t> SimpleSetSetPtr_t;
 
 template<typename... Args>
@@ -38,6 +45,58 @@ union ElementaryVariant {
     std::string s;
 };
 
+/**
+ * Process wide counters of the set operations, for instrumentation.
+ * The counters are updated atomically and can be reset at any time.
+ */
+struct OperationStatistics {
+
+    /**
+     * Number of unions of composite sets that had to be made disjoint.
+     */
+    std::atomic<std::uint64_t> union_calls{0};
+
+    /**
+     * Number of simple sets that entered the dominance pruning of these unions.
+     */
+    std::atomic<std::uint64_t> union_inputs{0};
+
+    /**
+     * Number of simple sets that were dropped by the dominance pruning because another simple set contains them.
+     */
+    std::atomic<std::uint64_t> dominated_removed{0};
+
+    /**
+     * Number of unions, intersections and differences that were answered without decomposing anything because the
+     * bounding hulls of the operands do not overlap.
+     */
+    std::atomic<std::uint64_t> hull_fast_paths{0};
+
+    /**
+     * Set all counters to zero.
+     */
+    void reset();
+};
+
+/**
+ * @return The counters of the set operations of this process.
+ */
+OperationStatistics &operation_statistics();
+
+/**
+ * Mix a value into a fingerprint.
+ *
+ * @param seed The fingerprint so far.
+ * @param value The value to mix in.
+ * @return The new fingerprint.
+ */
+inline std::uint64_t combine_fingerprints(std::uint64_t seed, std::uint64_t value) {
+    std::uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 template <typename T>
 bool compare_sets(const T &lhs, const T &rhs) {
     if (lhs->size() != rhs->size()) {
@@ -76,6 +135,14 @@ public:
     */
     virtual SimpleSetSetPtr_t complement()= 0;
 
+    /**
+    * Produce the complement of this one simple set at a time (see `PieceGenerator`).
+    * The generic implementation materializes `complement` and may be overwritten by lazy specialisations.
+    *
+    * @return The generator of the complement.
+    */
+    virtual PieceGeneratorPtr_t complement_pieces();
+
     /**
     * Check if an elementary event is contained in this.
     *
@@ -94,11 +161,54 @@ public:
 
     /**
     * Form the difference with another simple set.
+    * The generic implementation computes A ∩ (A ∩ B)^c and may be overwritten by faster specialisations.
     *
     * @param other The other simple set.
     * @return The difference as disjoint composite set.
     */
-    SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t& other);
+    virtual SimpleSetSetPtr_t difference_with(const AbstractSimpleSetPtr_t& other);
+
+    /**
+    * Check if this is contained in another simple set.
+    * The generic implementation checks if the difference is empty and may be overwritten by faster specialisations.
+    *
+    * @param other The other simple set.
+    * @return True if every element of this is an element of other.
+    */
+    virtual bool is_subset_of(const AbstractSimpleSetPtr_t &other);
+
+    /**
+    * Check if this and another simple set have an element in common.
+    * The generic implementation forms the intersection and may be overwritten by specialisations that allocate
+    * nothing.
+    *
+    * @param other The other simple set.
+    * @return True if the intersection is not empty.
+    */
+    virtual bool intersects(const AbstractSimpleSetPtr_t &other);
+
+    /**
+    * @param other The other simple set.
+    * @return True if this and other have no element in common.
+    */
+    bool is_disjoint_from(const AbstractSimpleSetPtr_t &other);
+
+    /**
+    * Compute a fingerprint of the parts of this that take part in ordering.
+    * Simple sets that are equivalent under operator< must have equal fingerprints, hence orderings may compare
+    * fingerprints first and fall back to operator< only if they are equal. The generic implementation returns 0.
+    *
+    * @return The fingerprint.
+    */
+    virtual std::uint64_t fingerprint() const;
+
+    /**
+    * Estimate the bytes this simple set takes, for resource budgets.
+    * The generic implementation returns the size of an abstract simple set and should be overwritten.
+    *
+    * @return The estimated bytes.
+    */
+    virtual size_t memory_usage() const;
 
     virtual std::string *non_empty_to_string()= 0;
 
@@ -142,6 +252,13 @@ std::vector<std::tuple<T, T>> unique_combinations(const std::vector<T> &elements
 /**
 * Abstract class for composite elements.
 * Composite elements contain a **disjoint** union of (abstract) simple sets.
+*
+* Thread safety: the set operations (intersection, union, complement, difference, the predicates and the queries) do
+* not modify their operands and never return one of them; simple sets are shared between results and treated as
+* immutable. Any number of threads may therefore query the same composite set concurrently, including the caches
+* that are filled lazily on first use, which are synchronized. Modifying a composite set (inserting simple sets,
+* `simplify_once`, `remove_dominated_simple_sets`, filling missing variables or building an index) requires exclusive
+* access.
 */
 class AbstractCompositeSet : public std::enable_shared_from_this<AbstractCompositeSet>{
 public:
@@ -150,20 +267,62 @@ public:
 
     AbstractCompositeSet() = default;
 
-    virtual ~AbstractCompositeSet() {
-        simple_sets->clear();
-    }
+    virtual ~AbstractCompositeSet() = default;
 
     /**
-    * @return True if this is empty.
+    * @return True if this is empty. The answer is cached.
     */
     bool is_empty();
 
     /**
-     * @return True if the composite set is disjoint union of simple sets.
+     * @return True if the composite set is disjoint union of simple sets. The answer is cached.
      */
     bool is_disjoint();
 
+    /**
+     * @return True if this is known to be a disjoint union of simple sets without testing it.
+     */
+    bool is_known_disjoint() const;
+
+    /**
+     * @return True if this is known to be the result of `simplify`.
+     */
+    bool is_known_simplified() const;
+
+    /**
+     * Remember that this is a disjoint union of simple sets.
+     * Operations call this on results that are disjoint by construction.
+     */
+    void mark_disjoint() const;
+
+    /**
+     * Remember that this is simplified (and hence disjoint).
+     */
+    void mark_simplified() const;
+
+    /**
+     * Get the bounding hull of this, a simple set that contains every simple set of this. The hull is cached.
+     *
+     * @return The hull or nullptr if this is empty or its type of composite set has no hull.
+     */
+    AbstractSimpleSetPtr_t get_hull() const;
+
+    /**
+     * Check if this may overlap another composite set by comparing the bounding hulls.
+     *
+     * @param other The other composite set.
+     * @return False if this and other are certainly disjoint.
+     */
+    bool may_overlap(const AbstractCompositeSet &other) const;
+
+    /**
+     * Check if this may overlap a simple set by comparing it with the bounding hull.
+     *
+     * @param simple_set The simple set.
+     * @return False if this and the simple set are certainly disjoint.
+     */
+    bool may_overlap(const AbstractSimpleSetPtr_t &simple_set) const;
+
     /**
     * Simplify the composite set into a shorter but equal representation.
     * The size (shortness9 refers to the number of simple sets contained.
@@ -183,6 +342,20 @@ public:
      */
     std::string *to_string();
 
+    /**
+     * Combine the fingerprints of the simple sets of this in iteration order. The fingerprint is cached.
+     *
+     * @return The fingerprint, equal for composite sets that are equivalent under operator<.
+     */
+    std::uint64_t fingerprint() const;
+
+    /**
+     * Estimate the bytes this composite set and its simple sets take, for resource budgets.
+     *
+     * @return The estimated bytes.
+     */
+    size_t memory_usage() const;
+
     bool operator==(const AbstractCompositeSet &other) const;
     bool operator!=(const AbstractCompositeSet &other) const;
     bool operator<(const AbstractCompositeSet &other) const;
@@ -206,10 +379,20 @@ public:
 
     /**
     * Create an equal composite set that contains a disjoint union of simple sets.
+    * Subclasses may override this with a decomposition that exploits the structure of their simple sets.
     *
     * @return The disjoint composite set.
     */
-    AbstractCompositeSetPtr_t make_disjoint() const;
+    virtual AbstractCompositeSetPtr_t make_disjoint() const;
+
+    /**
+    * Drop every simple set that is contained in another simple set of this.
+    * This is a cheap pre-pass for unions: dominated simple sets add nothing to the union but would take part in
+    * making it disjoint. The generic implementation tests all pairs and may be overwritten by faster specialisations.
+    *
+    * @return The number of dropped simple sets.
+    */
+    virtual size_t remove_dominated_simple_sets();
 
     /**
      * Form the intersection with an simple set.
@@ -219,6 +402,14 @@ public:
      */
     AbstractCompositeSetPtr_t intersection_with(const AbstractSimpleSetPtr_t &simple_set);
 
+    /**
+     * Form the union of the intersections of this with every simple set of other.
+     * The simple sets of other are intersected independently, on several threads if there are enough of them (see
+     * `ParallelOptions`); the result does not depend on the number of threads.
+     *
+     * @param other The simple sets to intersect with.
+     * @return The intersection.
+     */
     AbstractCompositeSetPtr_t intersection_with(const SimpleSetSetPtr_t &other);
 
     /**
@@ -262,14 +453,132 @@ public:
 
     /**
      * Form the difference with another composite set.
+     * Every simple set of this is reduced by other independently, on several threads if there are enough of them
+     * (see `ParallelOptions`); the result does not depend on the number of threads.
      *
      * @param other The other composite set.
      * @return The difference as disjoint composite set.
      */
     AbstractCompositeSetPtr_t difference_with(const AbstractCompositeSetPtr_t &other);
 
+    /**
+     * Check if this and another composite set have an element in common.
+     * The check stops at the first pair of intersecting simple sets and forms no intersection. Indexed composites only
+     * test the simple sets whose boxes overlap.
+     *
+     * @param other The other composite set.
+     * @return True if the intersection is not empty.
+     */
+    virtual bool intersects(const AbstractCompositeSetPtr_t &other);
+
+    /**
+     * @param other The other composite set.
+     * @return True if this and other have no element in common.
+     */
+    bool is_disjoint_from(const AbstractCompositeSetPtr_t &other);
+
+    /**
+     * Check if this is contained in another composite set.
+     * Every simple set of this that lies inside a single simple set of other is settled without allocating; only
+     * simple sets that are covered by several simple sets of other (or not at all) are subtracted.
+     *
+     * @param other The other composite set.
+     * @return True if every element of this is an element of other.
+     */
+    virtual bool is_subset_of(const AbstractCompositeSetPtr_t &other);
+
+    /**
+     * @param other The other composite set.
+     * @return True if other is a subset of this.
+     */
     bool contains(const AbstractCompositeSetPtr_t &other);
 
+    /**
+     * Insert a simple set into this. The cached invariants are updated instead of dropped; in particular, this stays
+     * known disjoint if the simple set does not overlap the hull of this.
+     *
+     * @param simple_set The simple set to insert.
+     */
     void add_new_simple_set(const AbstractSimpleSetPtr_t& simple_set) const;
 
+    /**
+     * Find the simple sets of this that may overlap a simple set.
+     *
+     * Composites without an index return std::nullopt, which means that every simple set has to be considered.
+     * Indexed composites return a superset of the overlapping simple sets in iteration order.
+     *
+     * @param simple_set The simple set to query with.
+     * @return The candidates or std::nullopt if this has no index.
+     */
+    virtual std::optional<std::vector<AbstractSimpleSetPtr_t>>
+    overlap_candidates(const AbstractSimpleSetPtr_t &simple_set) const;
+
+    /**
+     * Call a function on every simple set of this that may overlap a simple set.
+     *
+     * @param simple_set The simple set to query with.
+     * @param function The function to call with every candidate.
+     */
+    template<typename Function>
+    void for_each_overlap_candidate(const AbstractSimpleSetPtr_t &simple_set, Function &&function) const {
+        if (auto candidates = overlap_candidates(simple_set)) {
+            for (auto const &candidate : *candidates) {
+                function(candidate);
+            }
+        } else {
+            for (auto const &candidate : *simple_sets) {
+                function(candidate);
+            }
+        }
+    }
+
+protected:
+
+    /**
+     * Compute the bounding hull of the non-empty simple sets of this.
+     * The hull has to contain every simple set of this; it may be larger. The generic implementation has no hull.
+     *
+     * @return The hull or nullptr.
+     */
+    virtual AbstractSimpleSetPtr_t compute_hull() const;
+
+    /**
+     * Forget the cached invariants, for subclasses that modify the simple sets themselves in place.
+     */
+    void drop_invariants() const;
+
+private:
+
+    /**
+     * Facts about the simple sets of this that are expensive to recompute.
+     * The invariants belong to the version of the simple sets they were computed for, hence they are dropped as soon
+     * as the simple sets are modified or replaced (other than through `add_new_simple_set`).
+     */
+    struct Invariants {
+        std::uint64_t source_version = 0;
+        std::optional<bool> empty;
+        std::optional<bool> disjoint;
+        std::optional<std::uint64_t> fingerprint;
+        bool simplified = false;
+        bool hull_computed = false;
+        AbstractSimpleSetPtr_t hull;
+    };
+
+    mutable Invariants invariants;
+
+    /**
+     * Guards `invariants`, such that concurrent readers can fill them.
+     */
+    mutable std::mutex invariants_mutex;
+
+    /**
+     * @return The invariants of this, reset if they went stale. The caller has to hold `invariants_mutex`.
+     */
+    Invariants &current_invariants() const;
+
+    /**
+     * @return True if the hulls of this and other are at hand and do not overlap.
+     */
+    bool cached_hulls_are_apart(const AbstractCompositeSet &other) const;
+
 };
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "product_algebra.h"
+#include <cstdint>
+#include <vector>
+
+// FORWARD DECLARATIONS
+class SpatialIndex;
+
+
+// TYPEDEFS
+using SpatialIndexPtr_t = std::shared_ptr<SpatialIndex>;
+
+template<typename... Args>
+SpatialIndexPtr_t make_shared_spatial_index(Args &&... args) {
+    return std::make_shared<SpatialIndex>(std::forward<Args>(args)...);
+}
+
+/**
+ * Axis aligned bounding box of a simple event.
+ *
+ * Interval variables (`Continuous` and `Integer`) are bounded by the closed hull [lower, upper] of their assignment.
+ * Symbolic variables are bounded by a 64 bit mask of their element indices (index mod 64). The mask is exact for
+ * universes of at most 64 elements and conservative for larger ones.
+ *
+ * Bounding boxes are conservative: if two boxes do not overlap, the simple events do not overlap either.
+ */
+struct BoundingBox {
+    std::vector<double> lower;
+    std::vector<double> upper;
+    std::vector<std::uint64_t> masks;
+
+    /**
+     * @return True if this box may overlap the other box.
+     */
+    bool overlaps(const BoundingBox &other) const;
+
+    /**
+     * Grow this box such that it also bounds the other box.
+     */
+    void extend(const BoundingBox &other);
+};
+
+/**
+ * Bounding volume hierarchy over the simple events of an event.
+ *
+ * The index is bulk loaded (k-d style median splits on the interval variable with the largest spread) and immutable
+ * afterwards. Queries return candidate simple events in the iteration order of the indexed set, so results are
+ * deterministic.
+ */
+class SpatialIndex {
+public:
+
+    /**
+     * Build an index over a set of simple events.
+     * The variables of the index are the union of the variables of all simple events.
+     *
+     * @param simple_events The simple events to index.
+     */
+    explicit SpatialIndex(const SimpleSetSetPtr_t &simple_events);
+
+    /**
+     * @return All variables of the index in name order. Points passed to `containing` follow this order.
+     */
+    const std::vector<AbstractVariablePtr_t> &get_variables() const;
+
+    /**
+     * @return The number of indexed simple events.
+     */
+    size_t size() const;
+
+    /**
+     * Check if this index still describes a set of simple events.
+     * The index belongs to the version of the set it was built from, hence it is stale as soon as the set is modified
+     * or replaced.
+     *
+     * @param simple_events The set of simple events.
+     * @return True if the index was built from this version of the set.
+     */
+    bool is_built_from(const SimpleSetSetPtr_t &simple_events) const;
+
+    /**
+     * Compute the bounding box of a simple event in the layout of this index.
+     * Variables of the simple event that are not indexed are ignored.
+     *
+     * @param simple_event The simple event.
+     * @return The bounding box.
+     */
+    BoundingBox bounding_box(const SimpleEvent &simple_event) const;
+
+    /**
+     * Find the indexed simple events whose bounding box overlaps the bounding box of a simple event.
+     * The result is a superset of the simple events that intersect `simple_event`.
+     *
+     * @param simple_event The simple event to query with.
+     * @return The candidates in iteration order of the indexed set.
+     */
+    std::vector<AbstractSimpleSetPtr_t> overlapping(const AbstractSimpleSetPtr_t &simple_event) const;
+
+    /**
+     * Find the indexed simple events that contain a point.
+     * The point assigns one value to every variable of `get_variables()`, in that order. Symbolic variables are
+     * assigned the index of their element.
+     *
+     * @param point The point.
+     * @return The simple events containing the point in iteration order of the indexed set.
+     */
+    std::vector<AbstractSimpleSetPtr_t> containing(const std::vector<double> &point) const;
+
+private:
+
+    /**
+     * A node of the hierarchy. Leaves refer to the range [begin, end) of `order`, inner nodes to two children.
+     */
+    struct Node {
+        size_t begin;
+        size_t end;
+        int left = -1;
+        int right = -1;
+    };
+
+    /**
+     * Maximum number of simple events in a leaf.
+     */
+    static constexpr size_t LEAF_SIZE = 8;
+
+    std::uint64_t source_version = 0;
+
+    std::vector<AbstractVariablePtr_t> variables;
+    std::vector<AbstractVariablePtr_t> interval_variables;
+    std::vector<AbstractVariablePtr_t> symbolic_variables;
+
+    /**
+     * For every entry of `variables`, the position in `interval_variables` or `symbolic_variables`.
+     */
+    std::vector<size_t> layout;
+
+    /**
+     * For every entry of `variables`, true if it is symbolic.
+     */
+    std::vector<bool> is_symbolic;
+
+    std::vector<AbstractSimpleSetPtr_t> simple_events;
+
+    /**
+     * Boxes of the simple events, stored flat (entry-major) for cache friendly scans.
+     */
+    std::vector<double> entry_lower;
+    std::vector<double> entry_upper;
+    std::vector<std::uint64_t> entry_masks;
+
+    /**
+     * Permutation of the entries such that every node covers a contiguous range.
+     */
+    std::vector<size_t> order;
+
+    std::vector<Node> nodes;
+    std::vector<double> node_lower;
+    std::vector<double> node_upper;
+    std::vector<std::uint64_t> node_masks;
+
+    int build(size_t begin, size_t end);
+
+    bool entry_overlaps(size_t entry, const BoundingBox &box) const;
+
+    bool node_overlaps(size_t node, const BoundingBox &box) const;
+
+    std::vector<size_t> query(const BoundingBox &box) const;
+};
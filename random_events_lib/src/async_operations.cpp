@@ -0,0 +1,142 @@
+#include "async_operations.h"
+#include "parallel.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+//
+// ===============================
+//  —— Threads ——
+// ===============================
+//
+
+// Helper: The threads of the asynchronous operations and the tokens of the operations that did not finish yet.
+//   The pool is declared last, such that it joins its threads before the tokens go away.
+struct AsyncRunner {
+    std::mutex mutex;
+    std::map<size_t, CancellationToken> unfinished;
+    size_t next_id = 0;
+    ThreadPool pool{std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+};
+
+// Helper: The runner of this process, created by the first operation and shut down at exit.
+struct AsyncState {
+    std::mutex mutex;
+    std::unique_ptr<AsyncRunner> runner;
+
+    AsyncState() {
+        // the operations use the shared pool of `parallel_for`; creating it first destroys it after this
+        default_thread_pool();
+    }
+
+    ~AsyncState() {
+        shutdown_async_operations();
+    }
+};
+
+static AsyncState &async_state() {
+    static AsyncState state;
+    return state;
+}
+
+void shutdown_async_operations() {
+    std::unique_ptr<AsyncRunner> runner;
+    {
+        auto &state = async_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        runner = std::move(state.runner);
+    }
+    if (runner == nullptr) {
+        return;
+    }
+
+    // 1) Ask every unfinished operation to stop; queued ones stop at their first checkpoint
+    {
+        std::lock_guard<std::mutex> lock(runner->mutex);
+        for (auto &[id, token] : runner->unfinished) {
+            token.cancel();
+        }
+    }
+
+    // 2) Join the threads
+    runner.reset();
+}
+
+// Helper: Run an operation on the threads of the runner under a control made of a token and a progress callback.
+//   Dropping the future does not wait for the operation (unlike std::async); the task owns the operand and the control
+//   until it finishes.
+template<typename Operation>
+static std::future<AbstractCompositeSetPtr_t> run_controlled(const AbstractCompositeSetPtr_t &set,
+                                                             const CancellationToken &token,
+                                                             const ProgressCallback_t &progress,
+                                                             Operation &&operation) {
+    auto control = std::make_shared<OperationControl>();
+    control->token = token;
+    control->progress = progress;
+
+    auto &state = async_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.runner == nullptr) {
+        state.runner = std::make_unique<AsyncRunner>();
+    }
+    auto runner = state.runner.get();
+    size_t id;
+    {
+        std::lock_guard<std::mutex> runner_lock(runner->mutex);
+        id = runner->next_id++;
+        runner->unfinished.emplace(id, token);
+    }
+
+    // the pool destroys the runner only after its threads finished, hence the tasks may refer to it
+    auto task = std::make_shared<std::packaged_task<AbstractCompositeSetPtr_t()>>(
+            [set, control, runner, id, operation = std::forward<Operation>(operation)]() {
+                struct Finish {
+                    AsyncRunner *runner;
+                    size_t id;
+
+                    ~Finish() {
+                        std::lock_guard<std::mutex> finish_lock(runner->mutex);
+                        runner->unfinished.erase(id);
+                    }
+                } finish{runner, id};
+                ControlScope scope(control);
+                checkpoint();
+                return operation(set);
+            });
+    auto future = task->get_future();
+    runner->pool.submit([task]() { (*task)(); });
+    return future;
+}
+
+//
+// ===============================
+//  —— Operations ——
+// ===============================
+//
+
+std::future<AbstractCompositeSetPtr_t> make_disjoint_async(const AbstractCompositeSetPtr_t &set,
+                                                           const CancellationToken &token,
+                                                           const ProgressCallback_t &progress) {
+    return run_controlled(set, token, progress, [](const AbstractCompositeSetPtr_t &operand) {
+        return operand->make_disjoint();
+    });
+}
+
+std::future<AbstractCompositeSetPtr_t> simplify_async(const AbstractCompositeSetPtr_t &set,
+                                                      const CancellationToken &token,
+                                                      const ProgressCallback_t &progress) {
+    return run_controlled(set, token, progress, [](const AbstractCompositeSetPtr_t &operand) {
+        return operand->simplify();
+    });
+}
+
+std::future<AbstractCompositeSetPtr_t> complement_async(const AbstractCompositeSetPtr_t &set,
+                                                        const CancellationToken &token,
+                                                        const ProgressCallback_t &progress) {
+    return run_controlled(set, token, progress, [](const AbstractCompositeSetPtr_t &operand) {
+        return operand->complement();
+    });
+}
@@ -0,0 +1,47 @@
+#include "batch.h"
+#include <stdexcept>
+#include <string>
+
+// Helper: Check if an operation needs a right hand side.
+static bool is_binary(SetOperation operation) {
+    return operation == SetOperation::INTERSECTION || operation == SetOperation::UNION ||
+           operation == SetOperation::DIFFERENCE;
+}
+
+// Helper: Run one operation of a batch.
+static AbstractCompositeSetPtr_t execute(const BatchOperation &operation) {
+    switch (operation.operation) {
+        case SetOperation::INTERSECTION:
+            return operation.lhs->intersection_with(operation.rhs);
+        case SetOperation::UNION:
+            return operation.lhs->union_with(operation.rhs);
+        case SetOperation::DIFFERENCE:
+            return operation.lhs->difference_with(operation.rhs);
+        case SetOperation::COMPLEMENT:
+            return operation.lhs->complement();
+        case SetOperation::MAKE_DISJOINT:
+            return operation.lhs->make_disjoint();
+        case SetOperation::SIMPLIFY:
+            return operation.lhs->simplify();
+    }
+    throw std::invalid_argument("Unknown set operation.");
+}
+
+std::vector<AbstractCompositeSetPtr_t> execute_batch(const std::vector<BatchOperation> &operations,
+                                                     const WorkStealingExecutorPtr_t &executor) {
+    // 1) Validate everything before anything runs
+    for (size_t i = 0; i < operations.size(); ++i) {
+        auto const &operation = operations[i];
+        if (operation.lhs == nullptr || (is_binary(operation.operation) && operation.rhs == nullptr)) {
+            throw std::invalid_argument("Operation " + std::to_string(i) + " of the batch misses an operand.");
+        }
+    }
+
+    // 2) Every operation writes its own slot
+    std::vector<AbstractCompositeSetPtr_t> results(operations.size());
+    auto const &runner = executor != nullptr ? executor : default_work_stealing_executor();
+    runner->run(operations.size(), [&](size_t i) {
+        results[i] = execute(operations[i]);
+    });
+    return results;
+}
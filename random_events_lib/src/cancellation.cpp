@@ -0,0 +1,164 @@
+#include "cancellation.h"
+#include <utility>
+
+//
+// ===============================
+//  —— ResourceBudget ——
+// ===============================
+//
+
+BudgetExceeded::BudgetExceeded(const std::string &resource, const std::string &stage, const BudgetUsage &usage) :
+        std::runtime_error("The " + resource + " budget was exceeded in " + stage + " after " +
+                           std::to_string(usage.simple_sets) + " simple sets (" + std::to_string(usage.bytes) +
+                           " bytes) and " + std::to_string(
+                std::chrono::duration_cast<std::chrono::milliseconds>(usage.elapsed).count()) + " ms."),
+        resource(resource), stage(stage), usage(usage) {}
+
+BudgetUsage BudgetState::usage() const {
+    BudgetUsage result;
+    result.simple_sets = simple_sets.load(std::memory_order_relaxed);
+    result.bytes = bytes.load(std::memory_order_relaxed);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+//
+// ===============================
+//  —— CancellationToken ——
+// ===============================
+//
+
+CancellationToken::CancellationToken() : state(std::make_shared<State>()) {}
+
+void CancellationToken::cancel() {
+    state->cancelled = true;
+}
+
+void CancellationToken::cancel_at(std::chrono::steady_clock::time_point deadline) {
+    state->deadline = deadline.time_since_epoch().count();
+}
+
+void CancellationToken::cancel_after(std::chrono::steady_clock::duration timeout) {
+    cancel_at(std::chrono::steady_clock::now() + timeout);
+}
+
+bool CancellationToken::is_cancelled() const {
+    if (state->cancelled.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    auto deadline = state->deadline.load(std::memory_order_relaxed);
+    if (deadline == std::chrono::steady_clock::time_point::max().time_since_epoch().count()) {
+        return false;
+    }
+    return std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+}
+
+//
+// ===============================
+//  —— ControlScope ——
+// ===============================
+//
+
+static thread_local OperationControlPtr_t installed_control;
+
+ControlScope::ControlScope(OperationControlPtr_t control) : previous(std::move(installed_control)) {
+    installed_control = std::move(control);
+}
+
+ControlScope::~ControlScope() {
+    installed_control = std::move(previous);
+}
+
+const OperationControlPtr_t &current_operation_control() {
+    return installed_control;
+}
+
+//
+// ===============================
+//  —— BudgetScope ——
+// ===============================
+//
+
+// Helper: Start a budget that is charged together with the budget installed on the calling thread.
+static BudgetStatePtr_t make_budget_state(const ResourceBudget &budget) {
+    auto state = std::make_shared<BudgetState>();
+    state->budget = budget;
+    state->start = std::chrono::steady_clock::now();
+    if (installed_control != nullptr) {
+        state->enclosing = installed_control->budget;
+    }
+    return state;
+}
+
+// Helper: Copy the installed control with another budget.
+static OperationControlPtr_t make_budget_control(const BudgetStatePtr_t &state) {
+    auto control = std::make_shared<OperationControl>();
+    if (installed_control != nullptr) {
+        control->token = installed_control->token;
+        control->progress = installed_control->progress;
+    }
+    control->budget = state;
+    return control;
+}
+
+// Helper: Check if a budget has no time left.
+static bool out_of_time(const BudgetState &state) {
+    auto const &limit = state.budget.max_duration;
+    return limit != std::chrono::steady_clock::duration::zero() && std::chrono::steady_clock::now() - state.start > limit;
+}
+
+BudgetScope::BudgetScope(const ResourceBudget &budget) :
+        state(make_budget_state(budget)), scope(make_budget_control(state)) {}
+
+BudgetUsage BudgetScope::usage() const {
+    return state->usage();
+}
+
+void checkpoint() {
+    if (installed_control == nullptr) {
+        return;
+    }
+    if (installed_control->token.is_cancelled()) {
+        throw OperationCancelled("The operation was cancelled.");
+    }
+    for (auto state = installed_control->budget.get(); state != nullptr; state = state->enclosing.get()) {
+        if (out_of_time(*state)) {
+            throw BudgetExceeded("time", "checkpoint", state->usage());
+        }
+    }
+}
+
+bool has_budget() {
+    return installed_control != nullptr && installed_control->budget != nullptr;
+}
+
+void charge_budget(const char *stage, size_t simple_sets, size_t bytes) {
+    if (!has_budget()) {
+        return;
+    }
+    // 1) Charge every enclosing budget, such that inner scopes cannot hide usage from outer ones
+    for (auto state = installed_control->budget.get(); state != nullptr; state = state->enclosing.get()) {
+        auto total_simple_sets = state->simple_sets.fetch_add(simple_sets, std::memory_order_relaxed) + simple_sets;
+        auto total_bytes = state->bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        // 2) Fail fast on the first exceeded limit
+        auto const &budget = state->budget;
+        if (budget.max_simple_sets != 0 && total_simple_sets > budget.max_simple_sets) {
+            throw BudgetExceeded("simple_sets", stage, state->usage());
+        }
+        if (budget.max_bytes != 0 && total_bytes > budget.max_bytes) {
+            throw BudgetExceeded("bytes", stage, state->usage());
+        }
+        if (out_of_time(*state)) {
+            throw BudgetExceeded("time", stage, state->usage());
+        }
+    }
+}
+
+void report_progress(const char *stage, size_t done, size_t total) {
+    if (installed_control == nullptr || !installed_control->progress) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(installed_control->progress_mutex);
+    installed_control->progress(stage, done, total);
+}
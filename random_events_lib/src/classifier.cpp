@@ -0,0 +1,408 @@
+#include "classifier.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+//
+// ===============================
+//  —— EventClassifier::Builder ——
+// ===============================
+//
+
+// The builder keeps the closed hull of every box on every interval variable and grows the tree top down.
+// At every node it tries a handful of thresholds per interval variable and a handful of elements per symbolic
+// variable and takes the split whose larger side is smallest (ties: least duplication).
+struct EventClassifier::Builder {
+    EventClassifier &classifier;
+    size_t leaf_size;
+    size_t max_depth;
+
+    // box-major hulls; entries of symbolic variables are unused
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    struct Split {
+        std::int32_t variable = -1;
+        double threshold = 0;
+        size_t larger_side = std::numeric_limits<size_t>::max();
+        size_t total = std::numeric_limits<size_t>::max();
+
+        bool is_better_than(const Split &other) const {
+            return larger_side < other.larger_side || (larger_side == other.larger_side && total < other.total);
+        }
+    };
+
+    const Constraint *find_constraint(std::uint32_t box, std::uint32_t variable) const {
+        for (auto k = classifier.constraint_offsets[box]; k < classifier.constraint_offsets[box + 1]; ++k) {
+            if (classifier.constraints[k].variable == variable) {
+                return &classifier.constraints[k];
+            }
+        }
+        return nullptr;
+    }
+
+    // Can a point of 'box' satisfy (goes_left) or violate (!goes_left) "variable == element"?
+    bool box_may_take(std::uint32_t box, std::uint32_t variable, int element, bool goes_left) const {
+        auto constraint = find_constraint(box, variable);
+        if (constraint == nullptr) {
+            return true;
+        }
+        auto first = classifier.elements.begin() + constraint->begin;
+        auto last = classifier.elements.begin() + constraint->end;
+        if (goes_left) {
+            return std::binary_search(first, last, element);
+        }
+        return (last - first) > 1 || (last - first == 1 && *first != element);
+    }
+
+    Split best_interval_split(const std::vector<std::uint32_t> &boxes, std::uint32_t variable) const {
+        const size_t v = classifier.variables.size();
+        Split best;
+
+        // Thresholds that separate cleanly: a lower bound (the box goes right only) or just above an upper bound
+        // (the box goes left only).
+        std::vector<double> candidates;
+        candidates.reserve(2 * boxes.size());
+        for (auto box : boxes) {
+            if (std::isfinite(lower[box * v + variable])) {
+                candidates.push_back(lower[box * v + variable]);
+            }
+            if (std::isfinite(upper[box * v + variable])) {
+                candidates.push_back(std::nextafter(upper[box * v + variable],
+                                                    std::numeric_limits<double>::infinity()));
+            }
+        }
+        if (candidates.empty()) {
+            return best;
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        constexpr size_t QUANTILES = 8;
+        for (size_t q = 1; q < QUANTILES; ++q) {
+            const double threshold = candidates[q * (candidates.size() - 1) / QUANTILES];
+            size_t left = 0;
+            size_t right = 0;
+            for (auto box : boxes) {
+                left += lower[box * v + variable] < threshold;
+                right += upper[box * v + variable] >= threshold;
+            }
+            Split split{static_cast<std::int32_t>(variable), threshold, std::max(left, right), left + right};
+            if (left < boxes.size() && right < boxes.size() && split.is_better_than(best)) {
+                best = split;
+            }
+        }
+        return best;
+    }
+
+    Split best_symbolic_split(const std::vector<std::uint32_t> &boxes, std::uint32_t variable) const {
+        Split best;
+
+        // The most frequent elements are the most promising ones
+        std::vector<int> occurrences;
+        for (auto box : boxes) {
+            if (auto constraint = find_constraint(box, variable)) {
+                occurrences.insert(occurrences.end(), classifier.elements.begin() + constraint->begin,
+                                   classifier.elements.begin() + constraint->end);
+            }
+        }
+        std::sort(occurrences.begin(), occurrences.end());
+        std::vector<std::pair<size_t, int>> frequencies;
+        for (size_t k = 0; k < occurrences.size();) {
+            size_t next = k;
+            while (next < occurrences.size() && occurrences[next] == occurrences[k]) {
+                ++next;
+            }
+            frequencies.emplace_back(next - k, occurrences[k]);
+            k = next;
+        }
+        std::sort(frequencies.rbegin(), frequencies.rend());
+
+        constexpr size_t MAX_CANDIDATES = 16;
+        for (size_t k = 0; k < frequencies.size() && k < MAX_CANDIDATES; ++k) {
+            const int element = frequencies[k].second;
+            size_t left = 0;
+            size_t right = 0;
+            for (auto box : boxes) {
+                left += box_may_take(box, variable, element, true);
+                right += box_may_take(box, variable, element, false);
+            }
+            Split split{static_cast<std::int32_t>(variable), static_cast<double>(element), std::max(left, right),
+                        left + right};
+            if (left < boxes.size() && right < boxes.size() && split.is_better_than(best)) {
+                best = split;
+            }
+        }
+        return best;
+    }
+
+    std::uint32_t make_leaf(const std::vector<std::uint32_t> &boxes) {
+        auto node = static_cast<std::uint32_t>(classifier.nodes.size());
+        auto begin = static_cast<std::uint32_t>(classifier.leaf_boxes.size());
+        classifier.leaf_boxes.insert(classifier.leaf_boxes.end(), boxes.begin(), boxes.end());
+        classifier.nodes.push_back({-1, begin, static_cast<std::uint32_t>(classifier.leaf_boxes.size()), 0});
+        return node;
+    }
+
+    std::uint32_t build(const std::vector<std::uint32_t> &boxes, size_t depth) {
+        classifier.tree_depth = std::max(classifier.tree_depth, depth);
+        if (boxes.size() <= leaf_size || depth >= max_depth) {
+            return make_leaf(boxes);
+        }
+
+        // 1) Find the best split over all constrained variables
+        Split best;
+        for (std::uint32_t variable = 0; variable < classifier.variables.size(); ++variable) {
+            if (!classifier.is_constrained[variable]) {
+                continue;
+            }
+            auto split = classifier.is_symbolic[variable] ? best_symbolic_split(boxes, variable)
+                                                          : best_interval_split(boxes, variable);
+            if (split.is_better_than(best)) {
+                best = split;
+            }
+        }
+        if (best.variable < 0) {
+            return make_leaf(boxes);
+        }
+
+        // 2) Distribute the boxes; boxes straddling the split go to both sides.  Lists stay sorted by box id,
+        //    which keeps "lowest event index wins" in the leaves.
+        const size_t v = classifier.variables.size();
+        std::vector<std::uint32_t> left_boxes;
+        std::vector<std::uint32_t> right_boxes;
+        for (auto box : boxes) {
+            bool goes_left;
+            bool goes_right;
+            if (classifier.is_symbolic[best.variable]) {
+                goes_left = box_may_take(box, best.variable, static_cast<int>(best.threshold), true);
+                goes_right = box_may_take(box, best.variable, static_cast<int>(best.threshold), false);
+            } else {
+                goes_left = lower[box * v + best.variable] < best.threshold;
+                goes_right = upper[box * v + best.variable] >= best.threshold;
+            }
+            if (goes_left) {
+                left_boxes.push_back(box);
+            }
+            if (goes_right) {
+                right_boxes.push_back(box);
+            }
+        }
+
+        // 3) Reserve the node, then build the children ('nodes' may reallocate)
+        auto node = static_cast<std::uint32_t>(classifier.nodes.size());
+        classifier.nodes.push_back({best.variable, 0, 0, best.threshold});
+        auto left = build(left_boxes, depth + 1);
+        auto right = build(right_boxes, depth + 1);
+        classifier.nodes[node].first = left;
+        classifier.nodes[node].second = right;
+        return node;
+    }
+};
+
+//
+// ===============================
+//  —— EventClassifier ——
+// ===============================
+//
+
+EventClassifier::EventClassifier(const std::vector<EventPtr_t> &events, size_t leaf_size, size_t max_depth) {
+    // 1) Variables of all events, name ordered
+    VariableSet all_variables;
+    for (auto const &event : events) {
+        auto event_variables = event->get_variables_from_simple_events();
+        all_variables.insert(event_variables.begin(), event_variables.end());
+    }
+    variables.assign(all_variables.begin(), all_variables.end());
+    for (auto const &variable : variables) {
+        is_symbolic.push_back(dynamic_cast<Symbolic *>(variable.get()) != nullptr);
+    }
+    is_constrained.assign(variables.size(), false);
+
+    Builder builder{*this, std::max<size_t>(leaf_size, 1), max_depth, {}, {}};
+
+    // 2) Flatten every non-empty simple event into constraints and hulls
+    constraint_offsets.push_back(0);
+    for (size_t label = 0; label < events.size(); ++label) {
+        for (auto const &simple_set : *events[label]->simple_sets) {
+            if (simple_set->is_empty()) {
+                continue;
+            }
+            auto const &variable_map = static_cast<SimpleEvent *>(simple_set.get())->variable_map;
+
+            builder.lower.insert(builder.lower.end(), variables.size(), -std::numeric_limits<double>::infinity());
+            builder.upper.insert(builder.upper.end(), variables.size(), std::numeric_limits<double>::infinity());
+            double *box_lower = builder.lower.data() + labels.size() * variables.size();
+            double *box_upper = builder.upper.data() + labels.size() * variables.size();
+
+            // both the variable map and 'variables' are name ordered
+            std::uint32_t position = 0;
+            for (auto const &[variable, assignment] : *variable_map) {
+                while (*variables[position] < *variable) {
+                    ++position;
+                }
+
+                Constraint constraint{position, 0, 0};
+                if (is_symbolic[position]) {
+                    auto set = static_cast<Set *>(assignment.get());
+                    if (set->simple_sets->size() == set->all_elements->size()) {
+                        continue;  // full domain
+                    }
+                    constraint.begin = static_cast<std::uint32_t>(elements.size());
+                    for (auto const &element : *set->simple_sets) {
+                        elements.push_back(static_cast<SetElement *>(element.get())->element_index);
+                    }
+                    constraint.end = static_cast<std::uint32_t>(elements.size());
+                } else {
+                    constraint.begin = static_cast<std::uint32_t>(bounds.size());
+                    double hull_lower = std::numeric_limits<double>::infinity();
+                    double hull_upper = -std::numeric_limits<double>::infinity();
+                    for (auto const &simple_set_ : *assignment->simple_sets) {
+                        auto simple_interval = static_cast<SimpleInterval *>(simple_set_.get());
+                        bounds.push_back({simple_interval->lower, simple_interval->upper,
+                                          simple_interval->left == BorderType::CLOSED,
+                                          simple_interval->right == BorderType::CLOSED});
+                        hull_lower = std::min(hull_lower, simple_interval->lower);
+                        hull_upper = std::max(hull_upper, simple_interval->upper);
+                    }
+                    constraint.end = static_cast<std::uint32_t>(bounds.size());
+                    if (hull_lower == -std::numeric_limits<double>::infinity() &&
+                        hull_upper == std::numeric_limits<double>::infinity() && constraint.end - constraint.begin == 1) {
+                        bounds.pop_back();
+                        continue;  // the real line
+                    }
+                    box_lower[position] = hull_lower;
+                    box_upper[position] = hull_upper;
+                }
+                is_constrained[position] = true;
+                constraints.push_back(constraint);
+            }
+
+            labels.push_back(static_cast<std::int64_t>(label));
+            constraint_offsets.push_back(static_cast<std::uint32_t>(constraints.size()));
+        }
+    }
+
+    // 3) Grow the tree
+    std::vector<std::uint32_t> boxes(labels.size());
+    for (std::uint32_t box = 0; box < boxes.size(); ++box) {
+        boxes[box] = box;
+    }
+    builder.build(boxes, 0);
+}
+
+const std::vector<AbstractVariablePtr_t> &EventClassifier::get_variables() const {
+    return variables;
+}
+
+size_t EventClassifier::node_count() const {
+    return nodes.size();
+}
+
+size_t EventClassifier::depth() const {
+    return tree_depth;
+}
+
+bool EventClassifier::box_contains(std::uint32_t box, const double *point) const {
+    for (auto k = constraint_offsets[box]; k < constraint_offsets[box + 1]; ++k) {
+        const auto &constraint = constraints[k];
+        const double x = point[constraint.variable];
+        bool inside = false;
+        if (is_symbolic[constraint.variable]) {
+            inside = std::binary_search(elements.begin() + constraint.begin, elements.begin() + constraint.end,
+                                        static_cast<int>(x));
+        } else {
+            for (auto b = constraint.begin; b < constraint.end && !inside; ++b) {
+                const auto &bound = bounds[b];
+                inside = ((x > bound.lower) | ((x == bound.lower) & bound.lower_closed)) &
+                         ((x < bound.upper) | ((x == bound.upper) & bound.upper_closed));
+            }
+        }
+        if (!inside) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::int64_t EventClassifier::classify_point(const double *point) const {
+    std::uint32_t node = 0;
+    while (nodes[node].variable >= 0) {
+        const auto &current = nodes[node];
+        const double x = point[current.variable];
+        const bool test = is_symbolic[current.variable] ? x == current.threshold : x < current.threshold;
+        node = test ? current.first : current.second;
+    }
+    for (auto k = nodes[node].first; k < nodes[node].second; ++k) {
+        if (box_contains(leaf_boxes[k], point)) {
+            return labels[leaf_boxes[k]];
+        }
+    }
+    return -1;
+}
+
+std::int64_t EventClassifier::classify(const std::vector<double> &point) const {
+    if (point.size() != variables.size()) {
+        throw std::invalid_argument("the point must assign a value to every variable of the classifier");
+    }
+    return classify_point(point.data());
+}
+
+std::vector<std::int64_t> EventClassifier::classify(const ColumnMap &columns, size_t rows, size_t threads) const {
+    // 1) Resolve the columns once
+    std::vector<const double *> double_columns(variables.size(), nullptr);
+    std::vector<const std::int64_t *> integer_columns(variables.size(), nullptr);
+    for (size_t variable = 0; variable < variables.size(); ++variable) {
+        auto column = columns.find(variables[variable]);
+        if (column == columns.end()) {
+            if (is_constrained[variable]) {
+                throw std::invalid_argument("missing column for variable " + *variables[variable]->name);
+            }
+            continue;
+        }
+        if (auto values = std::get_if<const double *>(&column->second)) {
+            double_columns[variable] = *values;
+        } else {
+            integer_columns[variable] = std::get<const std::int64_t *>(column->second);
+        }
+    }
+
+    // 2) Classify chunks of rows in parallel; every thread owns a disjoint range of the result
+    std::vector<std::int64_t> result(rows, -1);
+    auto classify_range = [&](size_t begin, size_t end) {
+        std::vector<double> point(variables.size(), 0);
+        for (size_t row = begin; row < end; ++row) {
+            for (size_t variable = 0; variable < variables.size(); ++variable) {
+                if (double_columns[variable] != nullptr) {
+                    point[variable] = double_columns[variable][row];
+                } else if (integer_columns[variable] != nullptr) {
+                    point[variable] = static_cast<double>(integer_columns[variable][row]);
+                }
+            }
+            result[row] = classify_point(point.data());
+        }
+    };
+
+    constexpr size_t MIN_ROWS_PER_THREAD = 4096;
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    threads = std::min(threads, rows / MIN_ROWS_PER_THREAD + 1);
+    if (threads <= 1) {
+        classify_range(0, rows);
+        return result;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    const size_t chunk = (rows + threads - 1) / threads;
+    for (size_t begin = 0; begin < rows; begin += chunk) {
+        workers.emplace_back(classify_range, begin, std::min(rows, begin + chunk));
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    return result;
+}
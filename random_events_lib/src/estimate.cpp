@@ -0,0 +1,289 @@
+#include "estimate.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "set.h"
+#include "variable.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+//
+// ===============================
+//  —— Statistics ——
+// ===============================
+//
+
+// Helper: Add the simple sets of one assignment (or of a whole interval or set) to the statistics of a variable.
+static void add_assignment(SetStatistics &statistics, const std::string &name,
+                           const AbstractCompositeSet &assignment) {
+    statistics.fragmentation[name] += assignment.simple_sets->size();
+    if (!assignment.simple_sets->empty() && statistics.universe_sizes.count(name) == 0) {
+        if (auto element = dynamic_cast<const SetElement *>(assignment.simple_sets->begin()->get())) {
+            statistics.universe_sizes[name] = element->all_elements->size();
+        }
+    }
+}
+
+SetStatistics collect_statistics(const AbstractCompositeSet &set) {
+    SetStatistics statistics;
+    statistics.pieces = set.simple_sets->size();
+    statistics.disjoint = set.is_known_disjoint();
+
+    if (dynamic_cast<const Event *>(&set) == nullptr) {
+        statistics.kind = dynamic_cast<const Set *>(&set) != nullptr ? SetKind::SET : SetKind::INTERVAL;
+        add_assignment(statistics, "", set);
+        return statistics;
+    }
+
+    statistics.kind = SetKind::PRODUCT;
+    size_t simple_sets = 0;
+    for (auto const &simple_set : *set.simple_sets) {
+        for (auto const &[variable, assignment] : *static_cast<const SimpleEvent *>(simple_set.get())->variable_map) {
+            add_assignment(statistics, *variable->name, *assignment);
+            simple_sets += assignment->simple_sets->size();
+        }
+    }
+    if (statistics.pieces > 0) {
+        statistics.piece_cost = std::max(1., static_cast<double>(simple_sets) / statistics.pieces);
+    }
+    return statistics;
+}
+
+//
+// ===============================
+//  —— Overlap ——
+// ===============================
+//
+
+double estimate_overlap(const AbstractCompositeSet &lhs, const AbstractCompositeSet &rhs, size_t samples) {
+    auto const &left = *lhs.simple_sets;
+    auto const &right = *rhs.simple_sets;
+    bool self = &lhs == &rhs;
+    size_t n = left.size();
+    size_t m = right.size();
+    double pairs = self ? n * (n - 1.) / 2. : static_cast<double>(n) * m;
+    if (pairs <= 0 || samples == 0 || (!self && !lhs.may_overlap(rhs))) {
+        return 0;
+    }
+
+    // 1) Test every pair if there are few, otherwise a deterministic spread of them
+    size_t tested = 0;
+    size_t intersecting = 0;
+    auto test = [&](size_t i, size_t j) {
+        ++tested;
+        if (rhs.may_overlap(left[i]) && left[i]->intersects(right[j])) {
+            ++intersecting;
+        }
+    };
+    if (pairs <= samples) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = self ? i + 1 : 0; j < m; ++j) {
+                test(i, j);
+            }
+        }
+    } else {
+        // 2) Walk the rows evenly and pick the column by a multiplicative hash, which avoids aligned patterns
+        for (size_t t = 0; t < samples; ++t) {
+            size_t i = t * n / samples;
+            size_t j = static_cast<size_t>((t * 2654435761ULL + 40503ULL) % m);
+            if (self && i == j) {
+                j = (j + 1) % m;
+            }
+            test(i, j);
+        }
+    }
+    return static_cast<double>(intersecting) / tested;
+}
+
+//
+// ===============================
+//  —— Cost model ——
+// ===============================
+//
+
+// Helper: The parameters of the cost model of a pair of operands.
+struct CostModel {
+    SetKind kind = SetKind::INTERVAL;
+
+    // number of simple sets a simple set of lhs is cut into by one simple set of rhs at most
+    double split = 2;
+
+    // number of simple sets a cut adds on average
+    double growth = 0.5;
+
+    // number of disjoint cells the endpoints of the operands cut the space into
+    double cells = std::numeric_limits<double>::infinity();
+
+    // cost of one operation on a pair of simple sets
+    double pair_cost = 1;
+};
+
+// Helper: Count the cells of the space cut by the endpoints of one or two operands.
+static double count_cells(const SetStatistics &lhs, const SetStatistics *rhs) {
+    std::set<std::string> variables;
+    for (auto const *statistics : {&lhs, rhs}) {
+        if (statistics != nullptr) {
+            for (auto const &[name, simple_sets] : statistics->fragmentation) {
+                variables.insert(name);
+            }
+        }
+    }
+
+    double cells = 1;
+    for (auto const &name : variables) {
+        double simple_sets = 0;
+        double universe = std::numeric_limits<double>::infinity();
+        for (auto const *statistics : {&lhs, rhs}) {
+            if (statistics == nullptr) {
+                continue;
+            }
+            auto fragmentation = statistics->fragmentation.find(name);
+            if (fragmentation != statistics->fragmentation.end()) {
+                simple_sets += fragmentation->second;
+            }
+            auto universe_size = statistics->universe_sizes.find(name);
+            if (universe_size != statistics->universe_sizes.end()) {
+                universe = static_cast<double>(universe_size->second);
+            }
+        }
+        // k intervals have at most 2k distinct endpoints, which cut a line into 2k points and 2k + 1 open intervals
+        cells *= std::min(universe, 4 * simple_sets + 1);
+    }
+    return cells;
+}
+
+// Helper: Build the cost model of one or two operands.
+static CostModel make_model(const SetStatistics &lhs, const SetStatistics *rhs) {
+    CostModel model;
+    model.kind = lhs.kind;
+    if (lhs.kind == SetKind::SET) {
+        model.split = 1;
+    } else if (lhs.kind == SetKind::PRODUCT) {
+        // a box minus a box is at most one piece per variable
+        std::set<std::string> variables;
+        for (auto const *statistics : {&lhs, rhs}) {
+            if (statistics != nullptr) {
+                for (auto const &[name, simple_sets] : statistics->fragmentation) {
+                    variables.insert(name);
+                }
+            }
+        }
+        model.split = std::max<double>(variables.size(), 1);
+    }
+    model.growth = (model.split - 1) / 2;
+    model.cells = count_cells(lhs, rhs);
+    model.pair_cost = lhs.piece_cost + (rhs != nullptr ? rhs->piece_cost : lhs.piece_cost);
+    return model;
+}
+
+// Helper: Bound the pieces of 'pieces' simple sets cut by 'cuts' simple sets each.
+static double cut_bound(const CostModel &model, double pieces, double cuts) {
+    if (model.split <= 1) {
+        return pieces;
+    }
+    return pieces * std::pow(model.split, cuts);
+}
+
+// Helper: Estimate lhs \ rhs from the statistics of both operands and their overlap rate.
+static CostEstimate estimate_difference(const CostModel &model, double n, double m, double overlap) {
+    CostEstimate estimate;
+    double cuts = m * overlap;
+    estimate.max_pieces = std::min(cut_bound(model, n, m), model.cells);
+    estimate.expected_pieces = std::min(n * (1 + cuts * model.growth), estimate.max_pieces);
+    estimate.work = n * m * model.pair_cost * (1 + cuts * model.growth);
+    return estimate;
+}
+
+CostEstimate estimate_cost(SetOperation operation, const AbstractCompositeSetPtr_t &lhs,
+                           const AbstractCompositeSetPtr_t &rhs) {
+    bool binary = operation == SetOperation::INTERSECTION || operation == SetOperation::UNION ||
+                  operation == SetOperation::DIFFERENCE;
+    if (lhs == nullptr || (binary && rhs == nullptr)) {
+        throw std::invalid_argument("The operation misses an operand.");
+    }
+
+    // 1) Collect the statistics of the operands
+    auto left = collect_statistics(*lhs);
+    SetStatistics right;
+    if (binary) {
+        right = collect_statistics(*rhs);
+    }
+    auto model = make_model(left, binary ? &right : nullptr);
+    double n = left.pieces;
+    double m = right.pieces;
+
+    // 2) Apply the model of the operation
+    CostEstimate estimate;
+    switch (operation) {
+        case SetOperation::INTERSECTION: {
+            double overlap = estimate_overlap(*lhs, *rhs);
+            estimate.max_pieces = std::min(n * m, model.cells);
+            if (model.kind == SetKind::SET) {
+                estimate.max_pieces = std::min(n, m);
+            }
+            estimate.expected_pieces = std::min(n * m * overlap, estimate.max_pieces);
+            estimate.work = n * m * model.pair_cost;
+            break;
+        }
+        case SetOperation::DIFFERENCE:
+            estimate = estimate_difference(model, n, m, estimate_overlap(*lhs, *rhs));
+            if (!left.disjoint) {
+                // the result is made disjoint, which may also cut the simple sets of lhs by each other
+                estimate.max_pieces = model.cells;
+            }
+            break;
+        case SetOperation::UNION: {
+            // lhs ∪ rhs = lhs + (rhs \ lhs), then made disjoint
+            auto remainder = estimate_difference(model, m, n, estimate_overlap(*rhs, *lhs));
+            estimate.max_pieces = left.disjoint ? std::min(n + remainder.max_pieces, model.cells) : model.cells;
+            estimate.expected_pieces = std::min(n + remainder.expected_pieces, estimate.max_pieces);
+            estimate.work = remainder.work + n * m * model.pair_cost;
+            break;
+        }
+        case SetOperation::COMPLEMENT:
+            if (model.kind == SetKind::SET) {
+                auto universe = left.universe_sizes.find("");
+                estimate.max_pieces = universe != left.universe_sizes.end() ? universe->second - n : 0;
+                estimate.expected_pieces = estimate.max_pieces;
+                estimate.work = n * (estimate.max_pieces + 1);
+            } else if (model.kind == SetKind::INTERVAL && left.disjoint) {
+                // the gaps between disjoint intervals
+                estimate.max_pieces = n > 0 ? n + 1 : 0;
+                estimate.expected_pieces = estimate.max_pieces;
+                estimate.work = n * n;
+            } else {
+                // the universe cut by every simple set of lhs
+                estimate = estimate_difference(model, 1, n, 1);
+                estimate.work = n * estimate.expected_pieces * model.pair_cost;
+            }
+            if (n == 0) {
+                // the complement of the empty set is returned as empty set
+                estimate = CostEstimate();
+            }
+            break;
+        case SetOperation::MAKE_DISJOINT:
+            estimate.max_pieces = n;
+            estimate.expected_pieces = n;
+            estimate.work = n;
+            if (!left.disjoint && n > 1) {
+                // every simple set is carved by the earlier ones it overlaps
+                double overlap = estimate_overlap(*lhs, *lhs);
+                double bound = model.split <= 1 ? n : (std::pow(model.split, n) - 1) / (model.split - 1);
+                estimate.max_pieces = std::min(bound, model.cells);
+                estimate.expected_pieces = std::min(n + model.growth * overlap * n * (n - 1) / 2,
+                                                    estimate.max_pieces);
+                estimate.work = n * n * model.pair_cost * (1 + overlap);
+            }
+            break;
+        case SetOperation::SIMPLIFY:
+            // merging never adds simple sets; every round compares all pairs
+            estimate.max_pieces = n;
+            estimate.expected_pieces = n;
+            estimate.work = n * n * model.pair_cost;
+            break;
+    }
+    return estimate;
+}
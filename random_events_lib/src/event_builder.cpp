@@ -0,0 +1,75 @@
+#include "event_builder.h"
+#include "generator.h"
+#include <utility>
+
+void EventBuilder::add(const SimpleEventPtr_t &simple_event) {
+    if (simple_event->is_empty()) {
+        return;
+    }
+
+    // 1) Collect the pieces that may overlap the new simple event, from the buffer and from every level
+    std::vector<AbstractSimpleSetPtr_t> overlapping;
+    for (auto const &piece : buffer) {
+        if (piece->intersects(simple_event)) {
+            overlapping.push_back(piece);
+        }
+    }
+    for (auto const &level : levels) {
+        if (level.index != nullptr) {
+            auto candidates = level.index->overlapping(simple_event);
+            overlapping.insert(overlapping.end(), candidates.begin(), candidates.end());
+        }
+    }
+
+    // 2) Only the parts outside of these pieces are new
+    auto single = make_shared_simple_set_set();
+    single->insert(simple_event);
+    auto parts = generate_carving(generate_pieces(single), std::move(overlapping));
+    for (auto const &part : *parts) {
+        buffer.push_back(part);
+        ++pieces;
+    }
+
+    if (buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void EventBuilder::add(const EventPtr_t &event) {
+    for (auto const &simple_event : *event->simple_sets) {
+        add(std::static_pointer_cast<SimpleEvent>(simple_event));
+    }
+}
+
+size_t EventBuilder::size() const {
+    return pieces;
+}
+
+void EventBuilder::flush() {
+    // Carry the buffer up like in a binary counter: merge with every occupied level until a free one is found
+    std::vector<AbstractSimpleSetPtr_t> carry = std::move(buffer);
+    buffer.clear();
+    for (auto &level : levels) {
+        if (level.pieces == nullptr) {
+            level.pieces = make_shared_simple_set_set(carry.begin(), carry.end());
+            level.index = make_shared_spatial_index(level.pieces);
+            return;
+        }
+        carry.insert(carry.end(), level.pieces->begin(), level.pieces->end());
+        level = Level();
+    }
+    auto simple_sets = make_shared_simple_set_set(carry.begin(), carry.end());
+    levels.push_back({simple_sets, make_shared_spatial_index(simple_sets)});
+}
+
+EventPtr_t EventBuilder::build() const {
+    std::vector<AbstractSimpleSetPtr_t> all(buffer.begin(), buffer.end());
+    for (auto const &level : levels) {
+        if (level.pieces != nullptr) {
+            all.insert(all.end(), level.pieces->begin(), level.pieces->end());
+        }
+    }
+    auto result = make_shared_event(make_shared_simple_set_set(all.begin(), all.end()));
+    result->mark_disjoint();
+    return result;
+}
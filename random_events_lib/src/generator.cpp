@@ -0,0 +1,194 @@
+#include "generator.h"
+#include "cancellation.h"
+#include <utility>
+#include <vector>
+
+//
+// ===============================
+//  —— PieceGenerator ——
+// ===============================
+//
+
+PieceGenerator::iterator::iterator(PieceGenerator *generator_) : generator(generator_) {
+    ++*this;
+}
+
+PieceGenerator::iterator &PieceGenerator::iterator::operator++() {
+    piece = generator->next();
+    if (piece == nullptr) {
+        generator = nullptr;
+    }
+    return *this;
+}
+
+PieceGenerator::iterator PieceGenerator::begin() {
+    return iterator(this);
+}
+
+PieceGenerator::iterator PieceGenerator::end() {
+    return {};
+}
+
+size_t PieceGenerator::count() {
+    size_t result = 0;
+    while (next() != nullptr) {
+        ++result;
+    }
+    return result;
+}
+
+AbstractCompositeSetPtr_t PieceGenerator::collect(const AbstractCompositeSetPtr_t &empty) {
+    std::vector<AbstractSimpleSetPtr_t> pieces;
+    for (auto piece = next(); piece != nullptr; piece = next()) {
+        pieces.push_back(std::move(piece));
+    }
+    empty->simple_sets->insert(pieces.begin(), pieces.end());
+    empty->mark_disjoint();
+    return empty;
+}
+
+//
+// ===============================
+//  —— Generators ——
+// ===============================
+//
+
+// Helper: Produce the non-empty simple sets of a materialized set of simple sets.
+class SimpleSetSetGenerator : public PieceGenerator {
+public:
+    explicit SimpleSetSetGenerator(SimpleSetSetPtr_t simple_sets_) : simple_sets(std::move(simple_sets_)) {}
+
+    AbstractSimpleSetPtr_t next() override {
+        while (position < simple_sets->size()) {
+            auto const &piece = (*simple_sets)[position++];
+            if (!piece->is_empty()) {
+                return piece;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    SimpleSetSetPtr_t simple_sets;
+    size_t position = 0;
+};
+
+// Helper: Produce the parts of the simple sets of a source that lie outside of every subtrahend.
+//   Every simple set is cut by the subtrahends in order, depth first: a part is only cut by the next subtrahend that
+//   intersects it, and the parts of one cut are disjoint, hence all produced parts are disjoint. At most one path of
+//   cuts is pending, at most (number of subtrahends) * (parts per cut) simple sets.
+class CarvingGenerator : public PieceGenerator {
+public:
+    CarvingGenerator(PieceGeneratorPtr_t source_, std::vector<AbstractSimpleSetPtr_t> subtrahends_) :
+            source(std::move(source_)), subtrahends(std::move(subtrahends_)) {}
+
+    AbstractSimpleSetPtr_t next() override {
+        while (true) {
+            // 1) Take the next pending part or the next simple set of the source
+            if (pending.empty()) {
+                auto piece = source->next();
+                if (piece == nullptr) {
+                    return nullptr;
+                }
+                pending.emplace_back(std::move(piece), 0);
+            }
+            auto [piece, cut] = std::move(pending.back());
+            pending.pop_back();
+
+            // 2) Skip the subtrahends that do not touch it; a part that survives all of them is a result
+            while (cut < subtrahends.size() && !piece->intersects(subtrahends[cut])) {
+                ++cut;
+            }
+            if (cut == subtrahends.size()) {
+                return piece;
+            }
+
+            // 3) Cut it and continue with its parts, first part first.  Cancellation is checked between cuts.
+            checkpoint();
+            auto parts = piece->difference_with(subtrahends[cut]);
+            for (auto part = parts->end(); part != parts->begin();) {
+                --part;
+                if (!(*part)->is_empty()) {
+                    pending.emplace_back(*part, cut + 1);
+                }
+            }
+        }
+    }
+
+private:
+    PieceGeneratorPtr_t source;
+    std::vector<AbstractSimpleSetPtr_t> subtrahends;
+    std::vector<std::pair<AbstractSimpleSetPtr_t, size_t>> pending;
+};
+
+// Helper: Produce lhs \ rhs by carving every simple set of lhs on its own.
+class DifferenceGenerator : public PieceGenerator {
+public:
+    DifferenceGenerator(AbstractCompositeSetPtr_t lhs_, AbstractCompositeSetPtr_t rhs_) :
+            lhs(std::move(lhs_)), rhs(std::move(rhs_)), lhs_disjoint(lhs->is_known_disjoint()) {}
+
+    AbstractSimpleSetPtr_t next() override {
+        while (true) {
+            if (current != nullptr) {
+                if (auto piece = current->next()) {
+                    return piece;
+                }
+                current = nullptr;
+            }
+            if (position == lhs->simple_sets->size()) {
+                return nullptr;
+            }
+
+            // 1) The subtrahends of the next simple set: the earlier simple sets of lhs unless lhs is disjoint, and
+            //    the simple sets of rhs that may overlap it
+            auto const &A = (*lhs->simple_sets)[position];
+            std::vector<AbstractSimpleSetPtr_t> subtrahends;
+            if (!lhs_disjoint) {
+                for (size_t k = 0; k < position; ++k) {
+                    subtrahends.push_back((*lhs->simple_sets)[k]);
+                }
+            }
+            if (rhs->may_overlap(A)) {
+                rhs->for_each_overlap_candidate(A, [&subtrahends](const AbstractSimpleSetPtr_t &B) {
+                    subtrahends.push_back(B);
+                });
+            }
+            ++position;
+
+            auto single = make_shared_simple_set_set();
+            single->insert(A);
+            current = std::make_shared<CarvingGenerator>(generate_pieces(single), std::move(subtrahends));
+        }
+    }
+
+private:
+    AbstractCompositeSetPtr_t lhs;
+    AbstractCompositeSetPtr_t rhs;
+    bool lhs_disjoint;
+    size_t position = 0;
+    PieceGeneratorPtr_t current;
+};
+
+PieceGeneratorPtr_t generate_pieces(const SimpleSetSetPtr_t &simple_sets) {
+    return std::make_shared<SimpleSetSetGenerator>(simple_sets);
+}
+
+PieceGeneratorPtr_t generate_carving(const PieceGeneratorPtr_t &source,
+                                     std::vector<AbstractSimpleSetPtr_t> subtrahends) {
+    return std::make_shared<CarvingGenerator>(source, std::move(subtrahends));
+}
+
+PieceGeneratorPtr_t generate_complement(const AbstractCompositeSetPtr_t &set) {
+    if (set->simple_sets->empty()) {
+        return generate_pieces(make_shared_simple_set_set());
+    }
+
+    // (∪ A_i)^c is A_1^c cut by A_2, ..., A_n
+    auto const &simple_sets = *set->simple_sets;
+    std::vector<AbstractSimpleSetPtr_t> subtrahends(simple_sets.begin() + 1, simple_sets.end());
+    return std::make_shared<CarvingGenerator>(simple_sets[0]->complement_pieces(), std::move(subtrahends));
+}
+
+PieceGeneratorPtr_t generate_difference(const AbstractCompositeSetPtr_t &lhs, const AbstractCompositeSetPtr_t &rhs) {
+    return std::make_shared<DifferenceGenerator>(lhs, rhs);
+}
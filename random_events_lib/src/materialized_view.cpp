@@ -0,0 +1,372 @@
+#include "materialized_view.h"
+#include "cancellation.h"
+#include "generator.h"
+#include <algorithm>
+#include <stdexcept>
+
+//
+// ===============================
+//  —— PieceIndex ——
+// ===============================
+//
+
+MaterializedView::PieceIndex::PieceIndex(bool indexed_) : indexed(indexed_) {}
+
+void MaterializedView::PieceIndex::insert(size_t id, const AbstractSimpleSetPtr_t &simple_set) {
+    live[id] = simple_set;
+    buffer.emplace_back(id, simple_set);
+    ++stored;
+    if (indexed && buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void MaterializedView::PieceIndex::erase(size_t id) {
+    // the entry stays in the buffer or its level until the erased entries make up half of all entries
+    if (live.erase(id) > 0 && stored > 2 * live.size()) {
+        rebuild();
+    }
+}
+
+std::vector<size_t> MaterializedView::PieceIndex::candidates(const AbstractSimpleSetPtr_t &simple_set) const {
+    std::vector<size_t> result;
+    for (auto const &[id, entry] : buffer) {
+        if (live.count(id) > 0) {
+            result.push_back(id);
+        }
+    }
+    for (auto const &level : levels) {
+        if (level.index == nullptr) {
+            continue;
+        }
+        for (auto const &candidate : level.index->overlapping(simple_set)) {
+            for (auto id : level.ids.at(candidate.get())) {
+                if (live.count(id) > 0) {
+                    result.push_back(id);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+MaterializedView::PieceIndex::Level MaterializedView::PieceIndex::make_level(
+        const std::vector<std::pair<size_t, AbstractSimpleSetPtr_t>> &entries) {
+    Level level;
+    level.simple_sets = make_shared_simple_set_set();
+    std::vector<AbstractSimpleSetPtr_t> simple_sets;
+    for (auto const &[id, simple_set] : entries) {
+        if (live.count(id) > 0) {
+            simple_sets.push_back(simple_set);
+        }
+    }
+    level.simple_sets->insert(simple_sets.begin(), simple_sets.end());
+
+    // equivalent simple sets are kept once, hence their ids are collected under the kept one
+    for (auto const &[id, simple_set] : entries) {
+        if (live.count(id) > 0) {
+            level.ids[level.simple_sets->find(simple_set)->get()].push_back(id);
+            ++stored;
+        }
+    }
+    level.index = make_shared_spatial_index(level.simple_sets);
+    return level;
+}
+
+void MaterializedView::PieceIndex::flush() {
+    // Carry the buffer up like in a binary counter: merge with every occupied level until a free one is found.
+    // Erased entries are dropped on the way.
+    auto carry = std::move(buffer);
+    buffer.clear();
+    for (auto &level : levels) {
+        if (level.index == nullptr) {
+            stored -= carry.size();
+            level = make_level(carry);
+            return;
+        }
+        for (auto const &[kept, ids] : level.ids) {
+            for (auto id : ids) {
+                auto entry = live.find(id);
+                carry.emplace_back(id, entry != live.end() ? entry->second : nullptr);
+            }
+        }
+        level = Level();
+    }
+    stored -= carry.size();
+    levels.push_back(make_level(carry));
+}
+
+void MaterializedView::PieceIndex::rebuild() {
+    std::vector<std::pair<size_t, AbstractSimpleSetPtr_t>> entries(live.begin(), live.end());
+    std::sort(entries.begin(), entries.end(),
+              [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    buffer.clear();
+    levels.clear();
+    stored = 0;
+    if (!indexed || entries.size() < BUFFER_SIZE) {
+        stored = entries.size();
+        buffer = std::move(entries);
+        return;
+    }
+
+    // all entries go to the lowest level that is large enough for them
+    size_t height = 0;
+    while ((BUFFER_SIZE << height) < entries.size()) {
+        ++height;
+    }
+    levels.resize(height + 1);
+    levels[height] = make_level(entries);
+}
+
+//
+// ===============================
+//  —— Construction ——
+// ===============================
+//
+
+MaterializedView::MaterializedView(SetOperation operation_, const AbstractCompositeSetPtr_t &lhs,
+                                   const AbstractCompositeSetPtr_t &rhs) : operation(operation_) {
+    if (operation != SetOperation::INTERSECTION && operation != SetOperation::UNION &&
+        operation != SetOperation::DIFFERENCE && operation != SetOperation::COMPLEMENT) {
+        throw std::invalid_argument("A materialized view supports intersection, union, difference and complement.");
+    }
+    if (lhs == nullptr || (operation != SetOperation::COMPLEMENT && rhs == nullptr)) {
+        throw std::invalid_argument("The operation misses an operand.");
+    }
+
+    empty = lhs->make_new_empty();
+    bool indexed = std::dynamic_pointer_cast<Event>(empty) != nullptr;
+    piece_index[0] = PieceIndex(indexed);
+    piece_index[1] = PieceIndex(indexed);
+    source_index = PieceIndex(indexed);
+    for (auto const &simple_set : *lhs->simple_sets) {
+        insert(ViewInput::LHS, simple_set);
+    }
+    if (operation != SetOperation::COMPLEMENT) {
+        for (auto const &simple_set : *rhs->simple_sets) {
+            insert(ViewInput::RHS, simple_set);
+        }
+    }
+}
+
+int MaterializedView::minuend() const {
+    switch (operation) {
+        case SetOperation::DIFFERENCE:
+            return 0;
+        case SetOperation::UNION:
+            // lhs ∪ rhs = lhs + (rhs \ lhs)
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+int MaterializedView::subtrahend() const {
+    switch (operation) {
+        case SetOperation::DIFFERENCE:
+            return 1;
+        case SetOperation::UNION:
+        case SetOperation::COMPLEMENT:
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+void MaterializedView::carve(Carving &carving) const {
+    carving.cuts.clear();
+    std::vector<AbstractSimpleSetPtr_t> subtrahends;
+    for (auto id : piece_index[subtrahend()].candidates(carving.source)) {
+        auto const &piece = pieces[subtrahend()].at(id);
+        if (carving.source->intersects(piece)) {
+            carving.cuts.insert(id);
+            subtrahends.push_back(piece);
+        }
+    }
+
+    auto single = make_shared_simple_set_set();
+    single->insert(carving.source);
+    auto parts = generate_carving(generate_pieces(single), std::move(subtrahends));
+    carving.parts.assign(parts->begin(), parts->end());
+}
+
+//
+// ===============================
+//  —— Changes ——
+// ===============================
+//
+
+size_t MaterializedView::insert(ViewInput input, const AbstractSimpleSetPtr_t &piece) {
+    int side = static_cast<int>(input);
+    if (operation == SetOperation::COMPLEMENT && input == ViewInput::RHS) {
+        throw std::invalid_argument("The complement has no right operand.");
+    }
+
+    // 1) Store the piece and count the pieces of the same operand it overlaps
+    for (auto other_id : piece_index[side].candidates(piece)) {
+        if (pieces[side].at(other_id)->intersects(piece)) {
+            ++overlaps[side];
+        }
+    }
+    size_t id = next_id[side]++;
+    pieces[side][id] = piece;
+    piece_index[side].insert(id, piece);
+
+    // 2) Derive the new result pieces
+    if (operation == SetOperation::INTERSECTION) {
+        for (auto other_id : piece_index[1 - side].candidates(piece)) {
+            auto const &other = pieces[1 - side].at(other_id);
+            if (!piece->intersects(other)) {
+                continue;
+            }
+            auto intersection = piece->intersection_with(other);
+            if (!intersection->is_empty()) {
+                intersections[side == 0 ? std::make_pair(id, other_id) : std::make_pair(other_id, id)] = intersection;
+            }
+        }
+    } else if (side == minuend()) {
+        Carving carving{piece, {}, {}};
+        carve(carving);
+        carvings[id] = std::move(carving);
+        source_index.insert(id, piece);
+    } else if (operation == SetOperation::COMPLEMENT && !has_universe) {
+        // 3) The first piece of a complement fixes the universe: the piece and its complement
+        has_universe = true;
+        std::vector<AbstractSimpleSetPtr_t> universe{piece};
+        auto complement = piece->complement();
+        universe.insert(universe.end(), complement->begin(), complement->end());
+        for (size_t k = 0; k < universe.size(); ++k) {
+            Carving carving{universe[k], {}, {}};
+            carve(carving);
+            carvings[k] = std::move(carving);
+            source_index.insert(k, universe[k]);
+        }
+    } else {
+        // 4) A new subtrahend only cuts the parts it overlaps
+        for (auto minuend_id : source_index.candidates(piece)) {
+            auto &carving = carvings.at(minuend_id);
+            if (!carving.source->intersects(piece)) {
+                continue;
+            }
+            carving.cuts.insert(id);
+            std::vector<AbstractSimpleSetPtr_t> parts;
+            for (auto const &part : carving.parts) {
+                if (!part->intersects(piece)) {
+                    parts.push_back(part);
+                    continue;
+                }
+                checkpoint();
+                auto rests = part->difference_with(piece);
+                for (auto const &rest : *rests) {
+                    if (!rest->is_empty()) {
+                        parts.push_back(rest);
+                    }
+                }
+            }
+            carving.parts = std::move(parts);
+        }
+    }
+    return id;
+}
+
+void MaterializedView::erase(ViewInput input, size_t id) {
+    int side = static_cast<int>(input);
+    auto position = pieces[side].find(id);
+    if (position == pieces[side].end()) {
+        throw std::invalid_argument("The operand has no piece with this id.");
+    }
+    auto piece = position->second;
+    pieces[side].erase(position);
+    piece_index[side].erase(id);
+    for (auto other_id : piece_index[side].candidates(piece)) {
+        if (pieces[side].at(other_id)->intersects(piece)) {
+            --overlaps[side];
+        }
+    }
+
+    // Retract the result pieces derived from the piece
+    if (operation == SetOperation::INTERSECTION) {
+        if (side == 0) {
+            intersections.erase(intersections.lower_bound({id, 0}), intersections.lower_bound({id + 1, 0}));
+        } else {
+            // only pieces of lhs that may overlap the piece have an intersection with it
+            for (auto lhs_id : piece_index[0].candidates(piece)) {
+                intersections.erase({lhs_id, id});
+            }
+        }
+    } else if (side == minuend()) {
+        carvings.erase(id);
+        source_index.erase(id);
+    } else {
+        // the parts a removed subtrahend had cut away come back, hence the pieces it cut are carved again
+        for (auto minuend_id : source_index.candidates(piece)) {
+            auto &carving = carvings.at(minuend_id);
+            if (carving.cuts.count(id) > 0) {
+                carve(carving);
+            }
+        }
+    }
+}
+
+//
+// ===============================
+//  —— Result ——
+// ===============================
+//
+
+std::vector<size_t> MaterializedView::ids(ViewInput input) const {
+    std::vector<size_t> result;
+    for (auto const &[id, piece] : pieces[static_cast<int>(input)]) {
+        result.push_back(id);
+    }
+    return result;
+}
+
+std::vector<AbstractSimpleSetPtr_t> MaterializedView::collect() const {
+    std::vector<AbstractSimpleSetPtr_t> result;
+    if (operation == SetOperation::INTERSECTION) {
+        for (auto const &[key, intersection] : intersections) {
+            result.push_back(intersection);
+        }
+        return result;
+    }
+
+    // the complement of the empty set is empty, like in `complement`
+    if (operation == SetOperation::COMPLEMENT && pieces[0].empty()) {
+        return result;
+    }
+    if (operation == SetOperation::UNION) {
+        for (auto const &[id, piece] : pieces[0]) {
+            if (!piece->is_empty()) {
+                result.push_back(piece);
+            }
+        }
+    }
+    for (auto const &[id, carving] : carvings) {
+        result.insert(result.end(), carving.parts.begin(), carving.parts.end());
+    }
+    return result;
+}
+
+size_t MaterializedView::size() const {
+    return collect().size();
+}
+
+AbstractCompositeSetPtr_t MaterializedView::result() const {
+    auto simple_sets = collect();
+    auto result = empty->make_new_empty();
+    result->simple_sets->insert(simple_sets.begin(), simple_sets.end());
+
+    // the parts of one piece are disjoint; pieces of different pieces are if the pieces they come from are
+    bool disjoint = operation == SetOperation::COMPLEMENT;
+    if (operation == SetOperation::DIFFERENCE) {
+        disjoint = overlaps[0] == 0;
+    } else if (operation == SetOperation::INTERSECTION || operation == SetOperation::UNION) {
+        disjoint = overlaps[0] == 0 && overlaps[1] == 0;
+    }
+    if (disjoint) {
+        result->mark_disjoint();
+    }
+    return result;
+}
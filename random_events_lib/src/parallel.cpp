@@ -0,0 +1,400 @@
+#include "parallel.h"
+#include "cancellation.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//
+// ===============================
+//  —— ParallelOptions ——
+// ===============================
+//
+
+// Helper: The settings and the shared pool of this process, guarded by one mutex.
+struct ParallelState {
+    std::mutex mutex;
+    ParallelOptions options;
+    ThreadPoolPtr_t pool;
+    WorkStealingExecutorPtr_t executor;
+};
+
+static ParallelState &parallel_state() {
+    static ParallelState state;
+    return state;
+}
+
+// Helper: Resolve 0 to the number of hardware threads.
+static size_t effective_threads(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    return threads;
+}
+
+ParallelOptions get_parallel_options() {
+    auto &state = parallel_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.options;
+}
+
+void set_parallel_options(const ParallelOptions &options) {
+    ThreadPoolPtr_t replaced;
+    WorkStealingExecutorPtr_t replaced_executor;
+    {
+        auto &state = parallel_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (effective_threads(options.threads) != effective_threads(state.options.threads)) {
+            replaced = std::move(state.pool);
+            replaced_executor = std::move(state.executor);
+        }
+        state.options = options;
+    }
+    // the replaced pool and executor are joined outside of the lock, after the operations that still use them
+    // finished
+}
+
+ThreadPoolPtr_t default_thread_pool() {
+    auto &state = parallel_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.pool == nullptr) {
+        state.pool = std::make_shared<ThreadPool>(effective_threads(state.options.threads) - 1);
+    }
+    return state.pool;
+}
+
+WorkStealingExecutorPtr_t default_work_stealing_executor() {
+    auto &state = parallel_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.executor == nullptr) {
+        state.executor = make_shared_work_stealing_executor(effective_threads(state.options.threads));
+    }
+    return state.executor;
+}
+
+//
+// ===============================
+//  —— SequentialScope ——
+// ===============================
+//
+
+static thread_local bool sequential_scope = false;
+
+SequentialScope::SequentialScope() : previous(sequential_scope) {
+    sequential_scope = true;
+}
+
+SequentialScope::~SequentialScope() {
+    sequential_scope = previous;
+}
+
+bool in_sequential_scope() {
+    return sequential_scope;
+}
+
+//
+// ===============================
+//  —— ThreadPool ——
+// ===============================
+//
+
+ThreadPool::ThreadPool(size_t workers_) {
+    workers.reserve(workers_);
+    for (size_t i = 0; i < workers_; ++i) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_up.notify_all();
+    for (auto &worker : workers) {
+        // a pool released by the last task of one of its own workers cannot join that worker
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach();
+        } else {
+            worker.join();
+        }
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake_up.notify_one();
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake_up.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+//
+// ===============================
+//  —— run_chunks ——
+// ===============================
+//
+
+// Helper: The chunks of one call of run_chunks. Helpers that start after every chunk was claimed only touch `next`,
+//   hence the job outlives the call through shared ownership while `run_chunk` does not have to.
+struct ChunkJob {
+    const std::function<void(size_t)> *run_chunk = nullptr;
+    size_t chunks = 0;
+    OperationControlPtr_t control;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<bool> failed{false};
+
+    // guards error and the wake up of the caller
+    std::mutex mutex;
+    std::condition_variable finished_all;
+    std::exception_ptr error;
+
+    void work() {
+        ControlScope scope(control);
+        for (size_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                try {
+                    (*run_chunk)(chunk);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (error == nullptr) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+
+            if (finished.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished_all.notify_all();
+            }
+        }
+    }
+};
+
+void run_chunks(size_t chunks, size_t threads, const std::function<void(size_t)> &run_chunk) {
+    if (chunks == 0) {
+        return;
+    }
+
+    auto job = std::make_shared<ChunkJob>();
+    job->run_chunk = &run_chunk;
+    job->chunks = chunks;
+    job->control = current_operation_control();
+
+    // 1) Ask for helpers; the calling thread is one of the threads
+    auto pool = default_thread_pool();
+    auto helpers = std::min({effective_threads(threads) - 1, pool->size(), chunks - 1});
+    for (size_t i = 0; i < helpers; ++i) {
+        pool->submit([job]() { job->work(); });
+    }
+
+    // 2) Work along and wait for the chunks that helpers claimed
+    job->work();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished_all.wait(lock, [&job]() { return job->finished.load(std::memory_order_acquire) == job->chunks; });
+    if (job->error != nullptr) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+//
+// ===============================
+//  —— WorkStealingExecutor ——
+// ===============================
+//
+
+// Helper: The items [begin, end) a thread still has to run. The owner takes items from the front, thieves take the
+//   upper half.
+struct WorkBlock {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+struct WorkStealingExecutor::Batch {
+    const std::function<void(size_t)> *function = nullptr;
+    size_t count = 0;
+    size_t slots = 0;
+    std::unique_ptr<WorkBlock[]> blocks;
+    OperationControlPtr_t control;
+    std::atomic<size_t> completed{0};
+
+    // guards the error and the wake up of the caller
+    std::mutex mutex;
+    std::condition_variable finished_all;
+    size_t failed_index = std::numeric_limits<size_t>::max();
+    std::exception_ptr error;
+
+    // Claim the next item of a thread, stealing if its own block is used up. Returns false if no work is left.
+    bool claim(size_t slot, size_t &index) {
+        auto &own = blocks[slot];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                index = own.begin++;
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < slots; ++offset) {
+            auto &victim = blocks[(slot + offset) % slots];
+            size_t begin;
+            size_t end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin >= victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            std::lock_guard<std::mutex> lock(own.mutex);
+            index = begin;
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t slot) {
+        SequentialScope sequential;
+        ControlScope scope(control);
+        size_t index;
+        while (claim(slot, index)) {
+            try {
+                (*function)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (index < failed_index) {
+                    failed_index = index;
+                    error = std::current_exception();
+                }
+            }
+            if (completed.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished_all.notify_all();
+            }
+        }
+    }
+};
+
+// Helper: Pin the calling thread to one core.
+static void pin_to_core(size_t core) {
+#ifdef __linux__
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core % std::max<size_t>(std::thread::hardware_concurrency(), 1), &cores);
+    pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#else
+    (void) core;
+#endif
+}
+
+WorkStealingExecutor::WorkStealingExecutor(size_t threads, bool pin_threads) {
+    threads = effective_threads(threads);
+    workers.reserve(threads - 1);
+    for (size_t slot = 1; slot < threads; ++slot) {
+        workers.emplace_back([this, slot, pin_threads]() {
+            if (pin_threads) {
+                pin_to_core(slot);
+            }
+            work(slot);
+        });
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_up.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+size_t WorkStealingExecutor::size() const {
+    return workers.size() + 1;
+}
+
+void WorkStealingExecutor::run(size_t count, const std::function<void(size_t)> &function) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+
+    // 1) Hand every thread a contiguous block of the items
+    auto batch = std::make_shared<Batch>();
+    batch->function = &function;
+    batch->count = count;
+    batch->slots = size();
+    batch->control = current_operation_control();
+    batch->blocks.reset(new WorkBlock[batch->slots]);
+    for (size_t slot = 0; slot < batch->slots; ++slot) {
+        batch->blocks[slot].begin = count * slot / batch->slots;
+        batch->blocks[slot].end = count * (slot + 1) / batch->slots;
+    }
+
+    // 2) Wake the workers up and work along; workers that wake up late find no items and never call the function
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = batch;
+        ++generation;
+    }
+    wake_up.notify_all();
+    batch->work(0);
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished_all.wait(lock, [&batch]() {
+        return batch->completed.load(std::memory_order_acquire) == batch->count;
+    });
+    if (batch->error != nullptr) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void WorkStealingExecutor::work(size_t slot) {
+    size_t seen = 0;
+    while (true) {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake_up.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            batch = current;
+        }
+        batch->work(slot);
+    }
+}
@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
 #include <iterator>
 #include <vector>
 #include <sstream>
+#include <tuple>
+#include <mutex>
 #include "product_algebra.h"
+#include "spatial_index.h"
+#include "parallel.h"
+#include "cancellation.h"
+#include "generator.h"
 
 //
 // ===============================
@@ -85,14 +94,21 @@ AbstractSimpleSetPtr_t SimpleEvent::intersection_with(const AbstractSimpleSetPtr
     return result;
 }
 
-void SimpleEvent::fill_missing_variables(const VariableSetPtr_t &variables) const {
-    // For each var in 'variables', if not in variable_map, insert domain
-    // We expect 'variables' is a sorted std::set, so iterating is O(|variables|)
+void SimpleEvent::fill_missing_variables(const VariableSetPtr_t &variables) {
+    // For each var in 'variables', if not in variable_map, insert domain.
+    // The map may be shared with other simple events, so it is copied before the first insertion (copy on write).
+    VariableMapPtr_t filled;
     for (auto const &var : *variables) {
         if (variable_map->find(var) == variable_map->end()) {
-            variable_map->insert({var, var->get_domain()});
+            if (filled == nullptr) {
+                filled = std::make_shared<VariableMap>(*variable_map);
+            }
+            filled->insert({var, var->get_domain()});
         }
     }
+    if (filled != nullptr) {
+        variable_map = filled;
+    }
 }
 
 VariableSetPtr_t SimpleEvent::get_variables() const {
@@ -145,62 +161,361 @@ SimpleEvent::SimpleEvent(VariableMapPtr_t &variable_map_ptr) {
     variable_map = variable_map_ptr;
 }
 
+SimpleEvent::SimpleEvent(const SimpleEvent &other) : AbstractSimpleSet(other), variable_map(other.variable_map) {}
+
+SimpleEvent &SimpleEvent::operator=(const SimpleEvent &other) {
+    // The fingerprint cache notices the new variable map by itself
+    variable_map = other.variable_map;
+    return *this;
+}
+
+void name_ordering(VariablePeels & /*peels*/) {
+    // The peels are built by walking the variable map, so they already are in PointerLess order.
+}
+
+void cost_aware_ordering(VariablePeels &peels) {
+    // stable_sort keeps the name order among equally expensive variables, so the result is deterministic.
+    std::stable_sort(peels.begin(), peels.end(), [](const VariablePeel &lhs, const VariablePeel &rhs) {
+        auto lhs_peeled = lhs.peeled->simple_sets->size();
+        auto rhs_peeled = rhs.peeled->simple_sets->size();
+        if (lhs_peeled != rhs_peeled) {
+            // an empty peel sorts first automatically
+            return lhs_peeled < rhs_peeled;
+        }
+        return lhs.kept->simple_sets->size() < rhs.kept->simple_sets->size();
+    });
+}
+
+// Helper: Build piece 'idx' of a peeling or nullptr if it is empty.
+//   Piece i assigns 'kept' to every variable before i, 'peeled' to variable i and 'unpeeled' to every
+//   variable after i.  Variables with an empty peel produce no piece.
+static SimpleEventPtr_t make_peeled_piece(const VariablePeels &peels, size_t idx) {
+    const size_t vcount = peels.size();
+    auto const &peel = peels[idx];
+    if (peel.peeled->is_empty()) {
+        return nullptr;
+    }
+
+    auto piece = make_shared_simple_event();
+    auto &piece_map = piece->variable_map;
+    for (size_t k = 0; k < idx; ++k) {
+        piece_map->insert({peels[k].variable, peels[k].kept});
+    }
+    piece_map->insert({peel.variable, peel.peeled});
+    for (size_t k = idx + 1; k < vcount; ++k) {
+        piece_map->insert({peels[k].variable, peels[k].unpeeled});
+    }
+
+    if (piece->is_empty()) {
+        return nullptr;
+    }
+    return piece;
+}
+
+// Helper: Emit the pieces of a peeling into 'result'.
+static void emit_peeled_pieces(const VariablePeels &peels, const SimpleSetSetPtr_t &result) {
+    const size_t vcount = peels.size();
+    std::vector<AbstractSimpleSetPtr_t> scratch;
+    scratch.reserve(vcount);
+
+    for (size_t idx = 0; idx < vcount; ++idx) {
+        if (auto piece = make_peeled_piece(peels, idx)) {
+            scratch.push_back(piece);
+        }
+    }
+
+    result->insert(scratch.begin(), scratch.end());
+}
+
+// Helper: Produce the pieces of a peeling one at a time; a piece is only built when it is asked for.
+class PeelGenerator : public PieceGenerator {
+public:
+    explicit PeelGenerator(VariablePeels peels_) : peels(std::move(peels_)) {}
+
+    AbstractSimpleSetPtr_t next() override {
+        while (position < peels.size()) {
+            if (auto piece = make_peeled_piece(peels, position++)) {
+                return piece;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    VariablePeels peels;
+    size_t position = 0;
+};
+
 SimpleSetSetPtr_t SimpleEvent::complement() {
-    // We want to generate, for each variable key v_i, a new SimpleEvent in which:
-    //   - v_i is assigned 'assignment->complement()'
-    //   - every variable processed earlier is assigned value from this->variable_map
-    //   - every variable not yet processed is assigned its full domain
-    //
-    // The original did repeated get_variables() and repeated map lookups.  We will:
-    //   1) Collect all keys of variable_map once, in sorted order
-    //   2) Iterate that vector with an index 'idx'—so we know which variables are "before" vs "after"
-    //   3) Build each current_complement with exactly v variable‐map‐inserts, in O(v log v) per iteration
-    //   4) Append to result only if non‐empty
+    return complement(cost_aware_ordering);
+}
+
+SimpleSetSetPtr_t SimpleEvent::complement(const VariableOrderingStrategy_t &ordering) {
+    // The complement of a box is the disjoint union of v pieces.  Piece i keeps the original assignment of
+    // every variable peeled before it, takes the complement of variable i and is unconstrained afterwards.
     //
-    // This eliminates repeated calls to get_variables() inside the loop.
+    // Which variable is peeled first changes the shape of the pieces, so the order is left to 'ordering'.
+    // Every complement is computed exactly once, which also lets the strategy inspect its cost.
+
+    VariablePeels peels;
+    peels.reserve(variable_map->size());
+    for (auto const &[variable, assignment] : *variable_map) {
+        peels.push_back({variable, assignment, assignment->complement(), variable->get_domain()});
+    }
+
+    ordering(peels);
 
     auto result = make_shared_simple_set_set();
+    emit_peeled_pieces(peels, result);
+    return result;
+}
 
-    // 1) Get all keys in variable_map once, sorted
-    auto all_keys = map_keys_to_vector(variable_map);
-    size_t vcount = all_keys.size();
+PieceGeneratorPtr_t SimpleEvent::complement_pieces() {
+    // The peels hold one complement per variable; the pieces, which hold v assignments each, are built on demand
+    VariablePeels peels;
+    peels.reserve(variable_map->size());
+    for (auto const &[variable, assignment] : *variable_map) {
+        peels.push_back({variable, assignment, assignment->complement(), variable->get_domain()});
+    }
+    cost_aware_ordering(peels);
+    return std::make_shared<PeelGenerator>(std::move(peels));
+}
 
-    // 2) For each index i = 0..vcount−1, build a complement event
-    for (size_t idx = 0; idx < vcount; ++idx) {
-        auto const &var_i = all_keys[idx];
-        auto const &assign_i = variable_map->at(var_i);
+SimpleSetSetPtr_t SimpleEvent::difference_with(const AbstractSimpleSetPtr_t &other) {
+    return difference_with(other, cost_aware_ordering);
+}
 
-        // 2a) Build current_complement event
-        auto current_complement = make_shared_simple_event();
-        auto &cur_map = current_complement->variable_map;
+SimpleSetSetPtr_t SimpleEvent::difference_with(const AbstractSimpleSetPtr_t &other,
+                                               const VariableOrderingStrategy_t &ordering) {
+    // A \ B for two boxes is the disjoint union of at most v pieces.  Piece i is A ∩ B on every variable peeled
+    // before i, A_i \ B_i on variable i and A on every variable after i.
+    //
+    // Unlike the generic A ∩ (A ∩ B)^c this never builds the complement of a box; it intersects every variable once
+    // and only forms A_v \ B_v where B actually cuts into A.
 
-        // 2b) v_i gets assignment->complement()
-        auto compl_i = assign_i->complement();
-        cur_map->insert({var_i, compl_i});
+    auto result = make_shared_simple_set_set();
+    if (is_empty()) {
+        return result;
+    }
+
+    const auto &self_map = variable_map;
+    const auto &other_map = static_cast<SimpleEvent *>(other.get())->variable_map;
+
+    // 1) Intersect every variable; bail out with {A} as soon as the boxes are disjoint.
+    //    A variable missing in B is unconstrained by B; a variable missing in A is assigned its domain.
+    VariablePeels peels;
+    peels.reserve(self_map->size() + other_map->size());
+    std::vector<AbstractCompositeSetPtr_t> other_assignments;
+    other_assignments.reserve(self_map->size() + other_map->size());
+
+    auto it_self = self_map->begin();
+    auto it_other = other_map->begin();
+    while (it_self != self_map->end() || it_other != other_map->end()) {
+        if (it_other == other_map->end() || (it_self != self_map->end() && *(it_self->first) < *(it_other->first))) {
+            // Only in A: B does not constrain it
+            peels.push_back({it_self->first, it_self->second, nullptr, it_self->second});
+            other_assignments.push_back(nullptr);
+            ++it_self;
+            continue;
+        }
 
-        // 2c) For every variable before var_i (0..idx−1), assign original
-        for (size_t k = 0; k < idx; ++k) {
-            cur_map->insert({ all_keys[k], variable_map->at(all_keys[k]) });
+        AbstractVariablePtr_t variable;
+        AbstractCompositeSetPtr_t self_assignment;
+        if (it_self == self_map->end() || *(it_other->first) < *(it_self->first)) {
+            // Only in B
+            variable = it_other->first;
+            self_assignment = variable->get_domain();
+        } else {
+            variable = it_self->first;
+            self_assignment = it_self->second;
+            ++it_self;
         }
-        // 2d) For every variable after var_i (idx+1..vcount−1), assign full domain
-        for (size_t k = idx + 1; k < vcount; ++k) {
-            cur_map->insert({ all_keys[k], all_keys[k]->get_domain() });
+        auto other_assignment = it_other->second;
+        ++it_other;
+
+        if (self_assignment == other_assignment) {
+            // Same assignment object: B does not cut into A here
+            peels.push_back({variable, self_assignment, nullptr, self_assignment});
+            other_assignments.push_back(nullptr);
+            continue;
         }
 
-        // 2e) If this new SimpleEvent is not empty, add it to result
-        if (!current_complement->is_empty()) {
-            result->insert(current_complement);
+        auto intersection = self_assignment->intersection_with(other_assignment);
+        if (intersection->is_empty()) {
+            result->insert(share_more());
+            return result;
+        }
+        peels.push_back({variable, intersection, nullptr, self_assignment});
+        other_assignments.push_back(other_assignment);
+    }
+
+    // 2) Only now that the boxes are known to overlap, form A_v \ B_v where B constrains A.
+    for (size_t idx = 0; idx < peels.size(); ++idx) {
+        auto &peel = peels[idx];
+        if (other_assignments[idx] == nullptr) {
+            peel.peeled = peel.unpeeled->make_new_empty();
+        } else {
+            peel.peeled = peel.unpeeled->difference_with(other_assignments[idx]);
         }
     }
 
+    ordering(peels);
+    emit_peeled_pieces(peels, result);
     return result;
 }
 
+bool SimpleEvent::is_subset_of(const AbstractSimpleSetPtr_t &other) {
+    if (is_empty()) {
+        return true;
+    }
+    const auto &other_map = static_cast<SimpleEvent *>(other.get())->variable_map;
+    for (auto const &[variable, other_assignment] : *other_map) {
+        auto assignment = variable_map->find(variable);
+        auto self_assignment = assignment == variable_map->end() ? variable->get_domain() : assignment->second;
+        if (self_assignment != other_assignment && !self_assignment->is_subset_of(other_assignment)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SimpleEvent::intersects(const AbstractSimpleSetPtr_t &other) {
+    // Variables missing in one of the simple events are unconstrained by it; they only have to be non-empty.
+    const auto &other_map = static_cast<SimpleEvent *>(other.get())->variable_map;
+    for (auto const &[variable, assignment] : *variable_map) {
+        auto other_assignment = other_map->find(variable);
+        if (other_assignment == other_map->end() ? assignment->is_empty()
+                                                 : !assignment->intersects(other_assignment->second)) {
+            return false;
+        }
+    }
+    for (auto const &[variable, other_assignment] : *other_map) {
+        if (variable_map->find(variable) == variable_map->end() && other_assignment->is_empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool SimpleEvent::contains(const ElementaryVariant * /*element*/) {
     // Original always returned false. We keep that behavior.
     return false;
 }
 
+// Helper: The bounds of a simple interval in a form that can be tested without branches.
+struct IntervalBounds {
+    double lower;
+    double upper;
+    bool lower_closed;
+    bool upper_closed;
+
+    bool contains(double x) const {
+        return ((x > lower) | ((x == lower) & lower_closed)) & ((x < upper) | ((x == upper) & upper_closed));
+    }
+};
+
+// Helper: Keep the rows of 'selection' whose value lies in 'assignment'.
+//   The dense path scans the column contiguously into a byte mask (one pass per simple interval, which the
+//   compiler can vectorize) and compacts afterwards.  The sparse path gathers the selected rows and compacts
+//   without branches.
+template<typename T>
+static void filter_by_interval(const T *column, const Interval &assignment, RowSelection &selection, bool dense) {
+    std::vector<IntervalBounds> bounds;
+    bounds.reserve(assignment.simple_sets->size());
+    for (auto const &simple_set : *assignment.simple_sets) {
+        auto simple_interval = static_cast<SimpleInterval *>(simple_set.get());
+        if (!simple_interval->is_empty()) {
+            bounds.push_back({simple_interval->lower, simple_interval->upper,
+                              simple_interval->left == BorderType::CLOSED,
+                              simple_interval->right == BorderType::CLOSED});
+        }
+    }
+
+    const size_t count = selection.size();
+    size_t kept = 0;
+    if (dense) {
+        std::vector<std::uint8_t> inside(count, 0);
+        for (auto const &bound : bounds) {
+            for (size_t row = 0; row < count; ++row) {
+                inside[row] |= bound.contains(static_cast<double>(column[row]));
+            }
+        }
+        for (size_t row = 0; row < count; ++row) {
+            selection[kept] = static_cast<std::uint32_t>(row);
+            kept += inside[row];
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            const std::uint32_t row = selection[i];
+            const double x = static_cast<double>(column[row]);
+            bool inside = false;
+            for (auto const &bound : bounds) {
+                inside |= bound.contains(x);
+            }
+            selection[kept] = row;
+            kept += inside;
+        }
+    }
+    selection.resize(kept);
+}
+
+// Helper: Keep the rows of 'selection' whose element index lies in 'assignment' (one table lookup per row).
+static void filter_by_set(const std::int64_t *column, const Set &assignment, RowSelection &selection) {
+    const auto universe = static_cast<std::uint64_t>(assignment.all_elements->size());
+    std::vector<std::uint8_t> member(universe, 0);
+    for (auto const &simple_set : *assignment.simple_sets) {
+        auto element_index = static_cast<SetElement *>(simple_set.get())->element_index;
+        if (element_index >= 0) {
+            member[element_index] = 1;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < selection.size(); ++i) {
+        const std::uint32_t row = selection[i];
+        const auto value = static_cast<std::uint64_t>(column[row]);  // negative values wrap and fail the bound check
+        selection[kept] = row;
+        kept += value < universe && member[value];
+    }
+    selection.resize(kept);
+}
+
+void SimpleEvent::filter_contained(const ColumnMap &columns, RowSelection &selection, bool dense) const {
+    for (auto const &[variable, assignment] : *variable_map) {
+        if (selection.empty()) {
+            return;
+        }
+
+        auto column = columns.find(variable);
+        if (auto set = dynamic_cast<Set *>(assignment.get())) {
+            if (set->simple_sets->size() == set->all_elements->size()) {
+                continue;  // full domain, nothing to reject
+            }
+            if (column == columns.end()) {
+                throw std::invalid_argument("missing column for variable " + *variable->name);
+            }
+            auto values = std::get_if<const std::int64_t *>(&column->second);
+            if (values == nullptr) {
+                throw std::invalid_argument("the column of symbolic variable " + *variable->name +
+                                            " must contain int64 element indices");
+            }
+            filter_by_set(*values, *set, selection);
+        } else {
+            auto interval = static_cast<Interval *>(assignment.get());
+            if (interval->simple_sets->size() == 1 &&
+                interval->lower() == -std::numeric_limits<double>::infinity() &&
+                interval->upper() == std::numeric_limits<double>::infinity()) {
+                continue;  // the real line, nothing to reject
+            }
+            if (column == columns.end()) {
+                throw std::invalid_argument("missing column for variable " + *variable->name);
+            }
+            std::visit([&](auto values) { filter_by_interval(values, *interval, selection, dense); }, column->second);
+        }
+        dense = false;
+    }
+}
+
 bool SimpleEvent::is_empty() {
     // If there are no variables, it’s empty
     if (variable_map->empty()) {
@@ -270,12 +585,51 @@ std::string *SimpleEvent::non_empty_to_string() {
     return result;
 }
 
+// Helper: Digest of the variables of a map and the versions of the simple sets of their assignments.
+//   A version stamp identifies the simple sets it belongs to, hence an equal digest means an equal fingerprint unless
+//   the 64 bit digests collide.  0 is never returned, such that it can mark a missing fingerprint.
+static std::uint64_t assignment_digest(const VariableMap &variable_map) {
+    std::uint64_t result = variable_map.size();
+    for (auto const &[variable, assignment] : variable_map) {
+        result = combine_fingerprints(result, reinterpret_cast<std::uintptr_t>(variable.get()));
+        result = combine_fingerprints(result, assignment->simple_sets->version());
+    }
+    return result | 1;
+}
+
+std::uint64_t SimpleEvent::fingerprint() const {
+    // Concurrent callers compute equal fingerprints for the same map; the digest is published last, so a reader that
+    // sees a matching digest also sees its fingerprint
+    auto digest = assignment_digest(*variable_map);
+    if (fingerprint_digest.load(std::memory_order_acquire) == digest) {
+        return cached_fingerprint.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t result = variable_map->size();
+    for (auto const &[variable, assignment] : *variable_map) {
+        result = combine_fingerprints(result, std::hash<std::string>{}(*variable->name));
+        result = combine_fingerprints(result, assignment->fingerprint());
+    }
+    cached_fingerprint.store(result, std::memory_order_relaxed);
+    fingerprint_digest.store(digest, std::memory_order_release);
+    return result;
+}
+
+size_t SimpleEvent::memory_usage() const {
+    // Every entry of the map is a tree node of the pair and about four pointers
+    size_t result = sizeof(SimpleEvent) + sizeof(VariableMap);
+    for (auto const &[variable, assignment] : *variable_map) {
+        result += sizeof(VariableMap::value_type) + 4 * sizeof(void *) + assignment->memory_usage();
+    }
+    return result;
+}
+
 bool SimpleEvent::operator==(const AbstractSimpleSet &other) {
     // Compare two SimpleEvents for equality of variable_map
     const auto &rhs = static_cast<const SimpleEvent &>(other);
 
-    // 1) Quick size check
-    if (variable_map->size() != rhs.variable_map->size()) {
+    // 1) Quick size and fingerprint check; equal simple events are equivalent and hence have equal fingerprints
+    if (variable_map->size() != rhs.variable_map->size() || fingerprint() != rhs.fingerprint()) {
         return false;
     }
 
@@ -296,9 +650,16 @@ bool SimpleEvent::operator==(const AbstractSimpleSet &other) {
 }
 
 bool SimpleEvent::operator<(const AbstractSimpleSet &other) {
-    // Lexicographical compare on (var → assignment) maps
     const auto &rhs = static_cast<const SimpleEvent &>(other);
 
+    // Fingerprints first; equivalent simple events have equal fingerprints, so this is a strict weak ordering
+    const auto key = fingerprint();
+    const auto other_key = rhs.fingerprint();
+    if (key != other_key) {
+        return key < other_key;
+    }
+
+    // Lexicographical compare on (var → assignment) maps
     auto it1 = variable_map->begin();
     auto it2 = rhs.variable_map->begin();
     auto end1 = variable_map->end();
@@ -364,30 +725,68 @@ AbstractSimpleSetPtr_t SimpleEvent::marginal(const VariableSetPtr_t &variables)
 // ===============================
 //
 
-Event::Event() {
+/**
+ * Marginals of an event keyed by the names of the kept variables.
+ * The entries are valid as long as the simple events of the event keep the version they were computed for.
+ */
+struct Event::MarginalCache {
+    static constexpr size_t MAX_ENTRIES = 32;
+
+    std::mutex mutex;
+    std::uint64_t source_version = 0;
+    std::map<std::vector<std::string>, AbstractCompositeSetPtr_t> entries;
+};
+
+Event::Event() : marginal_cache(std::make_shared<MarginalCache>()) {
     simple_sets = make_shared_simple_set_set();
 }
 
-Event::Event(const SimpleSetSetPtr_t &simple_events) {
+Event::Event(const SimpleSetSetPtr_t &simple_events) : marginal_cache(std::make_shared<MarginalCache>()) {
     simple_sets = simple_events;
     fill_missing_variables();
 }
 
-Event::Event(const SimpleEventPtr_t &simple_event) {
+Event::Event(const SimpleEventPtr_t &simple_event) : marginal_cache(std::make_shared<MarginalCache>()) {
     simple_sets = make_shared_simple_set_set();
     simple_sets->insert(simple_event);
     fill_missing_variables();
 }
 
-void Event::fill_missing_variables(const VariableSetPtr_t &variable_set) const {
-    // For each SimpleEvent in this composite, call its fill_missing_variables
-    for (auto const &simple_event : *simple_sets) {
+// Helper: Fill the missing variables of every simple event of a set.
+//   Simple events may be shared with other events, so the ones that miss variables are replaced by filled copies.
+//   Filling changes the fingerprints and hence the order of the simple events, so the set is sorted again in place.
+//   Returns true if any simple event changed.
+static bool fill_and_resort(SimpleSetSet_t &simple_events, const VariableSetPtr_t &variables) {
+    bool changed = false;
+    std::vector<AbstractSimpleSetPtr_t> filled;
+    filled.reserve(simple_events.size());
+    for (auto const &simple_event : simple_events) {
         auto casted = static_cast<SimpleEvent *>(simple_event.get());
-        casted->fill_missing_variables(variable_set);
+        auto copy = make_shared_simple_event(*casted);
+        copy->fill_missing_variables(variables);
+        if (copy->variable_map == casted->variable_map) {
+            filled.push_back(simple_event);
+        } else {
+            filled.push_back(copy);
+            changed = true;
+        }
+    }
+    if (changed) {
+        SimpleSetSet_t resorted(filled.begin(), filled.end());
+        simple_events.swap(resorted);
+    }
+    return changed;
+}
+
+void Event::fill_missing_variables(const VariableSetPtr_t &variable_set) {
+    // For each SimpleEvent in this composite, call its fill_missing_variables
+    if (fill_and_resort(*simple_sets, variable_set)) {
+        drop_invariants();
+        index = nullptr;
     }
 }
 
-void Event::fill_missing_variables() const {
+void Event::fill_missing_variables() {
     // 1) Gather all variables from each SimpleEvent in simple_sets, but avoid rebuilding a separate map for each Event.
     // We will collect them into a single VariableSet.
     VariableSet all_vars;
@@ -403,9 +802,9 @@ void Event::fill_missing_variables() const {
 
     // 2) Now call the overload for every SimpleEvent
     auto shared_vars = std::make_shared<VariableSet>(all_vars.begin(), all_vars.end());
-    for (auto const &simple_event_ptr : *simple_sets) {
-        auto casted = static_cast<SimpleEvent *>(simple_event_ptr.get());
-        casted->fill_missing_variables(shared_vars);
+    if (fill_and_resort(*simple_sets, shared_vars)) {
+        drop_invariants();
+        index = nullptr;
     }
 }
 
@@ -453,6 +852,7 @@ std::tuple<EventPtr_t, bool> Event::simplify_once() {
     // 2) For i<j pairs:
     for (size_t i = 0; i < n; ++i) {
         for (size_t j = i + 1; j < n; ++j) {
+            checkpoint();
             auto &A = vec[i]->variable_map;  // map<AbstractVariablePtr_t, AbstractCompositeSetPtr_t>
             auto &B = vec[j]->variable_map;
             // Both A and B should have identical keys (because fill_missing_variables() was run),
@@ -524,6 +924,9 @@ std::tuple<EventPtr_t, bool> Event::simplify_once() {
                     }
                 }
 
+                // Only the merged event is new, the others are shared
+                charge_budget("simplify", 1, merged_event->memory_usage());
+
                 // Build the new Event composite:
                 auto result = make_shared_event();
                 // Insert the merged event first
@@ -555,12 +958,30 @@ std::tuple<EventPtr_t, bool> Event::simplify_once() {
 }
 
 AbstractCompositeSetPtr_t Event::simplify() {
+    if (is_known_simplified()) {
+        auto copy = make_shared_event();
+        copy->simple_sets = make_shared_simple_set_set(*simple_sets);
+        copy->mark_simplified();
+        return copy;
+    }
+
+    // Cancellation is checked between the rounds and inside of them between the pairs of simple events
+    bool disjoint = is_known_disjoint();
+    size_t round = 0;
+    report_progress("simplify", round, 0);
     auto [current, changed] = simplify_once();
     while (changed) {
+        checkpoint();
+        report_progress("simplify", ++round, 0);
         auto [next, next_changed] = current->simplify_once();
         current = next;
         changed = next_changed;
     }
+
+    // Merging simple events keeps them disjoint
+    if (disjoint) {
+        current->mark_simplified();
+    }
     return current;
 }
 
@@ -568,22 +989,393 @@ AbstractCompositeSetPtr_t Event::make_new_empty() const {
     return make_shared_event();
 }
 
-AbstractCompositeSetPtr_t Event::marginal(const VariableSetPtr_t &variables) const {
-    // Build { E_i.marginal(variables) : for each E_i in simple_sets }, then make_disjoint()
-    // Instead of inserting one‐by‐one, we gather them first and do a single bulk‐insert.
+std::vector<std::uint8_t> Event::contains_points(const ColumnMap &columns, size_t rows) const {
+    if (rows > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("batches are limited to 2^32 - 1 rows");
+    }
 
-    std::vector<AbstractSimpleSetPtr_t> scratch;
-    scratch.reserve(simple_sets->size());
+    std::vector<std::uint8_t> mask(rows, 0);
 
-    for (auto const &ptr : *simple_sets) {
-        auto casted = static_cast<SimpleEvent *>(ptr.get());
-        auto marg = casted->marginal(variables);
-        scratch.push_back(marg);
+    // Rows that no simple event accepted so far
+    RowSelection remaining(rows);
+    std::iota(remaining.begin(), remaining.end(), 0);
+    bool dense = true;
+
+    for (auto const &simple_set : *simple_sets) {
+        if (remaining.empty()) {
+            break;
+        }
+        if (simple_set->is_empty()) {
+            continue;
+        }
+
+        RowSelection selection = remaining;
+        static_cast<SimpleEvent *>(simple_set.get())->filter_contained(columns, selection, dense);
+        if (selection.empty()) {
+            continue;
+        }
+
+        for (auto row : selection) {
+            mask[row] = 1;
+        }
+
+        // Drop the accepted rows from the remaining ones (both are sorted)
+        size_t kept = 0;
+        for (auto row : remaining) {
+            remaining[kept] = row;
+            kept += mask[row] == 0;
+        }
+        remaining.resize(kept);
+        dense = false;
+    }
+    return mask;
+}
+
+void Event::build_index() {
+    index = make_shared_spatial_index(simple_sets);
+}
+
+SpatialIndexPtr_t Event::get_index() const {
+    if (index == nullptr || !index->is_built_from(simple_sets)) {
+        return nullptr;
+    }
+    return index;
+}
+
+std::optional<std::vector<AbstractSimpleSetPtr_t>> Event::overlap_candidates(
+    const AbstractSimpleSetPtr_t &simple_set) const {
+    auto current_index = get_index();
+    if (current_index == nullptr) {
+        return std::nullopt;
+    }
+    return current_index->overlapping(simple_set);
+}
+
+// Helper: Emit the part of 'region' that is not covered by any of 'boxes' as disjoint simple events.
+//   The first box that reaches into a region is carved out of it: region \ box is cut at the faces of the box, one
+//   variable after another, and every slab is carved further with the boxes after it.  An explicit stack keeps deep
+//   decompositions off the call stack.
+static void emit_uncovered(const SimpleEventPtr_t &region, const std::vector<AbstractSimpleSetPtr_t> &boxes,
+                           std::vector<SimpleEventPtr_t> &result) {
+    std::vector<std::pair<SimpleEventPtr_t, size_t>> stack;
+    stack.emplace_back(region, 0);
+
+    while (!stack.empty()) {
+        auto [current, next_box] = stack.back();
+        stack.pop_back();
+
+        // 1) Find the first box that reaches into the region
+        while (next_box < boxes.size() && current->intersection_with(boxes[next_box])->is_empty()) {
+            ++next_box;
+        }
+        if (next_box == boxes.size()) {
+            result.push_back(current);
+            continue;
+        }
+
+        // 2) Carve it out and continue with the slabs that remain
+        auto pieces = current->difference_with(boxes[next_box]);
+        for (auto const &piece : *pieces) {
+            stack.emplace_back(std::static_pointer_cast<SimpleEvent>(piece), next_box + 1);
+        }
+    }
+}
+
+// Helper: Encode an assignment as numbers that compare equal exactly if the assignments are equal.
+//   Unlike the ordering of simple intervals this does not ignore border types.
+static std::vector<double> encode_assignment(const AbstractCompositeSet &assignment) {
+    std::vector<double> key;
+    for (auto const &simple_set : *assignment.simple_sets) {
+        if (auto simple_interval = dynamic_cast<const SimpleInterval *>(simple_set.get())) {
+            key.insert(key.end(), {simple_interval->lower, simple_interval->upper,
+                                   static_cast<double>(simple_interval->left),
+                                   static_cast<double>(simple_interval->right)});
+        } else {
+            key.push_back(static_cast<const SetElement *>(simple_set.get())->element_index);
+        }
+    }
+    return key;
+}
+
+// Helper: Merge disjoint simple events that agree on all but one variable ("equal slabs").
+//   For every variable the simple events are sorted by their remaining assignments, such that mergeable ones are
+//   adjacent.  All simple events are expected to share the same variables.
+static std::vector<SimpleEventPtr_t> merge_equal_slabs(const std::vector<SimpleEventPtr_t> &simple_events) {
+    struct Slab {
+        SimpleEventPtr_t simple_event;
+        std::vector<std::vector<double>> keys;
+    };
+
+    std::vector<Slab> slabs;
+    slabs.reserve(simple_events.size());
+    for (auto const &simple_event : simple_events) {
+        Slab slab{simple_event, {}};
+        for (auto const &[variable, assignment] : *simple_event->variable_map) {
+            slab.keys.push_back(encode_assignment(*assignment));
+        }
+        slabs.push_back(std::move(slab));
+    }
+    const size_t variable_count = slabs.empty() ? 0 : slabs.front().keys.size();
+
+    bool changed = true;
+    while (changed && slabs.size() > 1) {
+        changed = false;
+        for (size_t variable = 0; variable < variable_count; ++variable) {
+            auto less_except = [variable, variable_count](const Slab &a, const Slab &b) {
+                for (size_t other = 0; other < variable_count; ++other) {
+                    if (other != variable && a.keys[other] != b.keys[other]) {
+                        return a.keys[other] < b.keys[other];
+                    }
+                }
+                return false;
+            };
+            std::sort(slabs.begin(), slabs.end(), less_except);
+
+            std::vector<Slab> merged;
+            merged.reserve(slabs.size());
+            for (size_t k = 0; k < slabs.size();) {
+                size_t group_end = k + 1;
+                while (group_end < slabs.size() && !less_except(slabs[k], slabs[group_end])) {
+                    ++group_end;
+                }
+                if (group_end == k + 1) {
+                    merged.push_back(std::move(slabs[k]));
+                } else {
+                    auto variable_map = std::make_shared<VariableMap>(*slabs[k].simple_event->variable_map);
+                    auto assignment = std::next(variable_map->begin(), static_cast<std::ptrdiff_t>(variable));
+                    for (size_t other = k + 1; other < group_end; ++other) {
+                        assignment->second = assignment->second->union_with(
+                                std::next(slabs[other].simple_event->variable_map->begin(),
+                                          static_cast<std::ptrdiff_t>(variable))->second);
+                    }
+                    Slab slab{make_shared_simple_event(variable_map), std::move(slabs[k].keys)};
+                    slab.keys[variable] = encode_assignment(*assignment->second);
+                    merged.push_back(std::move(slab));
+                    changed = true;
+                }
+                k = group_end;
+            }
+            slabs = std::move(merged);
+        }
+    }
+
+    std::vector<SimpleEventPtr_t> result;
+    result.reserve(slabs.size());
+    for (auto &slab : slabs) {
+        result.push_back(std::move(slab.simple_event));
+    }
+    return result;
+}
+
+AbstractCompositeSetPtr_t Event::make_disjoint() const {
+    if (is_known_disjoint()) {
+        return AbstractCompositeSet::make_disjoint();
+    }
+
+    // 1) Every simple event contributes the part that no earlier simple event covers.  The index limits the carving
+    //    to the earlier simple events that actually overlap.
+    auto variables = make_shared_variable_set(get_variables_from_simple_events());
+    auto current_index = get_index();
+    if (current_index == nullptr) {
+        current_index = make_shared_spatial_index(simple_sets);
+    }
+
+    //    The carving of a simple event only depends on the input, hence the simple events are carved in parallel and
+    //    their pieces are concatenated in iteration order.
+    auto const &vec = *simple_sets;
+    //    Cancellation is checked between the simple events.
+    std::vector<std::vector<SimpleEventPtr_t>> carved(vec.size());
+    std::atomic<size_t> carved_count{0};
+    parallel_for(vec.size(), [&](size_t k) {
+        checkpoint();
+        auto const &simple_set = vec[k];
+        if (simple_set->is_empty()) {
+            return;
+        }
+        std::vector<AbstractSimpleSetPtr_t> earlier;
+        for (auto const &candidate : current_index->overlapping(simple_set)) {
+            if (candidate == simple_set) {
+                break;
+            }
+            earlier.push_back(candidate);
+        }
+
+        auto box = std::static_pointer_cast<SimpleEvent>(simple_set);
+        if (box->variable_map->size() != variables->size()) {
+            // assign the missing variables their domain without touching the shared simple event
+            box = std::static_pointer_cast<SimpleEvent>(make_shared_simple_event(variables)->intersection_with(box));
+        }
+        emit_uncovered(box, earlier, carved[k]);
+        charge_budget("make_disjoint", carved[k]);
+        report_progress("make_disjoint", ++carved_count, vec.size());
+    });
+
+    std::vector<SimpleEventPtr_t> disjoint;
+    for (auto &pieces : carved) {
+        disjoint.insert(disjoint.end(), pieces.begin(), pieces.end());
     }
 
+    // 2) Merge equal slabs
+    disjoint = merge_equal_slabs(disjoint);
+
     auto result = make_shared_event();
-    if (!scratch.empty()) {
-        result->simple_sets->insert(scratch.begin(), scratch.end());
+    result->simple_sets->insert(disjoint.begin(), disjoint.end());
+    result->mark_disjoint();
+    return result;
+}
+
+AbstractSimpleSetPtr_t Event::compute_hull() const {
+    // 1) Only variables that every simple event constrains can bound the hull
+    auto first = static_cast<SimpleEvent *>(simple_sets->begin()->get());
+    std::map<AbstractVariablePtr_t, AbstractCompositeSetPtr_t, PointerLess<AbstractVariablePtr_t>> accumulators;
+    for (auto const &[variable, assignment] : *first->variable_map) {
+        accumulators.insert({variable, assignment->make_new_empty()});
+    }
+
+    // 2) Collect the hulls of the assignments, or the assignments themselves if they have no hull (symbolic)
+    for (auto const &simple_set : *simple_sets) {
+        auto const &variable_map = static_cast<SimpleEvent *>(simple_set.get())->variable_map;
+        for (auto it = accumulators.begin(); it != accumulators.end();) {
+            auto assignment = variable_map->find(it->first);
+            if (assignment == variable_map->end()) {
+                it = accumulators.erase(it);
+                continue;
+            }
+            if (auto hull = assignment->second->get_hull()) {
+                it->second->simple_sets->insert(hull);
+            } else {
+                it->second->simple_sets->insert(assignment->second->simple_sets->begin(),
+                                                assignment->second->simple_sets->end());
+            }
+            ++it;
+        }
+    }
+
+    // 3) The hull assigns every variable the hull of the collected pieces
+    auto hull_map = std::make_shared<VariableMap>();
+    for (auto const &[variable, accumulator] : accumulators) {
+        if (auto hull = accumulator->get_hull()) {
+            auto assignment = accumulator->make_new_empty();
+            assignment->simple_sets->insert(hull);
+            hull_map->insert({variable, assignment});
+        } else {
+            hull_map->insert({variable, accumulator});
+        }
+    }
+    return make_shared_simple_event(hull_map);
+}
+
+size_t Event::remove_dominated_simple_sets() {
+    constexpr size_t INDEX_THRESHOLD = 32;
+    if (simple_sets->size() < INDEX_THRESHOLD) {
+        return AbstractCompositeSet::remove_dominated_simple_sets();
+    }
+
+    // A simple event can only be contained in simple events whose boxes overlap its box
+    auto current_index = get_index();
+    if (current_index == nullptr) {
+        current_index = make_shared_spatial_index(simple_sets);
+    }
+
+    std::vector<AbstractSimpleSetPtr_t> dominated;
+    std::set<const AbstractSimpleSet *> removed;
+    for (auto const &simple_set : *simple_sets) {
+        for (auto const &candidate : current_index->overlapping(simple_set)) {
+            if (candidate != simple_set && removed.count(candidate.get()) == 0 && simple_set->is_subset_of(candidate)) {
+                dominated.push_back(simple_set);
+                removed.insert(simple_set.get());
+                break;
+            }
+        }
+    }
+
+    if (!dominated.empty()) {
+        // the kept simple events are already in order, hence rebuilding only appends
+        SimpleSetSet_t kept;
+        kept.reserve(simple_sets->size() - dominated.size());
+        for (auto const &simple_set : *simple_sets) {
+            if (removed.count(simple_set.get()) == 0) {
+                kept.insert(simple_set);
+            }
+        }
+        simple_sets->swap(kept);
+    }
+    return dominated.size();
+}
+
+// Helper: Insert a simple event into a set of simple events without losing points.
+//   The ordering of simple events ignores border types, so a simple event that differs only in its borders from one
+//   that is already present would be dropped.  In that case only the part that is not present yet is inserted.
+static void insert_without_loss(SimpleSetSet_t &simple_events, const AbstractSimpleSetPtr_t &simple_event) {
+    auto [existing, inserted] = simple_events.insert(simple_event);
+    if (inserted || **existing == *simple_event) {
+        return;
+    }
+    auto present = *existing;
+    auto pieces = simple_event->difference_with(present);
+    for (auto const &piece : *pieces) {
+        insert_without_loss(simple_events, piece);
+    }
+}
+
+AbstractCompositeSetPtr_t Event::marginal(const VariableSetPtr_t &variables) const {
+    // 1) Look up the cache
+    std::vector<std::string> key;
+    key.reserve(variables->size());
+    for (auto const &variable : *variables) {
+        key.push_back(*variable->name);
+    }
+    auto copy_of = [](const AbstractCompositeSetPtr_t &event) {
+        auto result = make_shared_event();
+        result->simple_sets->insert(event->simple_sets->begin(), event->simple_sets->end());
+        return result;
+    };
+    {
+        std::lock_guard<std::mutex> lock(marginal_cache->mutex);
+        if (marginal_cache->source_version == simple_sets->version()) {
+            auto cached = marginal_cache->entries.find(key);
+            if (cached != marginal_cache->entries.end()) {
+                return copy_of(cached->second);
+            }
+        }
+    }
+
+    // 2) Project every simple event and collapse equal projections.  The ordering of simple events ignores border
+    //    types, hence the projections are compared by their exact encoding.
+    std::vector<std::pair<std::vector<std::vector<double>>, SimpleEventPtr_t>> projections;
+    projections.reserve(simple_sets->size());
+    for (auto const &ptr : *simple_sets) {
+        auto projection = std::static_pointer_cast<SimpleEvent>(static_cast<SimpleEvent *>(ptr.get())->marginal(variables));
+        std::vector<std::vector<double>> encoding;
+        encoding.reserve(projection->variable_map->size());
+        for (auto const &[variable, assignment] : *projection->variable_map) {
+            encoding.push_back(encode_assignment(*assignment));
+        }
+        charge_budget("marginal", 1, projection->memory_usage());
+        projections.emplace_back(std::move(encoding), projection);
+    }
+    std::sort(projections.begin(), projections.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    projections.erase(std::unique(projections.begin(), projections.end(),
+                                  [](const auto &a, const auto &b) { return a.first == b.first; }),
+                      projections.end());
+
+    // 3) Make only the distinct projections disjoint
+    auto distinct = make_shared_event();
+    for (auto const &[encoding, projection] : projections) {
+        insert_without_loss(*distinct->simple_sets, projection);
+    }
+    auto result = distinct->make_disjoint();
+
+    // 4) Remember the result
+    {
+        std::lock_guard<std::mutex> lock(marginal_cache->mutex);
+        if (marginal_cache->source_version != simple_sets->version() ||
+            marginal_cache->entries.size() >= MarginalCache::MAX_ENTRIES) {
+            marginal_cache->entries.clear();
+            marginal_cache->source_version = simple_sets->version();
+        }
+        marginal_cache->entries[key] = result;
     }
-    return result->make_disjoint();
+    return copy_of(result);
 }
@@ -0,0 +1,353 @@
+#include "refinement.h"
+#include "interval.h"
+#include "set.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <tuple>
+
+//
+// ===============================
+//  —— Refiner ——
+// ===============================
+//
+
+namespace {
+
+/**
+ * State of one refinement.
+ *
+ * Partial results are interned, such that equal sub-refinements are detected by comparing ids:
+ * - A signature is the sorted list of events containing an atom.
+ * - A tail is the assignment of one variable (encoded as numbers) followed by the tail of the next variable. Tail 0 is
+ *   the empty tail behind the last variable.
+ * - A result is the sorted list of (tail, signature) pairs that refine a region of the remaining variables.
+ */
+struct Refiner {
+    std::vector<AbstractVariablePtr_t> variables;
+    std::vector<bool> is_symbolic;
+
+    /**
+     * For every symbolic variable, the sorted element indices of its domain.
+     */
+    std::vector<std::vector<int>> universes;
+
+    std::vector<const SimpleEvent *> boxes;
+    std::vector<std::uint32_t> labels;
+
+    using Result = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+    using Coverage = std::vector<std::uint32_t>;
+
+    std::map<Coverage, std::uint32_t> signature_ids;
+    std::vector<Coverage> signatures;
+
+    std::map<std::tuple<size_t, std::vector<double>, std::uint32_t>, std::uint32_t> tail_ids;
+    std::vector<std::pair<std::vector<double>, std::uint32_t>> tails;
+
+    std::map<Result, std::uint32_t> result_ids;
+    std::vector<Result> results;
+
+    /**
+     * Per variable, the results of the coverages seen so far.
+     */
+    std::vector<std::map<Coverage, std::uint32_t>> memo;
+
+    static std::uint32_t intern(std::map<Coverage, std::uint32_t> &ids, std::vector<Coverage> &values,
+                                Coverage &&value) {
+        auto [it, inserted] = ids.try_emplace(value, static_cast<std::uint32_t>(values.size()));
+        if (inserted) {
+            values.push_back(std::move(value));
+        }
+        return it->second;
+    }
+
+    std::uint32_t intern_result(Result &&result) {
+        std::sort(result.begin(), result.end());
+        auto [it, inserted] = result_ids.try_emplace(result, static_cast<std::uint32_t>(results.size()));
+        if (inserted) {
+            results.push_back(std::move(result));
+        }
+        return it->second;
+    }
+
+    std::uint32_t intern_tail(size_t depth, const std::vector<double> &assignment, std::uint32_t next) {
+        auto [it, inserted] = tail_ids.try_emplace({depth, assignment, next},
+                                                   static_cast<std::uint32_t>(tails.size()));
+        if (inserted) {
+            tails.emplace_back(assignment, next);
+        }
+        return it->second;
+    }
+
+    /**
+     * Cut the axis of an interval variable into elementary cells.
+     * With k distinct finite endpoints e_0 < ... < e_{k-1} there are 2k + 1 cells: cell 2i is the open gap in front of
+     * e_i, cell 2i + 1 is the point e_i and cell 2k is the open gap behind the last endpoint.
+     *
+     * @return The endpoints and for every cell the boxes covering it.
+     */
+    std::pair<std::vector<double>, std::vector<Coverage>> interval_cells(size_t depth, const Coverage &coverage) const {
+        std::vector<double> endpoints;
+        for (auto box : coverage) {
+            auto assignment = boxes[box]->variable_map->find(variables[depth]);
+            if (assignment == boxes[box]->variable_map->end()) {
+                continue;
+            }
+            for (auto const &simple_set : *assignment->second->simple_sets) {
+                auto simple_interval = static_cast<SimpleInterval *>(simple_set.get());
+                if (std::isfinite(simple_interval->lower)) {
+                    endpoints.push_back(simple_interval->lower);
+                }
+                if (std::isfinite(simple_interval->upper)) {
+                    endpoints.push_back(simple_interval->upper);
+                }
+            }
+        }
+        std::sort(endpoints.begin(), endpoints.end());
+        endpoints.erase(std::unique(endpoints.begin(), endpoints.end()), endpoints.end());
+
+        auto index_of = [&endpoints](double value) {
+            return static_cast<size_t>(std::lower_bound(endpoints.begin(), endpoints.end(), value) - endpoints.begin());
+        };
+
+        const size_t last_cell = 2 * endpoints.size();
+        std::vector<Coverage> cells(last_cell + 1);
+        for (auto box : coverage) {
+            auto assignment = boxes[box]->variable_map->find(variables[depth]);
+            if (assignment == boxes[box]->variable_map->end()) {
+                for (auto &cell : cells) {
+                    cell.push_back(box);
+                }
+                continue;
+            }
+            for (auto const &simple_set : *assignment->second->simple_sets) {
+                auto simple_interval = static_cast<SimpleInterval *>(simple_set.get());
+                size_t first = 0;
+                if (std::isfinite(simple_interval->lower)) {
+                    first = 2 * index_of(simple_interval->lower) + (simple_interval->left == BorderType::CLOSED ? 1 : 2);
+                }
+                size_t last = last_cell;
+                if (std::isfinite(simple_interval->upper)) {
+                    last = 2 * index_of(simple_interval->upper) + (simple_interval->right == BorderType::CLOSED ? 1 : 0);
+                }
+                for (size_t cell = first; cell <= last && cell <= last_cell; ++cell) {
+                    cells[cell].push_back(box);
+                }
+            }
+        }
+        return {std::move(endpoints), std::move(cells)};
+    }
+
+    /**
+     * Encode a sorted list of interval cells as maximal simple intervals (lower, upper, left closed, right closed).
+     */
+    static std::vector<double> encode_interval_cells(const std::vector<double> &endpoints,
+                                                     const std::vector<size_t> &cells) {
+        const double infinity = std::numeric_limits<double>::infinity();
+        std::vector<double> encoding;
+        for (size_t k = 0; k < cells.size();) {
+            size_t run_end = k;
+            while (run_end + 1 < cells.size() && cells[run_end + 1] == cells[run_end] + 1) {
+                ++run_end;
+            }
+            const size_t first = cells[k];
+            const size_t last = cells[run_end];
+
+            const bool first_is_point = first % 2 == 1;
+            const double lower = first_is_point ? endpoints[first / 2] : (first == 0 ? -infinity : endpoints[first / 2 - 1]);
+            const bool last_is_point = last % 2 == 1;
+            const double upper = last_is_point ? endpoints[last / 2] :
+                                 (last / 2 == endpoints.size() ? infinity : endpoints[last / 2]);
+            encoding.insert(encoding.end(), {lower, upper, first_is_point ? 1. : 0., last_is_point ? 1. : 0.});
+            k = run_end + 1;
+        }
+        return encoding;
+    }
+
+    /**
+     * Split the domain of a symbolic variable into its elements.
+     *
+     * @return For every element of the universe the boxes covering it.
+     */
+    std::vector<Coverage> symbolic_cells(size_t depth, const Coverage &coverage) const {
+        const auto &universe = universes[depth];
+        std::vector<Coverage> cells(universe.size());
+        for (auto box : coverage) {
+            auto assignment = boxes[box]->variable_map->find(variables[depth]);
+            if (assignment == boxes[box]->variable_map->end()) {
+                for (auto &cell : cells) {
+                    cell.push_back(box);
+                }
+                continue;
+            }
+            for (auto const &simple_set : *assignment->second->simple_sets) {
+                auto element = static_cast<SetElement *>(simple_set.get())->element_index;
+                auto position = std::lower_bound(universe.begin(), universe.end(), element);
+                if (position != universe.end() && *position == element) {
+                    cells[position - universe.begin()].push_back(box);
+                }
+            }
+        }
+        return cells;
+    }
+
+    /**
+     * Refine the region of the remaining variables [depth, ...) that is covered by some boxes.
+     *
+     * @return The id of the result.
+     */
+    std::uint32_t refine(size_t depth, const Coverage &coverage) {
+        auto cached = memo[depth].find(coverage);
+        if (cached != memo[depth].end()) {
+            return cached->second;
+        }
+
+        std::uint32_t result_id;
+        if (depth == variables.size()) {
+            // 1) Every covering box contains the whole remaining region
+            Coverage signature;
+            for (auto box : coverage) {
+                signature.push_back(labels[box]);
+            }
+            signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+            result_id = intern_result({{0, intern(signature_ids, signatures, std::move(signature))}});
+        } else {
+            // 1) Cut the axis into elementary cells
+            std::vector<double> endpoints;
+            std::vector<Coverage> cells;
+            if (is_symbolic[depth]) {
+                cells = symbolic_cells(depth, coverage);
+            } else {
+                std::tie(endpoints, cells) = interval_cells(depth, coverage);
+            }
+
+            // 2) Refine the remaining variables per cell and group the cells with equal refinements
+            std::map<std::uint32_t, std::vector<size_t>> groups;
+            for (size_t cell = 0; cell < cells.size(); ++cell) {
+                groups[refine(depth + 1, cells[cell])].push_back(cell);
+            }
+
+            // 3) Prepend the merged cells of every group to the tails of its refinement
+            Result result;
+            for (auto const &[child, group] : groups) {
+                std::vector<double> encoding;
+                if (is_symbolic[depth]) {
+                    for (auto cell : group) {
+                        encoding.push_back(universes[depth][cell]);
+                    }
+                } else {
+                    encoding = encode_interval_cells(endpoints, group);
+                }
+                auto child_result = results[child];
+                for (auto const &[tail, signature] : child_result) {
+                    result.emplace_back(intern_tail(depth, encoding, tail), signature);
+                }
+            }
+            result_id = intern_result(std::move(result));
+        }
+
+        memo[depth].emplace(coverage, result_id);
+        return result_id;
+    }
+
+    /**
+     * Decode the assignment of a variable.
+     */
+    AbstractCompositeSetPtr_t decode(size_t depth, const std::vector<double> &encoding) const {
+        if (is_symbolic[depth]) {
+            auto all_elements = static_cast<Symbolic *>(variables[depth].get())->domain->all_elements;
+            auto elements = make_shared_simple_set_set();
+            for (auto element : encoding) {
+                elements->insert(make_shared_set_element(static_cast<int>(element), all_elements));
+            }
+            return make_shared_set(elements, all_elements);
+        }
+        auto simple_intervals = make_shared_simple_set_set();
+        for (size_t k = 0; k < encoding.size(); k += 4) {
+            simple_intervals->insert(SimpleInterval::make_shared(
+                    encoding[k], encoding[k + 1],
+                    encoding[k + 2] == 1. ? BorderType::CLOSED : BorderType::OPEN,
+                    encoding[k + 3] == 1. ? BorderType::CLOSED : BorderType::OPEN));
+        }
+        return Interval::make_shared(simple_intervals);
+    }
+};
+
+}
+
+std::vector<RefinementAtom> common_refinement(const std::vector<EventPtr_t> &events, bool include_outside) {
+    Refiner refiner;
+
+    // 1) Variables of all events, name ordered
+    VariableSet all_variables;
+    for (auto const &event : events) {
+        auto event_variables = event->get_variables_from_simple_events();
+        all_variables.insert(event_variables.begin(), event_variables.end());
+    }
+    if (all_variables.empty()) {
+        return {};
+    }
+    for (auto const &variable : all_variables) {
+        refiner.variables.push_back(variable);
+        auto symbolic = dynamic_cast<Symbolic *>(variable.get());
+        refiner.is_symbolic.push_back(symbolic != nullptr);
+        std::vector<int> universe;
+        if (symbolic != nullptr) {
+            for (auto const &element : *symbolic->domain->simple_sets) {
+                universe.push_back(static_cast<SetElement *>(element.get())->element_index);
+            }
+            std::sort(universe.begin(), universe.end());
+        }
+        refiner.universes.push_back(std::move(universe));
+    }
+    refiner.memo.resize(refiner.variables.size() + 1);
+    refiner.tails.emplace_back();
+
+    // 2) Collect the non-empty simple events, labeled with their event
+    for (std::uint32_t label = 0; label < events.size(); ++label) {
+        for (auto const &simple_set : *events[label]->simple_sets) {
+            if (!simple_set->is_empty()) {
+                refiner.boxes.push_back(static_cast<SimpleEvent *>(simple_set.get()));
+                refiner.labels.push_back(label);
+            }
+        }
+    }
+
+    // 3) Refine the whole space
+    Refiner::Coverage all_boxes(refiner.boxes.size());
+    for (std::uint32_t box = 0; box < all_boxes.size(); ++box) {
+        all_boxes[box] = box;
+    }
+    auto root = refiner.results[refiner.refine(0, all_boxes)];
+
+    // 4) Materialize the tails and gather them per signature
+    std::map<std::vector<bool>, std::vector<AbstractSimpleSetPtr_t>> atoms;
+    for (auto const &[tail, signature_id] : root) {
+        const auto &labels = refiner.signatures[signature_id];
+        if (labels.empty() && !include_outside) {
+            continue;
+        }
+        std::vector<bool> signature(events.size(), false);
+        for (auto label : labels) {
+            signature[label] = true;
+        }
+
+        auto variable_map = std::make_shared<VariableMap>();
+        auto current = tail;
+        for (size_t depth = 0; depth < refiner.variables.size(); ++depth) {
+            variable_map->insert({refiner.variables[depth], refiner.decode(depth, refiner.tails[current].first)});
+            current = refiner.tails[current].second;
+        }
+
+        atoms[signature].push_back(make_shared_simple_event(variable_map));
+    }
+
+    std::vector<RefinementAtom> result;
+    result.reserve(atoms.size());
+    for (auto &[signature, simple_events] : atoms) {
+        result.push_back({signature, make_shared_event(make_shared_simple_set_set(simple_events.begin(),
+                                                                                  simple_events.end()))});
+    }
+    return result;
+}
@@ -0,0 +1,532 @@
+#include "serialization.h"
+#include "interval.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+// Helper: The header of every stream.
+static constexpr char MAGIC[] = {'R', 'E', 'V'};
+static constexpr std::uint64_t FORMAT_VERSION = 1;
+
+// Helper: Flags of a composite set record.
+static constexpr std::uint64_t KNOWN_DISJOINT = 1;
+
+// Helper: The kinds of variables in a variable definition.
+enum class VariableKind : std::uint64_t {
+    CONTINUOUS = 0,
+    INTEGER = 1,
+    SYMBOLIC = 2
+};
+
+// Helper: How an endpoint of a simple interval is stored; two bits per endpoint in the header byte of the interval.
+enum EndpointMode : std::uint8_t {
+    RAW = 0,
+    DELTA = 1,
+    NEGATIVE_INFINITY = 2,
+    POSITIVE_INFINITY = 3
+};
+
+// Helper: Endpoints with an absolute value up to 2^53 that are integral are exact as int64 and delta encoded.
+static EndpointMode endpoint_mode(double value) {
+    if (std::isinf(value)) {
+        return value < 0 ? NEGATIVE_INFINITY : POSITIVE_INFINITY;
+    }
+    // -0. is not integral here, hence it survives a round trip
+    bool integral = value == std::trunc(value) && std::fabs(value) <= 9007199254740992. &&
+                    !(value == 0 && std::signbit(value));
+    return integral ? DELTA : RAW;
+}
+
+//
+// ===============================
+//  —— Serializer ——
+// ===============================
+//
+
+Serializer::Serializer(std::ostream &stream_) : stream(stream_) {
+    stream.write(MAGIC, sizeof(MAGIC));
+    write_varint(FORMAT_VERSION);
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void Serializer::write_varint(std::uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+void Serializer::write_signed(std::int64_t value) {
+    // zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+    write_varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void Serializer::write_double(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int byte = 0; byte < 8; ++byte) {
+        buffer.push_back(static_cast<char>(bits >> (8 * byte)));
+    }
+}
+
+void Serializer::write_string(const std::string &value) {
+    write_varint(value.size());
+    buffer.append(value);
+}
+
+void Serializer::write_universe(const AllSetElementsPtr_t &universe) {
+    auto known = universe_ids.find(universe);
+    if (known != universe_ids.end()) {
+        write_varint(known->second);
+        return;
+    }
+
+    // A new universe: its id followed by its sorted elements, delta encoded
+    size_t id = universe_ids.size();
+    universe_ids[universe] = id;
+    write_varint(id);
+    write_varint(universe->size());
+    std::uint64_t previous = 0;
+    bool first = true;
+    for (auto element : *universe) {
+        if (first) {
+            write_signed(element);
+            first = false;
+        } else {
+            write_varint(static_cast<std::uint64_t>(element) - previous);
+        }
+        previous = static_cast<std::uint64_t>(element);
+    }
+}
+
+void Serializer::write_variable(const AbstractVariablePtr_t &variable) {
+    auto known = variable_ids.find(variable);
+    if (known != variable_ids.end()) {
+        write_varint(known->second);
+        return;
+    }
+
+    // A new variable: its id followed by its kind, name and, for symbolic variables, domain
+    size_t id = variable_ids.size();
+    variable_ids[variable] = id;
+    write_varint(id);
+    if (auto symbolic = std::dynamic_pointer_cast<Symbolic>(variable)) {
+        write_varint(static_cast<std::uint64_t>(VariableKind::SYMBOLIC));
+        write_string(*variable->name);
+        write_set(*symbolic->domain);
+    } else {
+        bool integer = std::dynamic_pointer_cast<Integer>(variable) != nullptr;
+        write_varint(static_cast<std::uint64_t>(integer ? VariableKind::INTEGER : VariableKind::CONTINUOUS));
+        write_string(*variable->name);
+    }
+}
+
+void Serializer::write_interval(const AbstractCompositeSet &interval) {
+    write_varint(interval.simple_sets->size());
+    double previous = 0;
+    for (auto const &simple_set : *interval.simple_sets) {
+        auto const &simple_interval = static_cast<const SimpleInterval &>(*simple_set);
+        auto lower = endpoint_mode(simple_interval.lower);
+        auto upper = endpoint_mode(simple_interval.upper);
+        buffer.push_back(static_cast<char>(lower | (upper << 2) |
+                                           ((simple_interval.left == BorderType::CLOSED) << 4) |
+                                           ((simple_interval.right == BorderType::CLOSED) << 5)));
+        for (auto [mode, value] : {std::make_pair(lower, simple_interval.lower),
+                                   std::make_pair(upper, simple_interval.upper)}) {
+            if (mode == DELTA) {
+                write_signed(static_cast<std::int64_t>(value) - static_cast<std::int64_t>(previous));
+                previous = value;
+            } else if (mode == RAW) {
+                write_double(value);
+            }
+        }
+    }
+}
+
+void Serializer::write_set(const Set &set) {
+    write_universe(set.all_elements);
+    std::vector<int> indices;
+    for (auto const &simple_set : *set.simple_sets) {
+        auto const &element = static_cast<const SetElement &>(*simple_set);
+        if (element.element_index >= 0) {
+            indices.push_back(element.element_index);
+        }
+    }
+    write_varint(indices.size());
+    int previous = 0;
+    for (auto index : indices) {
+        write_signed(index - previous);
+        previous = index;
+    }
+}
+
+void Serializer::write_simple_event(const SimpleEvent &simple_event) {
+    write_varint(simple_event.variable_map->size());
+    for (auto const &[variable, assignment] : *simple_event.variable_map) {
+        write_variable(variable);
+        if (std::dynamic_pointer_cast<Symbolic>(variable) != nullptr) {
+            write_set(static_cast<const Set &>(*assignment));
+        } else {
+            write_interval(*assignment);
+        }
+    }
+}
+
+void Serializer::flush(RecordKind kind) {
+    // 1) The kind and the length of the payload
+    char header[11];
+    size_t size = 0;
+    header[size++] = static_cast<char>(kind);
+    for (std::uint64_t length = buffer.size(); ; length >>= 7) {
+        header[size++] = static_cast<char>((length & 0x7F) | (length >= 0x80 ? 0x80 : 0));
+        if (length < 0x80) {
+            break;
+        }
+    }
+
+    // 2) The payload in one go
+    stream.write(header, static_cast<std::streamsize>(size));
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void Serializer::write(const AbstractCompositeSetPtr_t &set) {
+    auto event = std::dynamic_pointer_cast<Event>(set);
+    auto discrete = std::dynamic_pointer_cast<Set>(set);
+    if (event == nullptr && discrete == nullptr && std::dynamic_pointer_cast<Interval>(set) == nullptr) {
+        throw std::invalid_argument("Only intervals, sets and events can be serialized.");
+    }
+
+    write_varint(set->is_known_disjoint() ? KNOWN_DISJOINT : 0);
+    if (event != nullptr) {
+        write_varint(event->simple_sets->size());
+        for (auto const &simple_event : *event->simple_sets) {
+            write_simple_event(static_cast<const SimpleEvent &>(*simple_event));
+        }
+        flush(RecordKind::EVENT);
+    } else if (discrete != nullptr) {
+        write_set(*discrete);
+        flush(RecordKind::SET);
+    } else {
+        write_interval(*set);
+        flush(RecordKind::INTERVAL);
+    }
+}
+
+void Serializer::write(const SimpleEventPtr_t &simple_event) {
+    write_simple_event(*simple_event);
+    flush(RecordKind::SIMPLE_EVENT);
+}
+
+void Serializer::write(const VariableSetPtr_t &variables) {
+    write_varint(variables->size());
+    for (auto const &variable : *variables) {
+        write_variable(variable);
+    }
+    flush(RecordKind::VARIABLES);
+}
+
+//
+// ===============================
+//  —— Deserializer ——
+// ===============================
+//
+
+Deserializer::Deserializer(std::istream &stream_) : stream(stream_) {
+    char magic[sizeof(MAGIC)];
+    if (!stream.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC)) {
+        throw std::invalid_argument("The data is not in the binary format of random events.");
+    }
+
+    // The version is read from the stream byte by byte since there is no record yet
+    std::uint64_t version = 0;
+    for (int shift = 0;; shift += 7) {
+        int byte = stream.get();
+        if (byte == std::char_traits<char>::eof() || shift > 63) {
+            throw std::invalid_argument("The header is truncated.");
+        }
+        version |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if (version == 0 || version > FORMAT_VERSION) {
+        throw std::invalid_argument("The format version " + std::to_string(version) + " is not supported.");
+    }
+}
+
+std::uint64_t Deserializer::read_varint() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (position == buffer.size()) {
+            throw std::invalid_argument("The record is truncated.");
+        }
+        auto byte = static_cast<std::uint8_t>(buffer[position++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::invalid_argument("The record contains a malformed varint.");
+}
+
+std::int64_t Deserializer::read_signed() {
+    auto value = read_varint();
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+double Deserializer::read_double() {
+    if (buffer.size() - position < 8) {
+        throw std::invalid_argument("The record is truncated.");
+    }
+    std::uint64_t bits = 0;
+    for (int byte = 0; byte < 8; ++byte) {
+        bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(buffer[position++])) << (8 * byte);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string Deserializer::read_string() {
+    auto size = read_varint();
+    if (buffer.size() - position < size) {
+        throw std::invalid_argument("The record is truncated.");
+    }
+    std::string value = buffer.substr(position, size);
+    position += size;
+    return value;
+}
+
+AllSetElementsPtr_t Deserializer::read_universe() {
+    auto id = read_varint();
+    if (id < universes.size()) {
+        return universes[id];
+    }
+    if (id > universes.size()) {
+        throw std::invalid_argument("The record references an unknown universe.");
+    }
+
+    auto universe = make_shared_all_elements();
+    auto size = read_varint();
+    std::uint64_t previous = 0;
+    for (std::uint64_t k = 0; k < size; ++k) {
+        previous = k == 0 ? static_cast<std::uint64_t>(read_signed()) : previous + read_varint();
+        universe->insert(universe->end(), static_cast<long long>(previous));
+    }
+    if (universe->size() != size) {
+        throw std::invalid_argument("The record contains a malformed universe.");
+    }
+    universes.push_back(universe);
+    return universe;
+}
+
+AbstractVariablePtr_t Deserializer::read_variable() {
+    auto id = read_varint();
+    if (id < variables.size()) {
+        return variables[id];
+    }
+    if (id > variables.size()) {
+        throw std::invalid_argument("The record references an unknown variable.");
+    }
+
+    AbstractVariablePtr_t variable;
+    auto kind = static_cast<VariableKind>(read_varint());
+    auto name = std::make_shared<std::string>(read_string());
+    switch (kind) {
+        case VariableKind::CONTINUOUS:
+            variable = make_shared_continuous(name);
+            break;
+        case VariableKind::INTEGER:
+            variable = make_shared_integer(name);
+            break;
+        case VariableKind::SYMBOLIC:
+            variable = make_shared_symbolic(name, read_set_payload());
+            break;
+        default:
+            throw std::invalid_argument("The record contains an unknown kind of variable.");
+    }
+    variables.push_back(variable);
+    return variable;
+}
+
+IntervalPtr_t Deserializer::read_interval() {
+    auto size = read_varint();
+    std::vector<AbstractSimpleSetPtr_t> simple_intervals;
+    double previous = 0;
+    for (std::uint64_t k = 0; k < size; ++k) {
+        if (position == buffer.size()) {
+            throw std::invalid_argument("The record is truncated.");
+        }
+        auto header = static_cast<std::uint8_t>(buffer[position++]);
+        double endpoints[2];
+        for (int endpoint = 0; endpoint < 2; ++endpoint) {
+            switch (static_cast<EndpointMode>((header >> (2 * endpoint)) & 3)) {
+                case RAW:
+                    endpoints[endpoint] = read_double();
+                    break;
+                case DELTA:
+                    endpoints[endpoint] = previous = static_cast<double>(static_cast<std::int64_t>(previous) +
+                                                                         read_signed());
+                    break;
+                case NEGATIVE_INFINITY:
+                    endpoints[endpoint] = -std::numeric_limits<double>::infinity();
+                    break;
+                case POSITIVE_INFINITY:
+                    endpoints[endpoint] = std::numeric_limits<double>::infinity();
+                    break;
+            }
+        }
+        simple_intervals.push_back(SimpleInterval::make_shared(
+                endpoints[0], endpoints[1], (header & (1 << 4)) ? BorderType::CLOSED : BorderType::OPEN,
+                (header & (1 << 5)) ? BorderType::CLOSED : BorderType::OPEN));
+    }
+    return Interval::make_shared(make_shared_simple_set_set(simple_intervals.begin(), simple_intervals.end()));
+}
+
+SetPtr_t Deserializer::read_set_payload() {
+    auto universe = read_universe();
+    auto size = read_varint();
+    std::vector<AbstractSimpleSetPtr_t> elements;
+    std::int64_t index = 0;
+    for (std::uint64_t k = 0; k < size; ++k) {
+        index += read_signed();
+        if (index < 0 || index >= static_cast<std::int64_t>(universe->size())) {
+            throw std::invalid_argument("The record contains an element outside of its universe.");
+        }
+        elements.push_back(make_shared_set_element(static_cast<int>(index), universe));
+    }
+    return make_shared_set(make_shared_simple_set_set(elements.begin(), elements.end()), universe);
+}
+
+SimpleEventPtr_t Deserializer::read_simple_event_payload() {
+    auto size = read_varint();
+    auto variable_map = std::make_shared<VariableMap>();
+    for (std::uint64_t k = 0; k < size; ++k) {
+        auto variable = read_variable();
+        if (std::dynamic_pointer_cast<Symbolic>(variable) != nullptr) {
+            variable_map->insert({variable, read_set_payload()});
+        } else {
+            variable_map->insert({variable, read_interval()});
+        }
+    }
+    return make_shared_simple_event(variable_map);
+}
+
+bool Deserializer::at_end() {
+    return stream.peek() == std::char_traits<char>::eof();
+}
+
+RecordKind Deserializer::next_kind() {
+    int kind = stream.peek();
+    if (kind == std::char_traits<char>::eof()) {
+        throw std::invalid_argument("The stream has no records left.");
+    }
+    if (kind > static_cast<int>(RecordKind::VARIABLES)) {
+        throw std::invalid_argument("The stream contains an unknown kind of record.");
+    }
+    return static_cast<RecordKind>(kind);
+}
+
+RecordKind Deserializer::load(std::initializer_list<RecordKind> expected) {
+    // 1) The kind and the length of the payload
+    auto kind = next_kind();
+    if (std::find(expected.begin(), expected.end(), kind) == expected.end()) {
+        throw std::invalid_argument("The next record is of another kind.");
+    }
+    stream.get();
+    std::uint64_t size = 0;
+    for (int shift = 0;; shift += 7) {
+        int byte = stream.get();
+        if (byte == std::char_traits<char>::eof() || shift > 63) {
+            throw std::invalid_argument("The record is truncated.");
+        }
+        size |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    // 2) The payload in chunks, such that a corrupt length cannot allocate more than the stream actually holds
+    constexpr std::uint64_t CHUNK = 1 << 20;
+    buffer.clear();
+    position = 0;
+    while (buffer.size() < size) {
+        auto offset = buffer.size();
+        auto chunk = std::min<std::uint64_t>(CHUNK, size - offset);
+        buffer.resize(offset + chunk);
+        if (!stream.read(&buffer[offset], static_cast<std::streamsize>(chunk))) {
+            throw std::invalid_argument("The record is truncated.");
+        }
+    }
+    return kind;
+}
+
+void Deserializer::finish() const {
+    if (position != buffer.size()) {
+        throw std::invalid_argument("The record has trailing bytes.");
+    }
+}
+
+AbstractCompositeSetPtr_t Deserializer::read_set() {
+    auto kind = load({RecordKind::INTERVAL, RecordKind::SET, RecordKind::EVENT});
+    auto flags = read_varint();
+    AbstractCompositeSetPtr_t result;
+    if (kind == RecordKind::EVENT) {
+        auto size = read_varint();
+        std::vector<AbstractSimpleSetPtr_t> simple_events;
+        for (std::uint64_t k = 0; k < size; ++k) {
+            simple_events.push_back(read_simple_event_payload());
+        }
+        result = make_shared_event(make_shared_simple_set_set(simple_events.begin(), simple_events.end()));
+    } else if (kind == RecordKind::SET) {
+        result = read_set_payload();
+    } else {
+        result = read_interval();
+    }
+    finish();
+    if (flags & KNOWN_DISJOINT) {
+        result->mark_disjoint();
+    }
+    return result;
+}
+
+SimpleEventPtr_t Deserializer::read_simple_event() {
+    load({RecordKind::SIMPLE_EVENT});
+    auto simple_event = read_simple_event_payload();
+    finish();
+    return simple_event;
+}
+
+VariableSetPtr_t Deserializer::read_variables() {
+    load({RecordKind::VARIABLES});
+    auto result = make_shared_variable_set();
+    auto size = read_varint();
+    for (std::uint64_t k = 0; k < size; ++k) {
+        result->insert(read_variable());
+    }
+    finish();
+    return result;
+}
+
+//
+// ===============================
+//  —— Byte strings ——
+// ===============================
+//
+
+std::string serialize(const AbstractCompositeSetPtr_t &set) {
+    std::ostringstream stream(std::ios::binary);
+    Serializer(stream).write(set);
+    return stream.str();
+}
+
+AbstractCompositeSetPtr_t deserialize(const std::string &data) {
+    std::istringstream stream(data, std::ios::binary);
+    return Deserializer(stream).read_set();
+}
@@ -89,6 +89,36 @@ SimpleSetSetPtr_t SetElement::complement() {
     return result;
 }
 
+SimpleSetSetPtr_t SetElement::difference_with(const AbstractSimpleSetPtr_t &other) {
+    // A single element minus another single element is either nothing or the element itself, so we
+    // skip the generic intersection + complement (which would build all N−1 other elements).
+    auto result = make_shared_simple_set_set();
+    const auto derived_other = static_cast<SetElement *>(other.get());
+    if (!is_empty() && element_index != derived_other->element_index) {
+        result->insert(share_more());
+    }
+    return result;
+}
+
+bool SetElement::is_subset_of(const AbstractSimpleSetPtr_t &other) {
+    const auto derived_other = static_cast<SetElement *>(other.get());
+    return is_empty() || element_index == derived_other->element_index;
+}
+
+bool SetElement::intersects(const AbstractSimpleSetPtr_t &other) {
+    const auto derived_other = static_cast<SetElement *>(other.get());
+    return !is_empty() && element_index == derived_other->element_index;
+}
+
+std::uint64_t SetElement::fingerprint() const {
+    return combine_fingerprints(0, static_cast<std::uint64_t>(element_index));
+}
+
+size_t SetElement::memory_usage() const {
+    // The elements of the universe are shared by every element of it
+    return sizeof(SetElement);
+}
+
 bool SetElement::contains(const ElementaryVariant * /*element*/) {
     // Original always returned false, which is logically incorrect:
     //   “A single‐index SetElement only contains itself if we pass a matching pointer.”
@@ -164,9 +194,8 @@ Set::Set(const SimpleSetSetPtr_t &elements_, const AllSetElementsPtr_t &all_elem
 }
 
 Set::~Set() {
-    // Clearing an std::set is O(M).  We can simply let the shared_ptr go out of scope
-    // (default destructor does that).  But to match original semantics we call clear().
-    this->simple_sets->clear();
+    // The simple sets may still be shared with other sets, so they are released with the shared_ptr instead of being
+    // cleared.
 }
 
 AbstractCompositeSetPtr_t Set::make_new_empty() const {
@@ -174,10 +203,69 @@ AbstractCompositeSetPtr_t Set::make_new_empty() const {
     return std::make_shared<Set>(all_elements);
 }
 
+size_t Set::remove_dominated_simple_sets() {
+    return 0;
+}
+
+// Helper: The index of the set element a simple set points to.
+static int element_index_of(const AbstractSimpleSetPtr_t &simple_set) {
+    return static_cast<SetElement *>(simple_set.get())->element_index;
+}
+
+bool Set::intersects(const AbstractCompositeSetPtr_t &other) {
+    // Both sets are ordered by element index; empty elements (index < 0) come first and match nothing.
+    auto it = simple_sets->begin();
+    auto other_it = other->simple_sets->begin();
+    while (it != simple_sets->end() && other_it != other->simple_sets->end()) {
+        const int index = element_index_of(*it);
+        const int other_index = element_index_of(*other_it);
+        if (index < other_index) {
+            ++it;
+        } else if (other_index < index) {
+            ++other_it;
+        } else if (index >= 0) {
+            return true;
+        } else {
+            ++it;
+            ++other_it;
+        }
+    }
+    return false;
+}
+
+bool Set::is_subset_of(const AbstractCompositeSetPtr_t &other) {
+    auto other_it = other->simple_sets->begin();
+    for (auto const &simple_set : *simple_sets) {
+        const int index = element_index_of(simple_set);
+        if (index < 0) {
+            continue;
+        }
+        while (other_it != other->simple_sets->end() && element_index_of(*other_it) < index) {
+            ++other_it;
+        }
+        if (other_it == other->simple_sets->end() || element_index_of(*other_it) != index) {
+            return false;
+        }
+    }
+    return true;
+}
+
 AbstractCompositeSetPtr_t Set::simplify() {
     // “Simplify” used to reinsert every pointer.  We do exactly the same bulk‐insert at once,
     // so we have only *one* insert operation per element, instead of a loop of M calls.
-    return std::make_shared<Set>(simple_sets, all_elements);
+    // Set elements are disjoint by definition
+    auto result = std::make_shared<Set>(simple_sets, all_elements);
+    result->mark_simplified();
+    return result;
+}
+
+bool Set::contains(int element_index) const {
+    for (auto const &simple_set : *simple_sets) {
+        if (static_cast<SetElement *>(simple_set.get())->element_index == element_index) {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::string *Set::to_string() {
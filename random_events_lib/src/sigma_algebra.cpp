@@ -1,4 +1,7 @@
 #include "sigma_algebra.h"
+#include "parallel.h"
+#include "cancellation.h"
+#include "generator.h"
 #include <algorithm>
 #include <stdexcept>
 #include <iterator>
@@ -74,52 +77,292 @@ std::string *AbstractSimpleSet::to_string() {
 }
 
 
+bool AbstractSimpleSet::is_subset_of(const AbstractSimpleSetPtr_t &other) {
+    if (is_empty()) {
+        return true;
+    }
+    auto remainder = difference_with(other);
+    for (auto const &piece : *remainder) {
+        if (!piece->is_empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AbstractSimpleSet::intersects(const AbstractSimpleSetPtr_t &other) {
+    return !intersection_with(other)->is_empty();
+}
+
+bool AbstractSimpleSet::is_disjoint_from(const AbstractSimpleSetPtr_t &other) {
+    return !intersects(other);
+}
+
+std::uint64_t AbstractSimpleSet::fingerprint() const {
+    return 0;
+}
+
+PieceGeneratorPtr_t AbstractSimpleSet::complement_pieces() {
+    return generate_pieces(complement());
+}
+
+size_t AbstractSimpleSet::memory_usage() const {
+    return sizeof(AbstractSimpleSet);
+}
+
 bool AbstractSimpleSet::operator!=(const AbstractSimpleSet &other) {
     return !(*this == other);
 }
 
 
+// =============================================================
+//  —— OperationStatistics ——
+// =============================================================
+//
+
+void OperationStatistics::reset() {
+    union_calls = 0;
+    union_inputs = 0;
+    dominated_removed = 0;
+    hull_fast_paths = 0;
+}
+
+OperationStatistics &operation_statistics() {
+    static OperationStatistics statistics;
+    return statistics;
+}
+
+// Helper: Record that an operation was answered by comparing the hulls of its operands.
+static void record_hull_fast_path() {
+    operation_statistics().hull_fast_paths += 1;
+}
+
+// Helper: Check if a predicate holds for any simple set of 'composite' that may overlap 'simple_set'.
+//   Stops at the first simple set that satisfies the predicate.
+template<typename Predicate>
+static bool any_overlap_candidate(const AbstractCompositeSet &composite, const AbstractSimpleSetPtr_t &simple_set,
+                                  Predicate &&predicate) {
+    if (auto candidates = composite.overlap_candidates(simple_set)) {
+        return std::any_of(candidates->begin(), candidates->end(), predicate);
+    }
+    return std::any_of(composite.simple_sets->begin(), composite.simple_sets->end(), predicate);
+}
+
+// Helper: Run the dominance pruning of a union and record it.
+static void prune_dominated(AbstractCompositeSet &result) {
+    auto &statistics = operation_statistics();
+    statistics.union_calls += 1;
+    statistics.union_inputs += result.simple_sets->size();
+    statistics.dominated_removed += result.remove_dominated_simple_sets();
+}
+
+// Helper: Copy a composite set, such that results of operations never alias their operands.
+//   The simple sets are shared, they are never modified.
+static AbstractCompositeSetPtr_t copy_of(const AbstractCompositeSet &composite) {
+    auto result = composite.make_new_empty();
+    *result->simple_sets = *composite.simple_sets;
+    if (composite.is_known_disjoint()) {
+        result->mark_disjoint();
+    }
+    return result;
+}
+
+
 // =============================================================
 //  —— AbstractCompositeSet (composite of "atomic" SimpleSets) ——
 // =============================================================
 //
 
+size_t AbstractCompositeSet::remove_dominated_simple_sets() {
+    if (simple_sets->size() < 2) {
+        return 0;
+    }
+
+    // Test every simple set against all simple sets that are still kept, in iteration order.  Of two equal simple
+    // sets, the first one is dropped and the second one is kept.
+    auto const &candidates = *simple_sets;
+    std::vector<bool> removed(candidates.size(), false);
+    size_t removed_count = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        for (size_t j = 0; j < candidates.size(); ++j) {
+            if (i != j && !removed[j] && candidates[i]->is_subset_of(candidates[j])) {
+                removed[i] = true;
+                ++removed_count;
+                break;
+            }
+        }
+    }
+    if (removed_count == 0) {
+        return 0;
+    }
+
+    // The kept simple sets are already in order, hence rebuilding only appends
+    SimpleSetSet_t kept;
+    kept.reserve(candidates.size() - removed_count);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!removed[i]) {
+            kept.insert(candidates[i]);
+        }
+    }
+    simple_sets->swap(kept);
+    return removed_count;
+}
+
+AbstractCompositeSet::Invariants &AbstractCompositeSet::current_invariants() const {
+    if (invariants.source_version != simple_sets->version()) {
+        invariants = Invariants();
+        invariants.source_version = simple_sets->version();
+    }
+    return invariants;
+}
+
+void AbstractCompositeSet::drop_invariants() const {
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    invariants = Invariants();
+}
+
+bool AbstractCompositeSet::is_known_disjoint() const {
+    if (simple_sets->size() < 2) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    return current_invariants().disjoint.value_or(false);
+}
+
+bool AbstractCompositeSet::is_known_simplified() const {
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    return current_invariants().simplified;
+}
+
+void AbstractCompositeSet::mark_disjoint() const {
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    current_invariants().disjoint = true;
+}
+
+void AbstractCompositeSet::mark_simplified() const {
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    auto &current = current_invariants();
+    current.disjoint = true;
+    current.simplified = true;
+}
+
+AbstractSimpleSetPtr_t AbstractCompositeSet::get_hull() const {
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        auto const &current = current_invariants();
+        if (current.hull_computed) {
+            return current.hull;
+        }
+    }
+
+    // The hull is computed without holding the lock; concurrent callers compute equal hulls and the first one is kept
+    auto hull = simple_sets->empty() ? nullptr : compute_hull();
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    auto &current = current_invariants();
+    if (!current.hull_computed) {
+        current.hull = hull;
+        current.hull_computed = true;
+    }
+    return current.hull;
+}
+
+AbstractSimpleSetPtr_t AbstractCompositeSet::compute_hull() const {
+    return nullptr;
+}
+
+bool AbstractCompositeSet::may_overlap(const AbstractCompositeSet &other) const {
+    if (simple_sets->empty() || other.simple_sets->empty()) {
+        return false;
+    }
+    auto hull = get_hull();
+    auto other_hull = other.get_hull();
+    if (hull == nullptr || other_hull == nullptr) {
+        return true;
+    }
+    return hull->intersects(other_hull);
+}
+
+bool AbstractCompositeSet::may_overlap(const AbstractSimpleSetPtr_t &simple_set) const {
+    if (simple_sets->empty()) {
+        return false;
+    }
+    auto hull = get_hull();
+    if (hull == nullptr) {
+        return true;
+    }
+    return hull->intersects(simple_set);
+}
+
+bool AbstractCompositeSet::cached_hulls_are_apart(const AbstractCompositeSet &other) const {
+    // Take the hulls one lock at a time, other may be this
+    AbstractSimpleSetPtr_t hull;
+    AbstractSimpleSetPtr_t other_hull;
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        hull = current_invariants().hull;
+    }
+    {
+        std::lock_guard<std::mutex> lock(other.invariants_mutex);
+        other_hull = other.current_invariants().hull;
+    }
+    return hull != nullptr && other_hull != nullptr && !hull->intersects(other_hull);
+}
+
 bool AbstractCompositeSet::is_disjoint() {
     // Early‐exit if fewer than 2 atomic pieces
     if (simple_sets->size() < 2) {
         return true;
     }
 
-    // Copy all pointers into a vector (O(n))
-    std::vector<AbstractSimpleSetPtr_t> vec;
-    vec.reserve(simple_sets->size());
-    for (auto const &p : *simple_sets) {
-        vec.push_back(p);
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        auto const &current = current_invariants();
+        if (current.disjoint.has_value()) {
+            return *current.disjoint;
+        }
     }
 
+    // The simple sets are stored contiguously, so they are indexed directly
+    auto const &vec = *simple_sets;
+
     // For each unique pair (i<j), test intersection.  Early‐exit on first non‐empty
     // (If n is small, this is fine; if n is large, this is the inherent O(n^2) check.)
-    for (size_t i = 0; i + 1 < vec.size(); ++i) {
+    bool disjoint = true;
+    for (size_t i = 0; disjoint && i + 1 < vec.size(); ++i) {
         for (size_t j = i + 1; j < vec.size(); ++j) {
-            auto &A = vec[i];
-            auto &B = vec[j];
-            auto I = A->intersection_with(B);  // cost = T_cap
-            if (!I->is_empty()) {
-                return false;  // found overlap
+            if (vec[i]->intersects(vec[j])) {
+                disjoint = false;  // found overlap
+                break;
             }
         }
     }
-    return true;
+
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    current_invariants().disjoint = disjoint;
+    return disjoint;
 }
 
 bool AbstractCompositeSet::is_empty() {
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        auto const &current = current_invariants();
+        if (current.empty.has_value()) {
+            return *current.empty;
+        }
+    }
+
     // scan n pieces → O(n)
+    bool empty = true;
     for (auto const &p : *simple_sets) {
         if (!p->is_empty()) {
-            return false;
+            empty = false;
+            break;
         }
     }
-    return true;
+
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    current_invariants().empty = empty;
+    return empty;
 }
 
 std::string *AbstractCompositeSet::to_string() {
@@ -161,6 +404,25 @@ std::string *AbstractCompositeSet::to_string() {
     return result;
 }
 
+std::uint64_t AbstractCompositeSet::fingerprint() const {
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        auto const &current = current_invariants();
+        if (current.fingerprint.has_value()) {
+            return *current.fingerprint;
+        }
+    }
+
+    std::uint64_t result = simple_sets->size();
+    for (auto const &p : *simple_sets) {
+        result = combine_fingerprints(result, p->fingerprint());
+    }
+
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    current_invariants().fingerprint = result;
+    return result;
+}
+
 bool AbstractCompositeSet::operator==(const AbstractCompositeSet &other) const {
     // Quick size check first
     if (simple_sets->size() != other.simple_sets->size()) {
@@ -183,6 +445,15 @@ bool AbstractCompositeSet::operator!=(const AbstractCompositeSet &other) const {
     return !(*this == other);
 }
 
+size_t AbstractCompositeSet::memory_usage() const {
+    size_t result = sizeof(AbstractCompositeSet) + sizeof(SimpleSetSet_t) +
+                    simple_sets->size() * sizeof(AbstractSimpleSetPtr_t);
+    for (auto const &simple_set : *simple_sets) {
+        result += simple_set->memory_usage();
+    }
+    return result;
+}
+
 bool AbstractCompositeSet::operator<(const AbstractCompositeSet &other) const {
     // We implement a standard "lexicographical_compare" by walking both sets in lock‐step.
 
@@ -229,103 +500,92 @@ AbstractCompositeSet::split_into_disjoint_and_non_disjoint() const {
     auto disjoint = make_new_empty();  // will collect pieces that never overlap
     auto non_disjoint = make_new_empty();  // will collect all pairwise intersections
 
-    // Pre-allocate vectors to avoid reallocations
-    std::vector<AbstractSimpleSetPtr_t> vec;
-    vec.reserve(simple_sets->size());
-
-    // Use a vector of pairs to track which elements need to be processed
-    // This avoids unnecessary comparisons
-    std::vector<std::pair<size_t, size_t>> pairs_to_check;
-
-    // 1) Turn the current std::set into a vector for indexed loops (O(n))
-    for (auto const &p : *simple_sets) {
-        vec.push_back(p);
-    }
-
-    // Generate all pairs (i,j) where i < j
-    // This avoids redundant comparisons (comparing A with B and then B with A)
+    // 1) The simple sets are stored contiguously, so they are indexed directly
+    auto const &vec = *simple_sets;
     size_t n = vec.size();
-    pairs_to_check.reserve(n * (n - 1) / 2);
-    for (size_t i = 0; i < n; ++i) {
+
+    // 2) Intersect every pair (i, j) with i < j.  Row i holds the non-empty intersections with the later simple sets;
+    //    rows are independent and are handed out to the threads one at a time, since they get shorter.
+    //    Cancellation is checked between pairs.
+    std::vector<std::vector<std::pair<size_t, AbstractSimpleSetPtr_t>>> rows(n);
+    std::atomic<size_t> rows_done{0};
+    parallel_for(n, [&](size_t i) {
         for (size_t j = i + 1; j < n; ++j) {
-            pairs_to_check.emplace_back(i, j);
+            checkpoint();
+            if (!vec[i]->intersects(vec[j])) {
+                continue;
+            }
+            auto I = vec[i]->intersection_with(vec[j]);
+            if (!I->is_empty()) {
+                charge_budget("split_into_disjoint_and_non_disjoint", 1, I->memory_usage());
+                rows[i].emplace_back(j, I);
+            }
         }
-    }
-
-    // Track which elements have been completely removed
-    std::vector<bool> completely_removed(n, false);
+        report_progress("split_into_disjoint_and_non_disjoint", ++rows_done, n);
+    });
 
-    // Vector to store remaining parts for each element
-    std::vector<AbstractCompositeSetPtr_t> remaining_parts(n);
+    // 3) Every simple set loses all its intersections, not only the ones with simple sets that still have a
+    //    remainder; otherwise a remainder could overlap an intersection of two other simple sets
+    std::vector<std::vector<const AbstractSimpleSetPtr_t *>> overlaps(n);
+    std::vector<AbstractSimpleSetPtr_t> intersections;
     for (size_t i = 0; i < n; ++i) {
-        remaining_parts[i] = make_new_empty();
-        remaining_parts[i]->simple_sets->insert(vec[i]);
+        for (auto const &[j, I] : rows[i]) {
+            overlaps[i].push_back(&I);
+            overlaps[j].push_back(&I);
+            intersections.push_back(I);
+        }
     }
 
-    // Process all pairs
-    for (const auto& [i, j] : pairs_to_check) {
-        // Skip if either element has been completely removed
-        if (completely_removed[i] || completely_removed[j]) continue;
-
-        auto &A = vec[i];
-        auto &B = vec[j];
-
-        // Compute intersection I = A ∩ B
-        auto I = A->intersection_with(B);
-
-        if (!I->is_empty()) {
-            // Collect I into "non_disjoint" once
-            non_disjoint->simple_sets->insert(I);
-
-            // Process element A
-            if (!completely_removed[i]) {
-                auto newRemaining = remaining_parts[i]->difference_with(I);
-                if (newRemaining->is_empty()) {
-                    completely_removed[i] = true;
-                } else {
-                    remaining_parts[i] = newRemaining;
-                }
-            }
-
-            // Process element B
-            if (!completely_removed[j]) {
-                auto newRemaining = remaining_parts[j]->difference_with(I);
-                if (newRemaining->is_empty()) {
-                    completely_removed[j] = true;
-                } else {
-                    remaining_parts[j] = newRemaining;
-                }
+    std::vector<AbstractCompositeSetPtr_t> remaining_parts(n);
+    parallel_for(n, [&](size_t k) {
+        auto remaining = make_new_empty();
+        remaining->simple_sets->insert(vec[k]);
+        for (auto const &I : overlaps[k]) {
+            checkpoint();
+            remaining = remaining->difference_with(*I);
+            if (remaining->is_empty()) {
+                break;
             }
         }
-    }
+        remaining_parts[k] = remaining;
+    });
 
-    // Collect all remaining parts that weren't completely removed
-    for (size_t i = 0; i < n; ++i) {
-        if (!completely_removed[i]) {
-            disjoint->simple_sets->insert(
-                remaining_parts[i]->simple_sets->begin(),
-                remaining_parts[i]->simple_sets->end());
-        }
+    // 4) Collect in index order, such that the result does not depend on the scheduling
+    std::vector<AbstractSimpleSetPtr_t> pieces;
+    for (auto const &remaining : remaining_parts) {
+        pieces.insert(pieces.end(), remaining->simple_sets->begin(), remaining->simple_sets->end());
     }
+    disjoint->simple_sets->insert(pieces.begin(), pieces.end());
+    disjoint->mark_disjoint();
+    non_disjoint->simple_sets->insert(intersections.begin(), intersections.end());
+
+    // 5) Only the union of the intersections matters, so intersections inside other intersections are dropped
+    non_disjoint->remove_dominated_simple_sets();
 
     return std::make_tuple(disjoint, non_disjoint);
 }
 
 AbstractCompositeSetPtr_t AbstractCompositeSet::make_disjoint() const {
-    // Early exit for empty or singleton sets - they are already disjoint
-    if (simple_sets->size() <= 1) {
+    // Early exit for empty, singleton and known disjoint sets
+    if (is_known_disjoint()) {
         auto result = make_new_empty();
         if (!simple_sets->empty()) {
             result->simple_sets->insert(simple_sets->begin(), simple_sets->end());
         }
+        result->mark_disjoint();
         return result;
     }
 
     // 1) First split current composite into (disjoint_0, non_disjoint_0)
     auto [disjoint_acc, non_disjoint] = split_into_disjoint_and_non_disjoint();
 
-    // 2) As long as there remain "intersecting pieces," keep splitting them
+    // 2) As long as there remain "intersecting pieces," keep splitting them.  Cancellation is checked between rounds;
+    //    the pieces are charged to the budget as they are split off.
+    size_t round = 1;
+    report_progress("make_disjoint", round, 0);
     while (!non_disjoint->is_empty()) {
+        checkpoint();
+        report_progress("make_disjoint", ++round, 0);
         auto [newDisjoint, remainder] = non_disjoint->split_into_disjoint_and_non_disjoint();
         // accumulate newDisjoint into disjoint_acc
         disjoint_acc->simple_sets->insert(
@@ -336,7 +596,9 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::make_disjoint() const {
 
     // 3) We have now collected every disjoint piece.  We simply return "disjoint_acc->simplify()"
     //    which under the assumption that "disjoint_acc" is already pairwise‐disjoint, will be O(n log n)
-    return disjoint_acc->simplify();
+    auto result = disjoint_acc->simplify();
+    result->mark_disjoint();
+    return result;
 }
 
 AbstractCompositeSetPtr_t AbstractCompositeSet::intersection_with(
@@ -345,6 +607,10 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::intersection_with(
     if (simple_sets->empty() || simple_set->is_empty()) {
         return make_new_empty();
     }
+    if (!may_overlap(simple_set)) {
+        record_hull_fast_path();
+        return make_new_empty();
+    }
 
     // Build "{ A_i ∩ simple_set : for each A_i in this→simple_sets }"
     // Then bulk‐insert all nonempty pieces in one go (to avoid n calls to insert()).
@@ -352,17 +618,21 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::intersection_with(
     std::vector<AbstractSimpleSetPtr_t> scratch;
     scratch.reserve(simple_sets->size());
 
-    for (auto const &A : *simple_sets) {
+    // Only pieces that may overlap simple_set can contribute (all of them unless this is indexed)
+    for_each_overlap_candidate(simple_set, [&](const AbstractSimpleSetPtr_t &A) {
         auto I = A->intersection_with(simple_set);  // cost = T_cap
         if (!I->is_empty()) {
             scratch.push_back(I);
         }
-    }
+    });
 
     auto result = make_new_empty();
     if (!scratch.empty()) {
         result->simple_sets->insert(scratch.begin(), scratch.end());  // O(k log k)
     }
+    if (is_known_disjoint()) {
+        result->mark_disjoint();
+    }
     return result;
 }
 
@@ -373,20 +643,19 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::intersection_with(
         return make_new_empty();
     }
 
-    // We want ∪_{B ∈ other} (this ∩ B).  We'll accumulate all those atomic pieces into one vector,
-    // then bulk‐insert.
+    // We want ∪_{B ∈ other} (this ∩ B).  Every B is intersected independently (in parallel for many B) into its
+    // own slot; the slots are then concatenated in the order of "other" and bulk‐inserted.
+    auto const &outer = *other;
+    std::vector<AbstractCompositeSetPtr_t> pieces(outer.size());
+    parallel_for(outer.size(), [&](size_t k) {
+        // "temp" is (this ∩ B), itself a small composite
+        pieces[k] = intersection_with(outer[k]);  // from above
+    });
 
     std::vector<AbstractSimpleSetPtr_t> scratch;
     scratch.reserve(simple_sets->size() + other->size());
-
-    for (auto const &B : *other) {
-        // "temp" is (this ∩ B), itself a small composite
-        auto temp = intersection_with(B);  // from above
-
-        // Insert all of temp→simple_sets into scratch
-        for (auto const &p : *temp->simple_sets) {
-            scratch.push_back(p);
-        }
+    for (auto const &temp : pieces) {
+        scratch.insert(scratch.end(), temp->simple_sets->begin(), temp->simple_sets->end());
     }
 
     auto result = make_new_empty();
@@ -402,9 +671,17 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::intersection_with(
     if (simple_sets->empty() || other->simple_sets->empty()) {
         return make_new_empty();
     }
+    if (!may_overlap(*other)) {
+        record_hull_fast_path();
+        return make_new_empty();
+    }
 
-    // Just delegate to the "set‐of‐pointers" overload
-    return intersection_with(other->simple_sets);
+    // Just delegate to the "set‐of‐pointers" overload; pieces of two disjoint composites are disjoint
+    auto result = intersection_with(other->simple_sets);
+    if (is_known_disjoint() && other->is_known_disjoint()) {
+        result->mark_disjoint();
+    }
+    return result;
 }
 
 AbstractCompositeSetPtr_t AbstractCompositeSet::complement() const {
@@ -418,9 +695,14 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::complement() const {
 
     AbstractCompositeSetPtr_t result = nullptr;
     bool first = true;
+    size_t done = 0;
 
     for (auto const &A : *simple_sets) {
+        // Cancellation is checked between the simple sets
+        checkpoint();
+        report_progress("complement", done++, simple_sets->size());
         auto compA = A->complement();  // cost ≈ O(k_i log k_i)
+        charge_budget("complement", *compA);
         if (first) {
             // Initialize result to "all pieces from A^c"
             result = make_new_empty();
@@ -429,9 +711,15 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::complement() const {
         } else {
             // Intersect the running result with compA
             result = result->intersection_with(compA);  // each intersection is expensive
+            charge_budget("complement", *result->simple_sets);
         }
     }
-    return (result == nullptr) ? make_new_empty() : result;
+    if (result == nullptr) {
+        return make_new_empty();
+    }
+    // The complements of simple sets are disjoint and intersecting keeps them disjoint
+    result->mark_disjoint();
+    return result;
 }
 
 AbstractCompositeSetPtr_t AbstractCompositeSet::union_with(
@@ -447,7 +735,7 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::union_with(
         return result;
     }
     if (other->is_empty()) {
-        return shared_from_this();
+        return copy_of(*this);
     }
 
     auto result = make_new_empty();
@@ -468,7 +756,15 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::union_with(
         return result;
     }
 
-    // 3) We must re‐merge any overlaps: make_disjoint()
+    // A disjoint composite and a simple set outside of its hull are simply concatenated
+    if (is_known_disjoint() && !may_overlap(other)) {
+        record_hull_fast_path();
+        result->mark_disjoint();
+        return result;
+    }
+
+    // 3) Drop pieces that another piece contains, then re‐merge any overlaps: make_disjoint()
+    prune_dominated(*result);
     return result->make_disjoint();
 }
 
@@ -522,19 +818,30 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::union_with(
         }
     }
 
-    // 2) Insert all non-empty sets from "other"
+    // 2) Insert all non-empty sets from "other" in one sorted merge
+    std::vector<AbstractSimpleSetPtr_t> others;
+    others.reserve(other->simple_sets->size());
     for (auto const &p : *other->simple_sets) {
         if (!p->is_empty()) {
-            result->simple_sets->insert(p);
+            others.push_back(p);
         }
     }
+    result->simple_sets->insert(others.begin(), others.end());
 
     // If result is empty after filtering, return empty set
     if (result->simple_sets->empty()) {
         return result;
     }
 
-    // 3) Re‐coalesce any overlaps
+    // Two disjoint composites whose hulls do not overlap are simply concatenated
+    if (is_known_disjoint() && other->is_known_disjoint() && !may_overlap(*other)) {
+        record_hull_fast_path();
+        result->mark_disjoint();
+        return result;
+    }
+
+    // 3) Drop pieces that another piece contains, then re‐coalesce any overlaps
+    prune_dominated(*result);
     return result->make_disjoint();
 }
 
@@ -545,15 +852,28 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::difference_with(
         return make_new_empty();
     }
     if (other->is_empty()) {
-        return shared_from_this();
+        return copy_of(*this);
     }
 
-    // Build "all pieces of Ai \ other," then collect and make_disjoint at the end
+    // Build "all pieces of Ai \ other," then collect and make_disjoint at the end.
+    // Pieces that cannot overlap "other" are kept as they are.  The candidates come in iteration order,
+    // so we can walk them in lock-step with simple_sets.
     std::vector<AbstractSimpleSetPtr_t> scratch;
     scratch.reserve(simple_sets->size());
 
+    auto candidates = overlap_candidates(other);
+    size_t next_candidate = 0;
+
     for (auto const &A : *simple_sets) {
+        if (candidates) {
+            if (next_candidate == candidates->size() || (*candidates)[next_candidate] != A) {
+                scratch.push_back(A);
+                continue;
+            }
+            ++next_candidate;
+        }
         auto diffA = A->difference_with(other);  // each diffA is a set of pieces
+        charge_budget("difference_with", *diffA);
         for (auto const &p : *diffA) {
             scratch.push_back(p);
         }
@@ -573,34 +893,44 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::difference_with(
         return make_new_empty();
     }
     if (other->is_empty()) {
-        return shared_from_this();
+        return copy_of(*this);
+    }
+    if (!may_overlap(*other)) {
+        record_hull_fast_path();
+        return make_disjoint();
     }
 
-    std::vector<AbstractSimpleSetPtr_t> all_survivors;
-    all_survivors.reserve(simple_sets->size() * other->simple_sets->size());
+    // For each A_i in "this", subtract off all pieces in "other".  The A_i are independent, hence they are handed
+    // out to the threads for many A_i; every A_i keeps its survivors in its own slot.
+    auto const &outer = *simple_sets;
+    std::vector<AbstractCompositeSetPtr_t> survivors(outer.size());
+    parallel_for(outer.size(), [&](size_t k) {
+        auto const &A = outer[k];
 
-    // For each A_i in "this", subtract off all pieces in "other"
-    for (auto const &A : *simple_sets) {
         // current_difference is "{A}" initially
         auto current_diff = make_new_empty();
         current_diff->simple_sets->insert(A);
 
-        // Now subtract each B_j in "other"
-        for (auto const &B : *other->simple_sets) {
+        // Now subtract each B_j in "other" that may overlap A (all of them unless "other" is indexed)
+        auto subtract = [&](const AbstractSimpleSetPtr_t &B) {
+            if (current_diff == nullptr) {
+                return;  // A is fully removed
+            }
             // Compute A′ = current_diff \ B
             // Note: difference_with(B) returns a set of pieces
             auto temp = current_diff->difference_with(B);
-            if (temp->is_empty()) {
-                current_diff = nullptr;
-                break;  // A is fully removed
-            }
-            current_diff = temp;
-        }
+            current_diff = temp->is_empty() ? nullptr : temp;
+        };
+        other->for_each_overlap_candidate(A, subtract);
+        survivors[k] = current_diff;
+    });
+
+    // Collect whatever atomic pieces remained, in the order of "this"
+    std::vector<AbstractSimpleSetPtr_t> all_survivors;
+    for (auto const &current_diff : survivors) {
         if (current_diff != nullptr) {
-            // Collect whatever atomic pieces remained
-            for (auto const &p : *current_diff->simple_sets) {
-                all_survivors.push_back(p);
-            }
+            all_survivors.insert(all_survivors.end(), current_diff->simple_sets->begin(),
+                                 current_diff->simple_sets->end());
         }
     }
 
@@ -611,21 +941,89 @@ AbstractCompositeSetPtr_t AbstractCompositeSet::difference_with(
     return result->make_disjoint();
 }
 
-bool AbstractCompositeSet::contains(const AbstractCompositeSetPtr_t &other) {
-    // Early exit for empty sets
-    if (other->is_empty()) {
-        return true;  // Empty set is contained in any set
+bool AbstractCompositeSet::intersects(const AbstractCompositeSetPtr_t &other) {
+    if (simple_sets->empty() || other->simple_sets->empty()) {
+        return false;
     }
-    if (simple_sets->empty()) {
-        return false;  // Non-empty set is not contained in empty set
+    // Computing the hulls would cost as much as the answer, so they are only used if they are at hand
+    if (cached_hulls_are_apart(*other)) {
+        return false;
+    }
+
+    for (auto const &A : *simple_sets) {
+        if (any_overlap_candidate(*other, A, [&A](const AbstractSimpleSetPtr_t &B) { return A->intersects(B); })) {
+            return true;
+        }
     }
+    return false;
+}
 
-    // A ⊇ B  iff  A ∩ B == B
-    auto I = intersection_with(other);  // expensive
-    return (I == other) || (*I == *other);
+bool AbstractCompositeSet::is_disjoint_from(const AbstractCompositeSetPtr_t &other) {
+    return !intersects(other);
+}
+
+bool AbstractCompositeSet::is_subset_of(const AbstractCompositeSetPtr_t &other) {
+    if (other.get() == this) {
+        return true;
+    }
+
+    for (auto const &A : *simple_sets) {
+        if (A->is_empty() ||
+            any_overlap_candidate(*other, A, [&A](const AbstractSimpleSetPtr_t &B) { return A->is_subset_of(B); })) {
+            continue;
+        }
+        // A may still be covered by several simple sets of other
+        auto piece = make_new_empty();
+        piece->simple_sets->insert(A);
+        if (!piece->difference_with(other)->is_empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AbstractCompositeSet::contains(const AbstractCompositeSetPtr_t &other) {
+    return other->is_subset_of(shared_from_this());
 }
 
 void AbstractCompositeSet::add_new_simple_set(
     const AbstractSimpleSetPtr_t &simple_set) const {
-    simple_sets->insert(simple_set);  // O(log n)
+    // 1) Look at the invariants before the set grows; the hull is computed at most once and then extended
+    bool was_non_empty;
+    {
+        std::lock_guard<std::mutex> lock(invariants_mutex);
+        was_non_empty = current_invariants().empty == false;
+    }
+    bool was_disjoint = is_known_disjoint();
+    bool was_empty_set = simple_sets->empty();
+    auto hull = (was_disjoint && !was_empty_set) ? get_hull() : nullptr;
+
+    if (!simple_sets->insert(simple_set).second) {  // O(log n)
+        return;
+    }
+
+    // 2) Carry the invariants over: a disjoint composite stays disjoint if the new simple set lies outside its hull
+    Invariants next;
+    next.source_version = simple_sets->version();
+    if (was_non_empty || !simple_set->is_empty()) {
+        next.empty = false;
+    }
+    if (was_disjoint && (was_empty_set || (hull != nullptr && hull->intersection_with(simple_set)->is_empty()))) {
+        next.disjoint = true;
+    }
+    if (hull != nullptr) {
+        auto both = make_new_empty();
+        both->simple_sets->insert(hull);
+        both->simple_sets->insert(simple_set);
+        next.hull = both->compute_hull();
+        next.hull_computed = true;
+    }
+    std::lock_guard<std::mutex> lock(invariants_mutex);
+    invariants = next;
+}
+
+std::optional<std::vector<AbstractSimpleSetPtr_t>> AbstractCompositeSet::overlap_candidates(
+    const AbstractSimpleSetPtr_t & /*simple_set*/) const {
+    // No index: every simple set is a candidate
+    return std::nullopt;
 }
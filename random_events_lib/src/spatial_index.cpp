@@ -0,0 +1,373 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+//
+// ===============================
+//  —— BoundingBox ——
+// ===============================
+//
+
+bool BoundingBox::overlaps(const BoundingBox &other) const {
+    for (size_t i = 0; i < lower.size(); ++i) {
+        if (lower[i] > other.upper[i] || other.lower[i] > upper[i]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < masks.size(); ++i) {
+        if ((masks[i] & other.masks[i]) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BoundingBox::extend(const BoundingBox &other) {
+    for (size_t i = 0; i < lower.size(); ++i) {
+        lower[i] = std::min(lower[i], other.lower[i]);
+        upper[i] = std::max(upper[i], other.upper[i]);
+    }
+    for (size_t i = 0; i < masks.size(); ++i) {
+        masks[i] |= other.masks[i];
+    }
+}
+
+//
+// ===============================
+//  —— SpatialIndex ——
+// ===============================
+//
+
+// Helper: A representative coordinate of [lower, upper] that is finite whenever one of the bounds is.
+//   Used to sort boxes along an axis; unbounded boxes gather around their finite end.
+static double center_of(double lower, double upper) {
+    const bool lower_finite = std::isfinite(lower);
+    const bool upper_finite = std::isfinite(upper);
+    if (lower_finite && upper_finite) {
+        return lower + (upper - lower) / 2;
+    }
+    if (lower_finite) {
+        return lower;
+    }
+    if (upper_finite) {
+        return upper;
+    }
+    return 0;
+}
+
+SpatialIndex::SpatialIndex(const SimpleSetSetPtr_t &simple_events_) {
+    source_version = simple_events_->version();
+
+    // 1) Collect the variables of all simple events (name ordered) and split them by kind.
+    VariableSet all_variables;
+    for (auto const &simple_event : *simple_events_) {
+        for (auto const &[variable, assignment] : *static_cast<SimpleEvent *>(simple_event.get())->variable_map) {
+            all_variables.insert(variable);
+        }
+    }
+
+    variables.assign(all_variables.begin(), all_variables.end());
+    layout.reserve(variables.size());
+    is_symbolic.reserve(variables.size());
+    for (auto const &variable : variables) {
+        if (dynamic_cast<Symbolic *>(variable.get()) != nullptr) {
+            layout.push_back(symbolic_variables.size());
+            symbolic_variables.push_back(variable);
+            is_symbolic.push_back(true);
+        } else {
+            layout.push_back(interval_variables.size());
+            interval_variables.push_back(variable);
+            is_symbolic.push_back(false);
+        }
+    }
+
+    // 2) Flatten the boxes of all simple events.
+    const size_t n = simple_events_->size();
+    const size_t ni = interval_variables.size();
+    const size_t ns = symbolic_variables.size();
+    simple_events.reserve(n);
+    entry_lower.reserve(n * ni);
+    entry_upper.reserve(n * ni);
+    entry_masks.reserve(n * ns);
+
+    for (auto const &simple_event : *simple_events_) {
+        simple_events.push_back(simple_event);
+        auto box = bounding_box(*static_cast<SimpleEvent *>(simple_event.get()));
+        entry_lower.insert(entry_lower.end(), box.lower.begin(), box.lower.end());
+        entry_upper.insert(entry_upper.end(), box.upper.begin(), box.upper.end());
+        entry_masks.insert(entry_masks.end(), box.masks.begin(), box.masks.end());
+    }
+
+    // 3) Bulk load the hierarchy.
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    if (n > 0) {
+        nodes.reserve(2 * (n / LEAF_SIZE + 1));
+        build(0, n);
+    }
+}
+
+const std::vector<AbstractVariablePtr_t> &SpatialIndex::get_variables() const {
+    return variables;
+}
+
+size_t SpatialIndex::size() const {
+    return simple_events.size();
+}
+
+bool SpatialIndex::is_built_from(const SimpleSetSetPtr_t &simple_events_) const {
+    return simple_events_->version() == source_version;
+}
+
+BoundingBox SpatialIndex::bounding_box(const SimpleEvent &simple_event) const {
+    BoundingBox box;
+    box.lower.assign(interval_variables.size(), -std::numeric_limits<double>::infinity());
+    box.upper.assign(interval_variables.size(), std::numeric_limits<double>::infinity());
+    box.masks.assign(symbolic_variables.size(), ~std::uint64_t{0});
+
+    // Both the variable map and 'variables' are name ordered, so walk them in lock-step.
+    auto it = simple_event.variable_map->begin();
+    auto end = simple_event.variable_map->end();
+    for (size_t position = 0; position < variables.size() && it != end; ++position) {
+        while (it != end && *(it->first) < *variables[position]) {
+            ++it;
+        }
+        if (it == end || *variables[position] < *(it->first)) {
+            // not assigned by the simple event → unconstrained
+            continue;
+        }
+
+        const auto &assignment = it->second;
+        if (is_symbolic[position]) {
+            std::uint64_t mask = 0;
+            for (auto const &simple_set : *assignment->simple_sets) {
+                auto element_index = static_cast<SetElement *>(simple_set.get())->element_index;
+                if (element_index >= 0) {
+                    mask |= std::uint64_t{1} << (element_index % 64);
+                }
+            }
+            box.masks[layout[position]] = mask;
+        } else {
+            double lower = std::numeric_limits<double>::infinity();
+            double upper = -std::numeric_limits<double>::infinity();
+            for (auto const &simple_set : *assignment->simple_sets) {
+                auto simple_interval = static_cast<SimpleInterval *>(simple_set.get());
+                if (simple_interval->is_empty()) {
+                    continue;
+                }
+                lower = std::min(lower, simple_interval->lower);
+                upper = std::max(upper, simple_interval->upper);
+            }
+            box.lower[layout[position]] = lower;
+            box.upper[layout[position]] = upper;
+        }
+    }
+    return box;
+}
+
+int SpatialIndex::build(size_t begin, size_t end) {
+    const size_t ni = interval_variables.size();
+    const size_t ns = symbolic_variables.size();
+
+    const int node = static_cast<int>(nodes.size());
+    nodes.push_back({begin, end});
+
+    // 1) Bounding box of the range
+    node_lower.insert(node_lower.end(), ni, std::numeric_limits<double>::infinity());
+    node_upper.insert(node_upper.end(), ni, -std::numeric_limits<double>::infinity());
+    node_masks.insert(node_masks.end(), ns, 0);
+    double *lower = node_lower.data() + node * ni;
+    double *upper = node_upper.data() + node * ni;
+    std::uint64_t *masks = node_masks.data() + node * ns;
+    for (size_t k = begin; k < end; ++k) {
+        const size_t entry = order[k];
+        for (size_t i = 0; i < ni; ++i) {
+            lower[i] = std::min(lower[i], entry_lower[entry * ni + i]);
+            upper[i] = std::max(upper[i], entry_upper[entry * ni + i]);
+        }
+        for (size_t i = 0; i < ns; ++i) {
+            masks[i] |= entry_masks[entry * ns + i];
+        }
+    }
+
+    if (end - begin <= LEAF_SIZE) {
+        return node;
+    }
+
+    // 2) Split along the interval variable on which the box centers spread the most
+    size_t split_variable = ni;
+    double best_spread = 0;
+    for (size_t i = 0; i < ni; ++i) {
+        double min_center = std::numeric_limits<double>::infinity();
+        double max_center = -std::numeric_limits<double>::infinity();
+        for (size_t k = begin; k < end; ++k) {
+            const size_t entry = order[k];
+            const double center = center_of(entry_lower[entry * ni + i], entry_upper[entry * ni + i]);
+            min_center = std::min(min_center, center);
+            max_center = std::max(max_center, center);
+        }
+        if (max_center - min_center > best_spread) {
+            best_spread = max_center - min_center;
+            split_variable = i;
+        }
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    if (split_variable < ni) {
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                         [this, ni, split_variable](size_t lhs, size_t rhs) {
+                             return center_of(entry_lower[lhs * ni + split_variable],
+                                              entry_upper[lhs * ni + split_variable]) <
+                                    center_of(entry_lower[rhs * ni + split_variable],
+                                              entry_upper[rhs * ni + split_variable]);
+                         });
+    } else {
+        // 2b) No spread on any interval variable; group equal masks of the first symbolic variable that differs
+        size_t split_mask = ns;
+        for (size_t i = 0; i < ns && split_mask == ns; ++i) {
+            for (size_t k = begin + 1; k < end; ++k) {
+                if (entry_masks[order[k] * ns + i] != entry_masks[order[begin] * ns + i]) {
+                    split_mask = i;
+                    break;
+                }
+            }
+        }
+        if (split_mask == ns) {
+            // all boxes are equal; nothing to gain from splitting
+            return node;
+        }
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                         [this, ns, split_mask](size_t lhs, size_t rhs) {
+                             return entry_masks[lhs * ns + split_mask] < entry_masks[rhs * ns + split_mask];
+                         });
+    }
+
+    // 3) Recurse; 'nodes' may reallocate, so only store indices
+    const int left = build(begin, middle);
+    const int right = build(middle, end);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    return node;
+}
+
+bool SpatialIndex::entry_overlaps(size_t entry, const BoundingBox &box) const {
+    const size_t ni = interval_variables.size();
+    const size_t ns = symbolic_variables.size();
+    for (size_t i = 0; i < ni; ++i) {
+        if (entry_lower[entry * ni + i] > box.upper[i] || box.lower[i] > entry_upper[entry * ni + i]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < ns; ++i) {
+        if ((entry_masks[entry * ns + i] & box.masks[i]) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SpatialIndex::node_overlaps(size_t node, const BoundingBox &box) const {
+    const size_t ni = interval_variables.size();
+    const size_t ns = symbolic_variables.size();
+    for (size_t i = 0; i < ni; ++i) {
+        if (node_lower[node * ni + i] > box.upper[i] || box.lower[i] > node_upper[node * ni + i]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < ns; ++i) {
+        if ((node_masks[node * ns + i] & box.masks[i]) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<size_t> SpatialIndex::query(const BoundingBox &box) const {
+    std::vector<size_t> result;
+    if (nodes.empty()) {
+        return result;
+    }
+
+    std::vector<int> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const int node = stack.back();
+        stack.pop_back();
+        if (!node_overlaps(node, box)) {
+            continue;
+        }
+        const auto &current = nodes[node];
+        if (current.left < 0) {
+            for (size_t k = current.begin; k < current.end; ++k) {
+                if (entry_overlaps(order[k], box)) {
+                    result.push_back(order[k]);
+                }
+            }
+        } else {
+            stack.push_back(current.right);
+            stack.push_back(current.left);
+        }
+    }
+
+    // entries are numbered in iteration order of the indexed set
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<AbstractSimpleSetPtr_t> SpatialIndex::overlapping(const AbstractSimpleSetPtr_t &simple_event) const {
+    auto entries = query(bounding_box(*static_cast<SimpleEvent *>(simple_event.get())));
+    std::vector<AbstractSimpleSetPtr_t> result;
+    result.reserve(entries.size());
+    for (auto entry : entries) {
+        result.push_back(simple_events[entry]);
+    }
+    return result;
+}
+
+std::vector<AbstractSimpleSetPtr_t> SpatialIndex::containing(const std::vector<double> &point) const {
+    if (point.size() != variables.size()) {
+        throw std::invalid_argument("the point must assign a value to every variable of the index");
+    }
+
+    // 1) Degenerate box of the point
+    BoundingBox box;
+    box.lower.resize(interval_variables.size());
+    box.upper.resize(interval_variables.size());
+    box.masks.resize(symbolic_variables.size());
+    for (size_t position = 0; position < variables.size(); ++position) {
+        if (is_symbolic[position]) {
+            auto element_index = static_cast<long long>(point[position]);
+            box.masks[layout[position]] = element_index < 0 ? 0 : std::uint64_t{1} << (element_index % 64);
+        } else {
+            box.lower[layout[position]] = point[position];
+            box.upper[layout[position]] = point[position];
+        }
+    }
+
+    // 2) Exact membership test on the candidates only
+    std::vector<AbstractSimpleSetPtr_t> result;
+    for (auto entry : query(box)) {
+        const auto &variable_map = static_cast<SimpleEvent *>(simple_events[entry].get())->variable_map;
+        bool inside = true;
+        auto it = variable_map->begin();
+        for (size_t position = 0; position < variables.size() && inside && it != variable_map->end(); ++position) {
+            if (*variables[position] < *(it->first)) {
+                continue;
+            }
+            if (is_symbolic[position]) {
+                inside = static_cast<Set *>(it->second.get())->contains(static_cast<int>(point[position]));
+            } else {
+                inside = static_cast<Interval *>(it->second.get())->contains(point[position]);
+            }
+            ++it;
+        }
+        if (inside) {
+            result.push_back(simple_events[entry]);
+        }
+    }
+    return result;
+}
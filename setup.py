@@ -11,7 +11,7 @@ from pybind11.setup_helpers import Pybind11Extension
 ext_modules = [
     Pybind11Extension(
         "random_events_lib",  # Python module name
-        ["export/bindings.cpp", "random_events_lib/src/sigma_algebra.cpp", "random_events_lib/src/set.cpp", "random_events_lib/src/product_algebra.cpp"],  # C++ binding source
+        ["export/bindings.cpp", "random_events_lib/src/sigma_algebra.cpp", "random_events_lib/src/set.cpp", "random_events_lib/src/product_algebra.cpp", "random_events_lib/src/spatial_index.cpp", "random_events_lib/src/classifier.cpp", "random_events_lib/src/refinement.cpp", "random_events_lib/src/parallel.cpp", "random_events_lib/src/batch.cpp", "random_events_lib/src/cancellation.cpp", "random_events_lib/src/async_operations.cpp", "random_events_lib/src/estimate.cpp", "random_events_lib/src/generator.cpp", "random_events_lib/src/event_builder.cpp", "random_events_lib/src/materialized_view.cpp", "random_events_lib/src/serialization.cpp"],  # C++ binding source
         include_dirs=["random_events_lib/include"],  # Include directory for C++ headers
         extra_compile_args=["-std=c++17", "-fPIC"],
     ),
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "async_operations.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "test_helpers.h"
+#include "variable.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(AsyncOperations, MatchSynchronousResults) {
+    auto event = overlapping_boxes(40);
+    std::vector<std::string> stages;
+    auto progress = [&stages](const std::string &stage, size_t, size_t) { stages.push_back(stage); };
+
+    EXPECT_EQ(*make_disjoint_async(event, CancellationToken(), progress).get(), *event->make_disjoint());
+    EXPECT_FALSE(stages.empty());
+    EXPECT_EQ(*simplify_async(event).get(), *event->simplify());
+    EXPECT_EQ(*complement_async(event).get(), *event->complement());
+
+    auto interval = closed(0, 2)->union_with(closed(1, 3));
+    EXPECT_EQ(*make_disjoint_async(interval).get(), *interval->make_disjoint());
+
+    // without a control, checkpoints do nothing
+    EXPECT_NO_THROW(checkpoint());
+}
+
+TEST(AsyncOperations, Cancel) {
+    auto event = overlapping_boxes(200);
+
+    // cancelled before the start
+    CancellationToken cancelled;
+    cancelled.cancel();
+    EXPECT_THROW(make_disjoint_async(event, cancelled).get(), OperationCancelled);
+
+    // cancelled while running, from the progress callback
+    for (auto run : {make_disjoint_async, simplify_async, complement_async}) {
+        CancellationToken token;
+        auto cancel = [token](const std::string &, size_t, size_t) mutable { token.cancel(); };
+        EXPECT_THROW(run(event, token, cancel).get(), OperationCancelled);
+    }
+
+    // a deadline that passed
+    CancellationToken deadline;
+    deadline.cancel_after(std::chrono::milliseconds(0));
+    EXPECT_TRUE(deadline.is_cancelled());
+    EXPECT_THROW(complement_async(event, deadline).get(), OperationCancelled);
+
+    CancellationToken later;
+    later.cancel_after(std::chrono::hours(1));
+    EXPECT_FALSE(later.is_cancelled());
+}
+
+TEST(AsyncOperations, Shutdown) {
+    auto event = overlapping_boxes(200);
+
+    // unfinished operations are cancelled, later ones run on new threads
+    CancellationToken token;
+    std::vector<std::future<AbstractCompositeSetPtr_t>> futures;
+    for (int k = 0; k < 8; ++k) {
+        futures.push_back(make_disjoint_async(event, token));
+    }
+    shutdown_async_operations();
+    EXPECT_TRUE(token.is_cancelled());
+    for (auto &future : futures) {
+        EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    }
+    EXPECT_THROW(futures.back().get(), OperationCancelled);
+    EXPECT_EQ(*simplify_async(closed(0, 2)->union_with(closed(1, 3))).get(), *closed(0, 3));
+    shutdown_async_operations();
+}
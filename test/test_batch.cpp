@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "batch.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "variable.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(WorkStealingExecutor, RunsEveryIndexOnce) {
+    auto executor = make_shared_work_stealing_executor(4);
+    EXPECT_EQ(executor->size(), 4);
+
+    // skewed work: the first block is slow, hence the other threads have to steal from it
+    std::vector<std::atomic<int>> visits(400);
+    for (int batch = 0; batch < 3; ++batch) {
+        executor->run(visits.size(), [&](size_t index) {
+            if (index < 100) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            visits[index] += 1;
+        });
+    }
+    for (auto const &visit : visits) {
+        EXPECT_EQ(visit.load(), 3);
+    }
+
+    // items run sequentially inside
+    executor->run(8, [](size_t) { EXPECT_TRUE(in_sequential_scope()); });
+    EXPECT_FALSE(in_sequential_scope());
+}
+
+TEST(WorkStealingExecutor, RethrowsFirstFailure) {
+    auto executor = make_shared_work_stealing_executor(3);
+    std::atomic<size_t> ran{0};
+    try {
+        executor->run(50, [&](size_t index) {
+            ran += 1;
+            if (index == 7 || index == 30) {
+                throw std::invalid_argument(std::to_string(index));
+            }
+        });
+        FAIL();
+    } catch (const std::invalid_argument &error) {
+        EXPECT_EQ(std::string(error.what()), "7");
+    }
+    EXPECT_EQ(ran.load(), 50);
+}
+
+TEST(Batch, MatchesSingleOperations) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    std::vector<AbstractCompositeSetPtr_t> events;
+    for (int k = 0; k < 12; ++k) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed(k, k + 3)->union_with(closed(k + 5, k + 6))});
+        map->insert({y, closed(k % 4, k % 4 + 2)});
+        events.push_back(make_shared_event(make_shared_simple_event(map)));
+    }
+    auto query = events[3]->union_with(events[7]);
+
+    std::vector<BatchOperation> operations;
+    for (auto const &event : events) {
+        operations.push_back({SetOperation::INTERSECTION, event, query});
+        operations.push_back({SetOperation::DIFFERENCE, event, query});
+        operations.push_back({SetOperation::UNION, event, query});
+        operations.push_back({SetOperation::COMPLEMENT, event, nullptr});
+        operations.push_back({SetOperation::MAKE_DISJOINT, event, nullptr});
+        operations.push_back({SetOperation::SIMPLIFY, event, nullptr});
+    }
+
+    auto results = execute_batch(operations, make_shared_work_stealing_executor(4));
+    ASSERT_EQ(results.size(), operations.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        auto const &event = events[i];
+        EXPECT_EQ(*results[6 * i], *event->intersection_with(query));
+        EXPECT_EQ(*results[6 * i + 1], *event->difference_with(query));
+        EXPECT_EQ(*results[6 * i + 2], *event->union_with(query));
+        EXPECT_EQ(*results[6 * i + 3], *event->complement());
+        EXPECT_EQ(*results[6 * i + 4], *event->make_disjoint());
+        EXPECT_EQ(*results[6 * i + 5], *event->simplify());
+    }
+
+    // the default executor gives the same results
+    auto again = execute_batch(operations);
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(*again[i], *results[i]);
+    }
+
+    // operations without operands are rejected up front
+    operations.push_back({SetOperation::DIFFERENCE, events[0], nullptr});
+    EXPECT_THROW(execute_batch(operations), std::invalid_argument);
+}
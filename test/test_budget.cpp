@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "cancellation.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "test_helpers.h"
+#include "variable.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+TEST(Budget, SimpleSetLimitFailsFast) {
+    auto event = overlapping_boxes(60);
+    ResourceBudget budget;
+    budget.max_simple_sets = 10;
+    BudgetScope scope(budget);
+
+    try {
+        event->make_disjoint();
+        FAIL() << "make_disjoint exceeded its budget without failing";
+    } catch (const BudgetExceeded &error) {
+        EXPECT_EQ(error.resource, "simple_sets");
+        EXPECT_EQ(error.stage, "make_disjoint");
+        EXPECT_GT(error.usage.simple_sets, 10u);
+        EXPECT_GT(error.usage.bytes, 0u);
+    }
+    EXPECT_THROW(event->complement(), BudgetExceeded);
+    EXPECT_THROW(event->difference_with(overlapping_boxes(5)), BudgetExceeded);
+}
+
+TEST(Budget, BytesLimit) {
+    auto interval = closed(0, 1)->union_with(closed(2, 3));
+    ResourceBudget budget;
+    budget.max_bytes = 1;
+    BudgetScope scope(budget);
+
+    try {
+        interval->complement();
+        FAIL() << "complement exceeded its budget without failing";
+    } catch (const BudgetExceeded &error) {
+        EXPECT_EQ(error.resource, "bytes");
+        EXPECT_EQ(error.stage, "complement");
+    }
+}
+
+TEST(Budget, TimeLimit) {
+    ResourceBudget budget;
+    budget.max_duration = std::chrono::nanoseconds(1);
+    BudgetScope scope(budget);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    EXPECT_THROW(checkpoint(), BudgetExceeded);
+    EXPECT_THROW(overlapping_boxes(40)->simplify(), BudgetExceeded);
+}
+
+TEST(Budget, GenerousBudgetMatchesUnlimited) {
+    auto event = overlapping_boxes(40);
+    auto x = make_shared_continuous("x");
+    auto variables = make_shared_variable_set();
+    variables->insert(x);
+
+    auto disjoint = event->make_disjoint();
+    auto complement = event->complement();
+    auto marginal = event->marginal(variables);
+
+    ResourceBudget outer_budget;
+    outer_budget.max_simple_sets = 1000000;
+    BudgetScope outer(outer_budget);
+    {
+        ResourceBudget inner_budget;
+        inner_budget.max_duration = std::chrono::hours(1);
+        BudgetScope inner(inner_budget);
+        EXPECT_EQ(*event->make_disjoint(), *disjoint);
+        EXPECT_GT(inner.usage().simple_sets, 0u);
+        // nested scopes charge the enclosing ones as well
+        EXPECT_EQ(outer.usage().simple_sets, inner.usage().simple_sets);
+    }
+    EXPECT_EQ(*event->complement(), *complement);
+    EXPECT_EQ(*event->marginal(variables), *marginal);
+    EXPECT_GT(outer.usage().bytes, 0u);
+    EXPECT_TRUE(has_budget());
+}
+
+TEST(Budget, UnlimitedWithoutScope) {
+    EXPECT_FALSE(has_budget());
+    EXPECT_NO_THROW(charge_budget("test", 1000, 1000));
+}
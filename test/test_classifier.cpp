@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "classifier.h"
+#include "product_algebra.h"
+#include "interval.h"
+#include "set.h"
+#include "variable.h"
+#include <memory>
+#include <random>
+
+auto classifier_elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+auto classifier_x = make_shared_continuous("x");
+auto classifier_y = make_shared_continuous("y");
+auto classifier_a = make_shared_symbolic(std::make_shared<std::string>("a"), classifier_elements);
+
+// Three disjoint events over a 12 x 12 grid of unit boxes; the symbol of a box is (i + j) % 3
+std::vector<EventPtr_t> make_classifier_events() {
+    std::vector<SimpleSetSetPtr_t> simple_events(3);
+    for (auto &simple_sets: simple_events) {
+        simple_sets = make_shared_simple_set_set();
+    }
+    for (int i = 0; i < 12; ++i) {
+        for (int j = 0; j < 12; ++j) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({classifier_x, closed_open(i, i + 1)});
+            map->insert({classifier_y, closed_open(j, j + 1)});
+            map->insert({classifier_a, make_shared_set(make_shared_set_element((i + j) % 3, classifier_elements),
+                                                       classifier_elements)});
+            simple_events[(i * j) % 3]->insert(make_shared_simple_event(map));
+        }
+    }
+    std::vector<EventPtr_t> events;
+    for (auto const &simple_sets: simple_events) {
+        events.push_back(make_shared_event(simple_sets));
+    }
+    return events;
+}
+
+TEST(EventClassifier, Classify) {
+    auto events = make_classifier_events();
+    auto classifier = make_shared_event_classifier(events);
+    ASSERT_EQ(classifier->get_variables().size(), 3);
+    ASSERT_GT(classifier->node_count(), 1);
+
+    // variables are name ordered: a, x, y
+    ASSERT_EQ(classifier->classify({(3 + 4) % 3, 3.5, 4.5}), (3 * 4) % 3);
+    ASSERT_EQ(classifier->classify({(5 + 7) % 3, 5.0, 7.0}), (5 * 7) % 3);
+
+    // wrong symbol, outside the grid
+    ASSERT_EQ(classifier->classify({(3 + 4 + 1) % 3, 3.5, 4.5}), -1);
+    ASSERT_EQ(classifier->classify({0, -0.5, 4.5}), -1);
+    ASSERT_EQ(classifier->classify({0, 12.0, 0.0}), -1);
+    ASSERT_THROW(classifier->classify({0, 1}), std::invalid_argument);
+}
+
+TEST(EventClassifier, ClassifyBatch) {
+    auto events = make_classifier_events();
+    auto classifier = make_shared_event_classifier(events);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordinate(-1, 13);
+    std::uniform_int_distribution<std::int64_t> symbol(0, 2);
+    const size_t rows = 10000;
+    std::vector<double> xs(rows);
+    std::vector<double> ys(rows);
+    std::vector<std::int64_t> as(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        xs[row] = std::floor(coordinate(generator) * 4) / 4;
+        ys[row] = std::floor(coordinate(generator) * 4) / 4;
+        as[row] = symbol(generator);
+    }
+
+    ColumnMap columns;
+    columns[classifier_x] = xs.data();
+    columns[classifier_y] = ys.data();
+    columns[classifier_a] = as.data();
+
+    // the membership of every event is the reference
+    std::vector<std::int64_t> expected(rows, -1);
+    for (size_t label = 0; label < events.size(); ++label) {
+        auto inside = events[label]->contains_points(columns, rows);
+        for (size_t row = 0; row < rows; ++row) {
+            if (inside[row]) {
+                ASSERT_EQ(expected[row], -1);
+                expected[row] = static_cast<std::int64_t>(label);
+            }
+        }
+    }
+
+    ASSERT_EQ(classifier->classify(columns, rows, 1), expected);
+    ASSERT_EQ(classifier->classify(columns, rows, 4), expected);
+
+    columns.erase(classifier_y);
+    ASSERT_THROW(classifier->classify(columns, rows), std::invalid_argument);
+}
+
+TEST(EventClassifier, Empty) {
+    auto classifier = make_shared_event_classifier(std::vector<EventPtr_t>{});
+    ASSERT_EQ(classifier->node_count(), 1);
+    ASSERT_EQ(classifier->classify(std::vector<double>{}), -1);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "estimate.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "set.h"
+#include "test_helpers.h"
+#include "variable.h"
+#include <memory>
+#include <set>
+
+// Helper: Check that the estimate of an operation bounds its actual result.
+static void expect_bounded(SetOperation operation, const AbstractCompositeSetPtr_t &lhs,
+                           const AbstractCompositeSetPtr_t &rhs, const AbstractCompositeSetPtr_t &actual) {
+    auto estimate = estimate_cost(operation, lhs, rhs);
+    EXPECT_LE(actual->simple_sets->size(), estimate.max_pieces);
+    EXPECT_LE(estimate.expected_pieces, estimate.max_pieces);
+    EXPECT_GE(estimate.expected_pieces, 0);
+    EXPECT_GT(estimate.work, 0);
+}
+
+TEST(Estimate, Statistics) {
+    auto event = overlapping_boxes(10);
+    auto statistics = collect_statistics(*event);
+    EXPECT_EQ(statistics.kind, SetKind::PRODUCT);
+    EXPECT_EQ(statistics.pieces, 10u);
+    EXPECT_EQ(statistics.fragmentation.at("x"), 10u);
+    EXPECT_EQ(statistics.fragmentation.at("y"), 10u);
+    EXPECT_DOUBLE_EQ(statistics.piece_cost, 2);
+
+    auto elements = make_shared_all_elements(std::set<long long>{0, 1, 2, 3});
+    auto set = make_shared_set(make_shared_set_element(1, elements), elements);
+    auto set_statistics = collect_statistics(*set);
+    EXPECT_EQ(set_statistics.kind, SetKind::SET);
+    EXPECT_EQ(set_statistics.universe_sizes.at(""), 4u);
+    EXPECT_EQ(estimate_cost(SetOperation::COMPLEMENT, set).max_pieces, 3);
+}
+
+TEST(Estimate, ExactForDisjointIntervals) {
+    auto interval = closed(0, 1)->union_with(closed(2, 3))->union_with(closed(4, 5));
+    auto complement = estimate_cost(SetOperation::COMPLEMENT, interval);
+    EXPECT_EQ(complement.max_pieces, 4);
+    EXPECT_EQ(complement.expected_pieces, 4);
+
+    auto disjoint = estimate_cost(SetOperation::MAKE_DISJOINT, interval);
+    EXPECT_EQ(disjoint.max_pieces, 3);
+
+    // operands whose hulls do not overlap cannot intersect
+    auto far = closed(10, 11);
+    EXPECT_EQ(estimate_overlap(*interval, *far), 0);
+    EXPECT_EQ(estimate_cost(SetOperation::INTERSECTION, interval, far).expected_pieces, 0);
+}
+
+TEST(Estimate, BoundsActualResults) {
+    auto lhs = overlapping_boxes(30);
+    auto rhs = overlapping_boxes(20, 10);
+    auto disjoint_lhs = lhs->make_disjoint();
+    auto disjoint_rhs = rhs->make_disjoint();
+
+    expect_bounded(SetOperation::MAKE_DISJOINT, lhs, nullptr, disjoint_lhs);
+    expect_bounded(SetOperation::INTERSECTION, disjoint_lhs, disjoint_rhs,
+                   disjoint_lhs->intersection_with(disjoint_rhs));
+    expect_bounded(SetOperation::DIFFERENCE, disjoint_lhs, disjoint_rhs, disjoint_lhs->difference_with(disjoint_rhs));
+    expect_bounded(SetOperation::UNION, disjoint_lhs, disjoint_rhs, disjoint_lhs->union_with(disjoint_rhs));
+    expect_bounded(SetOperation::COMPLEMENT, disjoint_rhs, nullptr, disjoint_rhs->complement());
+    expect_bounded(SetOperation::SIMPLIFY, disjoint_lhs, nullptr, disjoint_lhs->simplify());
+
+    auto intervals = closed(0, 4)->union_with(closed(6, 9));
+    auto other = closed(1, 2)->union_with(closed(3, 7));
+    expect_bounded(SetOperation::DIFFERENCE, intervals, other, intervals->difference_with(other));
+    expect_bounded(SetOperation::COMPLEMENT, other, nullptr, other->complement());
+}
+
+TEST(Estimate, GrowsWithTheOperands) {
+    auto small = estimate_cost(SetOperation::MAKE_DISJOINT, overlapping_boxes(20));
+    auto large = estimate_cost(SetOperation::MAKE_DISJOINT, overlapping_boxes(200));
+    EXPECT_LT(small.expected_pieces, large.expected_pieces);
+    EXPECT_LT(small.work, large.work);
+
+    EXPECT_THROW(estimate_cost(SetOperation::DIFFERENCE, overlapping_boxes(2)), std::invalid_argument);
+}
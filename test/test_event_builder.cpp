@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "event_builder.h"
+#include "interval.h"
+#include "set.h"
+#include "variable.h"
+#include <memory>
+
+// Helper: Overlapping boxes over a continuous and a symbolic variable.
+static std::vector<SimpleEventPtr_t> boxes(int count) {
+    auto x = make_shared_continuous("x");
+    auto elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), elements);
+    std::vector<SimpleEventPtr_t> result;
+    for (int k = 0; k < count; ++k) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed((k * 37) % 200, (k * 37) % 200 + 15)});
+        map->insert({a, make_shared_set(make_shared_set_element(k % 3, elements), elements)});
+        result.push_back(make_shared_simple_event(map));
+    }
+    return result;
+}
+
+TEST(EventBuilder, MatchesUnion) {
+    // enough boxes for several levels of the index
+    auto simple_events = boxes(400);
+    EventBuilder builder;
+    auto all = make_shared_simple_set_set();
+    for (auto const &simple_event : simple_events) {
+        builder.add(simple_event);
+        all->insert(simple_event);
+    }
+    auto built = builder.build();
+    EXPECT_EQ(built->simple_sets->size(), builder.size());
+    EXPECT_TRUE(built->is_known_disjoint());
+
+    auto expected = make_shared_event(all);
+    EXPECT_TRUE(built->difference_with(expected)->is_empty());
+    EXPECT_TRUE(expected->difference_with(built)->is_empty());
+
+    // the pieces are really disjoint
+    auto unchecked = make_shared_event(make_shared_simple_set_set(*built->simple_sets));
+    EXPECT_TRUE(unchecked->is_disjoint());
+}
+
+TEST(EventBuilder, SkipsCoveredAndEmptySimpleEvents) {
+    auto simple_events = boxes(3);
+    EventBuilder builder;
+    builder.add(simple_events[0]);
+    builder.add(simple_events[0]);
+    EXPECT_EQ(builder.size(), 1u);
+
+    auto map = std::make_shared<VariableMap>(*simple_events[1]->variable_map);
+    map->begin()->second = empty();
+    auto nothing = make_shared_simple_event(map);
+    builder.add(nothing);
+    EXPECT_EQ(builder.size(), 1u);
+
+    // adding whole events and continuing after build
+    auto first = builder.build();
+    builder.add(make_shared_event(simple_events[2]));
+    EXPECT_EQ(first->simple_sets->size(), 1u);
+    EXPECT_EQ(builder.build()->simple_sets->size(), 2u);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "flat_set.h"
+#include "interval.h"
+#include <vector>
+
+// Orders pairs by their first component only, such that equivalent but distinguishable elements can be inserted.
+struct FirstLess {
+    bool operator()(const std::pair<int, int> &lhs, const std::pair<int, int> &rhs) const {
+        return lhs.first < rhs.first;
+    }
+};
+
+TEST(FlatSet, InsertKeepsOrderAndUniqueness) {
+    FlatSet<int> set;
+    EXPECT_TRUE(set.insert(3).second);
+    EXPECT_TRUE(set.insert(1).second);
+    EXPECT_TRUE(set.insert(2).second);
+    EXPECT_FALSE(set.insert(2).second);
+    EXPECT_EQ(std::vector<int>(set.begin(), set.end()), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(*set.rbegin(), 3);
+    EXPECT_EQ(set[1], 2);
+
+    EXPECT_EQ(set.count(2), 1);
+    EXPECT_EQ(set.count(4), 0);
+    EXPECT_EQ(set.erase(2), 1);
+    EXPECT_EQ(set.erase(2), 0);
+    set.erase(std::prev(set.end()));
+    EXPECT_EQ(std::vector<int>(set.begin(), set.end()), (std::vector<int>{1}));
+}
+
+using Pairs = std::vector<std::pair<int, int>>;
+
+TEST(FlatSet, RangeInsertMerges) {
+    FlatSet<std::pair<int, int>, FirstLess> set;
+    set.insert({5, 0});
+    set.insert({1, 0});
+
+    // contained elements win over equivalent new ones, earlier new ones over later ones
+    Pairs more{{4, 1}, {1, 1}, {3, 1}, {4, 2}, {9, 1}, {0, 1}};
+    set.insert(more.begin(), more.end());
+    EXPECT_EQ(Pairs(set.begin(), set.end()), (Pairs{{0, 1}, {1, 0}, {3, 1}, {4, 1}, {5, 0}, {9, 1}}));
+
+    // elements behind all contained ones are appended
+    Pairs tail{{12, 1}, {10, 1}, {10, 2}};
+    set.insert(tail.begin(), tail.end());
+    EXPECT_EQ(set.size(), 8);
+    EXPECT_EQ(*set.find({10, 0}), (std::pair<int, int>{10, 1}));
+    EXPECT_EQ(set.find({11, 0}), set.end());
+}
+
+TEST(FlatSet, SimpleSetSet) {
+    auto simple_sets = make_shared_simple_set_set();
+    for (int k = 10; k > 0; --k) {
+        simple_sets->insert(SimpleInterval::make_shared(k, k + 1, BorderType::CLOSED, BorderType::OPEN));
+    }
+    simple_sets->insert(SimpleInterval::make_shared(3, 4, BorderType::OPEN, BorderType::OPEN));
+    EXPECT_EQ(simple_sets->size(), 10);
+    double lower = 0;
+    for (auto const &simple_set : *simple_sets) {
+        auto simple_interval = std::static_pointer_cast<SimpleInterval>(simple_set);
+        EXPECT_GT(simple_interval->lower, lower);
+        EXPECT_EQ(simple_interval->left, BorderType::CLOSED);
+        lower = simple_interval->lower;
+    }
+}
+
+TEST(FlatSet, VersionChangesWithEveryModification) {
+    FlatSet<int> set{1, 2, 3};
+    auto version = set.version();
+    EXPECT_FALSE(set.insert(2).second);
+    EXPECT_EQ(set.erase(7), 0);
+    EXPECT_EQ(set.version(), version);
+
+    // an edit that keeps the size still changes the version
+    set.erase(3);
+    set.insert(4);
+    EXPECT_NE(set.version(), version);
+
+    // copies share the version, new and moved-from sets do not
+    FlatSet<int> copy(set);
+    EXPECT_EQ(copy.version(), set.version());
+    FlatSet<int> moved(std::move(copy));
+    EXPECT_EQ(moved.version(), set.version());
+    EXPECT_NE(copy.version(), set.version());
+    EXPECT_NE(FlatSet<int>{}.version(), FlatSet<int>{}.version());
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "generator.h"
+#include "interval.h"
+#include "product_algebra.h"
+#include "test_helpers.h"
+#include "variable.h"
+#include <memory>
+
+// Helper: Collect the pieces of a generator through its iterators, without marking the result disjoint.
+static AbstractCompositeSetPtr_t drain(const PieceGeneratorPtr_t &generator, const AbstractCompositeSetPtr_t &empty) {
+    for (auto const &piece : *generator) {
+        empty->simple_sets->insert(piece);
+    }
+    return empty;
+}
+
+TEST(Generator, SimpleEventComplement) {
+    auto event = overlapping_boxes(1);
+    auto simple_event = (*event->simple_sets)[0];
+    auto lazy = drain(simple_event->complement_pieces(), make_shared_event());
+    auto eager = make_shared_event(simple_event->complement());
+    EXPECT_EQ(*lazy, *eager);
+}
+
+TEST(Generator, Complement) {
+    auto event = overlapping_boxes(30);
+    auto lazy = drain(generate_complement(event), make_shared_event());
+    EXPECT_TRUE(lazy->is_disjoint());
+    expect_equivalent(lazy, event->complement());
+    EXPECT_TRUE(lazy->intersection_with(event)->is_empty());
+
+    auto interval = closed(0, 1)->union_with(closed(3, 4));
+    auto lazy_interval = generate_complement(interval)->collect(interval->make_new_empty());
+    EXPECT_EQ(*lazy_interval, *interval->complement());
+
+    EXPECT_EQ(generate_complement(make_shared_event())->count(), 0u);
+}
+
+TEST(Generator, Difference) {
+    auto lhs = overlapping_boxes(30);
+    auto rhs = overlapping_boxes(20, 10);
+    auto lazy = drain(generate_difference(lhs, rhs), make_shared_event());
+    EXPECT_TRUE(lazy->is_disjoint());
+    expect_equivalent(lazy, lhs->difference_with(rhs));
+
+    // a disjoint left hand side is not carved by itself
+    auto disjoint = lhs->make_disjoint();
+    auto lazy_disjoint = drain(generate_difference(disjoint, rhs), make_shared_event());
+    EXPECT_TRUE(lazy_disjoint->is_disjoint());
+    expect_equivalent(lazy_disjoint, lazy);
+
+    auto intervals = closed(0, 10);
+    auto holes = closed(1, 2)->union_with(closed(5, 6));
+    EXPECT_EQ(*generate_difference(intervals, holes)->collect(intervals->make_new_empty()),
+              *intervals->difference_with(holes));
+}
+
+TEST(Generator, Iteration) {
+    auto generator = generate_complement(overlapping_boxes(10));
+
+    // consumers can stop early and continue later
+    auto first = generator->next();
+    ASSERT_NE(first, nullptr);
+    auto remaining = generator->count();
+    EXPECT_GT(remaining, 0u);
+    EXPECT_EQ(generator->next(), nullptr);
+    EXPECT_TRUE(generator->begin() == generator->end());
+}
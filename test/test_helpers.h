@@ -0,0 +1,46 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "interval.h"
+#include "product_algebra.h"
+#include "variable.h"
+#include <memory>
+
+// Helpers shared by the tests of the set operations.
+
+/**
+ * The k-th of many overlapping boxes over the continuous variables x and y.
+ *
+ * @param k The number of the box.
+ * @param offset The shift of the box along x.
+ * @return The box.
+ */
+inline SimpleEventPtr_t overlapping_box(int k, double offset = 0) {
+    static auto x = make_shared_continuous("x");
+    static auto y = make_shared_continuous("y");
+    auto map = std::make_shared<VariableMap>();
+    map->insert({x, closed(offset + (k * 37) % 100, offset + (k * 37) % 100 + 20)});
+    map->insert({y, closed((k * 11) % 50, (k * 11) % 50 + 20)});
+    return make_shared_simple_event(map);
+}
+
+/**
+ * @param count The number of boxes.
+ * @param offset The shift of the boxes along x.
+ * @return The event of the first boxes of `overlapping_box`.
+ */
+inline EventPtr_t overlapping_boxes(int count, double offset = 0) {
+    auto boxes = make_shared_simple_set_set();
+    for (int k = 0; k < count; ++k) {
+        boxes->insert(overlapping_box(k, offset));
+    }
+    return make_shared_event(boxes);
+}
+
+/**
+ * Check that two composite sets contain the same elements.
+ */
+inline void expect_equivalent(const AbstractCompositeSetPtr_t &lhs, const AbstractCompositeSetPtr_t &rhs) {
+    EXPECT_TRUE(lhs->difference_with(rhs)->is_empty());
+    EXPECT_TRUE(rhs->difference_with(lhs)->is_empty());
+}
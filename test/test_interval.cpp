@@ -100,6 +100,32 @@ TEST(AtomicIntervalDifferenceTest, SimpleInterval) {
     EXPECT_TRUE(compare_sets(difference_from_middle_element, difference_from_middle_element_by_hand));
 }
 
+TEST(AtomicIntervalDifferenceBordersTest, SimpleInterval) {
+    auto closed_interval = SimpleInterval::make_shared(0., 1., BorderType::CLOSED, BorderType::CLOSED);
+    auto open_interval = SimpleInterval::make_shared(0., 1., BorderType::OPEN, BorderType::OPEN);
+
+    // removing the open interior leaves both end points
+    auto end_points = closed_interval->difference_with(open_interval);
+    auto end_points_by_hand = make_shared_simple_set_set();
+    end_points_by_hand->insert(SimpleInterval::make_shared(0., 0., BorderType::CLOSED, BorderType::CLOSED));
+    end_points_by_hand->insert(SimpleInterval::make_shared(1., 1., BorderType::CLOSED, BorderType::CLOSED));
+    EXPECT_TRUE(compare_sets(end_points, end_points_by_hand));
+
+    // touching in a single closed point removes that point only
+    auto touching = SimpleInterval::make_shared(1., 2., BorderType::CLOSED, BorderType::CLOSED);
+    auto without_point = closed_interval->difference_with(touching);
+    EXPECT_EQ(without_point->size(), 1);
+    EXPECT_TRUE(**without_point->begin() ==
+                *SimpleInterval::make_shared(0., 1., BorderType::CLOSED, BorderType::OPEN));
+
+    // unbounded intervals
+    auto real_line = SimpleInterval::make_shared(-std::numeric_limits<double>::infinity(),
+                                                 std::numeric_limits<double>::infinity(),
+                                                 BorderType::OPEN, BorderType::OPEN);
+    EXPECT_TRUE(compare_sets(real_line->difference_with(closed_interval), closed_interval->complement()));
+    EXPECT_TRUE(closed_interval->difference_with(real_line)->empty());
+}
+
 // TEST(SimplifyIntervalTestSuite, Interval) {
 //     auto interval1 = SimpleInterval<>::make_shared(0.0, 1.0, BorderType::OPEN, BorderType::OPEN);
 //     auto interval2 = SimpleInterval<>::make_shared(0.5, 1.5, BorderType::OPEN, BorderType::OPEN);
@@ -160,6 +186,143 @@ TEST(IntervalMakeDisjointTestSuite, Interval) {
     EXPECT_TRUE(disjoint_interval->is_disjoint());
 }
 
+TEST(IntervalSimplifySharedTestSuite, Interval) {
+    auto interval1 = SimpleInterval::make_shared(0.0, 3.0, BorderType::CLOSED, BorderType::CLOSED);
+    auto interval2 = SimpleInterval::make_shared(1.0, 2.0, BorderType::OPEN, BorderType::OPEN);
+    auto interval3 = SimpleInterval::make_shared(3.0, 4.0, BorderType::OPEN, BorderType::OPEN);
+    auto intervals = make_shared_simple_set_set();
+    intervals->insert(interval1);
+    intervals->insert(interval2);
+    intervals->insert(interval3);
+
+    auto simplified = Interval::make_shared(intervals)->simplify();
+    EXPECT_EQ(*simplified, *closed_open(0, 4));
+
+    // the simple intervals may be shared with other sets and are left untouched
+    EXPECT_EQ(interval1->upper, 3.0);
+    EXPECT_EQ(interval1->right, BorderType::CLOSED);
+}
+
+TEST(IntervalRemoveDominatedTestSuite, Interval) {
+    auto outer = SimpleInterval::make_shared(0.0, 5.0, BorderType::CLOSED, BorderType::OPEN);
+    auto inner = SimpleInterval::make_shared(1.0, 2.0, BorderType::CLOSED, BorderType::CLOSED);
+    auto touching = SimpleInterval::make_shared(3.0, 5.0, BorderType::OPEN, BorderType::CLOSED);
+    auto separate = SimpleInterval::make_shared(6.0, 7.0, BorderType::OPEN, BorderType::OPEN);
+
+    EXPECT_TRUE(inner->is_subset_of(outer));
+    EXPECT_FALSE(outer->is_subset_of(inner));
+    EXPECT_FALSE(touching->is_subset_of(outer));
+
+    auto intervals = make_shared_simple_set_set();
+    intervals->insert(outer);
+    intervals->insert(inner);
+    intervals->insert(touching);
+    intervals->insert(separate);
+    auto interval = Interval::make_shared(intervals);
+
+    EXPECT_EQ(interval->remove_dominated_simple_sets(), 1);
+    EXPECT_EQ(interval->simple_sets->size(), 3);
+    EXPECT_EQ(interval->simple_sets->count(inner), 0);
+}
+
+TEST(IntervalInvariantsTestSuite, Interval) {
+    auto interval = closed(0, 1);
+    ASSERT_TRUE(interval->is_known_disjoint());
+
+    // inserting outside of the hull keeps the interval disjoint
+    interval->add_new_simple_set(SimpleInterval::make_shared(2.0, 3.0, BorderType::CLOSED, BorderType::CLOSED));
+    ASSERT_TRUE(interval->is_known_disjoint());
+    auto hull = std::static_pointer_cast<SimpleInterval>(interval->get_hull());
+    ASSERT_EQ(hull->lower, 0);
+    ASSERT_EQ(hull->upper, 3);
+
+    interval->add_new_simple_set(SimpleInterval::make_shared(2.5, 4.0, BorderType::OPEN, BorderType::CLOSED));
+    ASSERT_FALSE(interval->is_known_disjoint());
+    ASSERT_FALSE(interval->is_disjoint());
+
+    auto simplified = interval->simplify();
+    ASSERT_TRUE(simplified->is_known_simplified());
+    ASSERT_TRUE(simplified->is_known_disjoint());
+    ASSERT_EQ(*simplified->simplify(), *simplified);
+}
+
+TEST(IntervalInvariantsInPlaceEditTestSuite, Interval) {
+    auto interval = closed(0, 1)->union_with(closed(2, 3));
+    ASSERT_TRUE(interval->is_disjoint());
+    ASSERT_NE(interval->get_hull(), nullptr);
+
+    // an edit that keeps the number of simple sets must not keep the cached invariants
+    interval->simple_sets->erase(SimpleInterval::make_shared(2.0, 3.0, BorderType::CLOSED, BorderType::CLOSED));
+    interval->simple_sets->insert(SimpleInterval::make_shared(0.5, 2.5, BorderType::CLOSED, BorderType::CLOSED));
+    ASSERT_FALSE(interval->is_known_disjoint());
+    ASSERT_FALSE(interval->is_disjoint());
+    ASSERT_EQ(*interval->make_disjoint()->simplify(), *closed(0, 2.5));
+    ASSERT_FALSE(interval->intersection_with(closed(2.2, 2.4))->is_empty());
+
+    // so must replacing the simple sets
+    interval->simple_sets = make_shared_simple_set_set(*closed(7, 8)->simple_sets);
+    ASSERT_EQ(*interval->union_with(closed(0, 1)), *closed(0, 1)->union_with(closed(7, 8)));
+}
+
+TEST(IntervalHullFastPathTestSuite, Interval) {
+    auto &statistics = operation_statistics();
+    statistics.reset();
+
+    auto left = closed(0, 1)->union_with(closed(2, 3));
+    auto right = closed(5, 6);
+    auto united = left->union_with(right);
+    ASSERT_EQ(statistics.hull_fast_paths, 2);
+    ASSERT_TRUE(united->is_known_disjoint());
+    ASSERT_EQ(united->simple_sets->size(), 3);
+
+    ASSERT_TRUE(left->intersection_with(right)->is_empty());
+    ASSERT_EQ(*left->difference_with(right), *left);
+    ASSERT_EQ(statistics.hull_fast_paths, 4);
+
+    // overlapping hulls take the regular path
+    ASSERT_EQ(*left->union_with(open(1, 2)), *closed(0, 3));
+    ASSERT_EQ(statistics.hull_fast_paths, 4);
+}
+
+TEST(IntervalPredicatesTestSuite, Interval) {
+    auto left = closed_open(0, 1);
+    auto touching = closed(1, 2);
+    auto gap = open(1, 2);
+    auto separate = closed(0, 1)->union_with(closed(3, 4));
+
+    EXPECT_FALSE(left->intersects(touching));
+    EXPECT_TRUE(left->is_disjoint_from(touching));
+    EXPECT_TRUE(closed(0, 1)->intersects(touching));
+    EXPECT_FALSE(separate->intersects(gap));
+    EXPECT_TRUE(separate->intersects(closed(2, 3)));
+    EXPECT_TRUE(separate->intersects(closed(4, 5)));
+
+    // simple intervals that end at the same value share it only if both include it
+    auto split = Interval::make_shared();
+    split->simple_sets->insert(SimpleInterval::make_shared(0, 1, BorderType::CLOSED, BorderType::OPEN));
+    split->simple_sets->insert(SimpleInterval::make_shared(1, 2, BorderType::CLOSED, BorderType::CLOSED));
+    split->mark_disjoint();
+    EXPECT_TRUE(split->intersects(singleton(1)));
+    EXPECT_TRUE(singleton(1)->intersects(split));
+    EXPECT_TRUE(split->intersects(open_closed(0.5, 1)));
+    EXPECT_TRUE(open_closed(0.5, 1)->intersects(split));
+    EXPECT_FALSE(split->intersects(open(2, 3)));
+    EXPECT_FALSE(closed_open(-1, 0)->union_with(open(2, 3))->intersects(split));
+
+    // the subset may be covered by several simple intervals only
+    auto pieces = closed_open(0, 1)->union_with(closed_open(1, 2))->union_with(closed(2, 3));
+    auto not_merged = Interval::make_shared(make_shared_simple_set_set(*pieces->simple_sets));
+    not_merged->add_new_simple_set(SimpleInterval::make_shared(1.5, 2.5, BorderType::OPEN, BorderType::OPEN));
+    EXPECT_TRUE(closed(0, 3)->is_subset_of(pieces));
+    EXPECT_TRUE(closed(0.5, 2.7)->is_subset_of(not_merged));
+    EXPECT_FALSE(closed(0, 3.5)->is_subset_of(pieces));
+    EXPECT_FALSE(open_closed(-1, 0)->is_subset_of(pieces));
+    EXPECT_FALSE(separate->is_subset_of(closed(0, 3.5)));
+    EXPECT_TRUE(separate->is_subset_of(closed(-1, 5)));
+    EXPECT_TRUE(closed(-1, 5)->contains(separate));
+    EXPECT_TRUE(Interval::make_shared()->is_subset_of(left));
+}
+
 TEST(IntervalIntersectionSimple, Interval) {
     auto interval1 = SimpleInterval::make_shared(0.0, 1.0, BorderType::CLOSED, BorderType::CLOSED);
     auto interval2 = SimpleInterval::make_shared(2.0, 3.0, BorderType::CLOSED, BorderType::CLOSED);
@@ -249,3 +412,29 @@ TEST(IntervalDifference, Interval) {
     EXPECT_EQ(difference_2->simple_sets->size(), 1);
     EXPECT_TRUE(difference_2->is_disjoint());
 }
+
+TEST(IntervalSplitTestSuite, RemaindersAvoidAllIntersections) {
+    // (0, 5] lies inside [0, 4] ∪ [2, 5], but its intersection with [5, 9) still has to be cut out of [5, 9)
+    auto intervals = make_shared_simple_set_set();
+    intervals->insert(SimpleInterval::make_shared(0, 4, BorderType::CLOSED, BorderType::CLOSED));
+    intervals->insert(SimpleInterval::make_shared(0, 5, BorderType::OPEN, BorderType::CLOSED));
+    intervals->insert(SimpleInterval::make_shared(2, 5, BorderType::CLOSED, BorderType::CLOSED));
+    intervals->insert(SimpleInterval::make_shared(5, 9, BorderType::CLOSED, BorderType::OPEN));
+    intervals->insert(SimpleInterval::make_shared(7, 9, BorderType::CLOSED, BorderType::CLOSED));
+    intervals->insert(SimpleInterval::make_shared(9, 13, BorderType::OPEN, BorderType::CLOSED));
+    auto interval = Interval::make_shared(intervals);
+
+    auto [disjoint, non_disjoint] = interval->split_into_disjoint_and_non_disjoint();
+    std::vector<AbstractSimpleSetPtr_t> pieces(disjoint->simple_sets->begin(), disjoint->simple_sets->end());
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        for (size_t j = i + 1; j < pieces.size(); ++j) {
+            EXPECT_FALSE(pieces[i]->intersects(pieces[j]));
+        }
+        for (auto const &intersection : *non_disjoint->simple_sets) {
+            EXPECT_FALSE(pieces[i]->intersects(intersection));
+        }
+    }
+
+    auto result = interval->make_disjoint();
+    EXPECT_EQ(*result->to_string(), "[0.000000, 13.000000]");
+}
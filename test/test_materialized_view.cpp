@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "interval.h"
+#include "materialized_view.h"
+#include "product_algebra.h"
+#include "test_helpers.h"
+#include "variable.h"
+#include <memory>
+#include <stdexcept>
+
+// Helper: The event of the boxes with the given numbers.
+static EventPtr_t boxes(const std::vector<int> &numbers) {
+    auto simple_sets = make_shared_simple_set_set();
+    for (int k : numbers) {
+        simple_sets->insert(overlapping_box(k));
+    }
+    return make_shared_event(simple_sets);
+}
+
+// Helper: Remove the number of a box from a list of numbers.
+static void remove_box(std::vector<int> &numbers, const AbstractSimpleSetPtr_t &simple_set) {
+    for (auto number = numbers.begin(); number != numbers.end(); ++number) {
+        if (*overlapping_box(*number) == *simple_set) {
+            numbers.erase(number);
+            return;
+        }
+    }
+}
+
+// Helper: Recompute the operation from scratch.
+static AbstractCompositeSetPtr_t recompute(SetOperation operation, const EventPtr_t &lhs, const EventPtr_t &rhs) {
+    switch (operation) {
+        case SetOperation::INTERSECTION:
+            return lhs->intersection_with(rhs);
+        case SetOperation::UNION:
+            return lhs->union_with(rhs);
+        case SetOperation::DIFFERENCE:
+            return lhs->difference_with(rhs);
+        default:
+            return lhs->complement();
+    }
+}
+
+TEST(MaterializedView, FollowsChangesOfBothOperands) {
+    for (auto operation: {SetOperation::INTERSECTION, SetOperation::UNION, SetOperation::DIFFERENCE,
+                          SetOperation::COMPLEMENT}) {
+        std::vector<int> left{0, 1, 2, 3};
+        std::vector<int> right{4, 5, 6};
+        MaterializedView view(operation, boxes(left), boxes(right));
+        expect_equivalent(view.result(), recompute(operation, boxes(left), boxes(right)));
+
+        // add boxes, then remove some of the original ones; their ids follow the order of the simple sets
+        for (int k = 7; k < 12; ++k) {
+            bool to_left = operation == SetOperation::COMPLEMENT || k % 2 == 0;
+            view.insert(to_left ? ViewInput::LHS : ViewInput::RHS, overlapping_box(k));
+            (to_left ? left : right).push_back(k);
+            expect_equivalent(view.result(), recompute(operation, boxes(left), boxes(right)));
+        }
+        view.erase(ViewInput::LHS, 1);
+        remove_box(left, (*boxes({0, 1, 2, 3})->simple_sets)[1]);
+        expect_equivalent(view.result(), recompute(operation, boxes(left), boxes(right)));
+        if (operation != SetOperation::COMPLEMENT) {
+            view.erase(ViewInput::RHS, 0);
+            remove_box(right, (*boxes({4, 5, 6})->simple_sets)[0]);
+            expect_equivalent(view.result(), recompute(operation, boxes(left), boxes(right)));
+        }
+        EXPECT_EQ(view.size(), view.result()->simple_sets->size());
+    }
+}
+
+TEST(MaterializedView, ManySmallChanges) {
+    // enough pieces to fill several levels of the index and to rebuild it after most of them are erased
+    static auto x = make_shared_continuous("x");
+    static auto y = make_shared_continuous("y");
+    auto cell = [](int k) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed(k % 20 * 5, k % 20 * 5 + 1)});
+        map->insert({y, closed(k / 20 * 5, k / 20 * 5 + 1)});
+        return make_shared_simple_event(map);
+    };
+    for (auto operation: {SetOperation::INTERSECTION, SetOperation::DIFFERENCE}) {
+        std::vector<int> left{0, 1, 2, 3};
+        MaterializedView view(operation, boxes(left), make_shared_event());
+        std::vector<size_t> ids;
+        for (int k = 0; k < 300; ++k) {
+            ids.push_back(view.insert(ViewInput::RHS, cell(k)));
+        }
+        auto right = make_shared_event();
+        for (int k = 0; k < 300; ++k) {
+            if (k % 5 != 0) {
+                view.erase(ViewInput::RHS, ids[k]);
+            } else {
+                right->simple_sets->insert(cell(k));
+            }
+        }
+        view.insert(ViewInput::RHS, cell(7));
+        right->simple_sets->insert(cell(7));
+        expect_equivalent(view.result(), recompute(operation, boxes(left), right));
+    }
+}
+
+TEST(MaterializedView, MarksDisjointResults) {
+    auto lhs = make_shared_event(boxes({0, 1, 2})->make_disjoint()->simple_sets);
+    auto rhs = boxes({3});
+    MaterializedView view(SetOperation::DIFFERENCE, lhs, rhs);
+    EXPECT_TRUE(view.result()->is_known_disjoint());
+    auto unchecked = make_shared_event(make_shared_simple_set_set(*view.result()->simple_sets));
+    EXPECT_TRUE(unchecked->is_disjoint());
+
+    // an overlapping piece in lhs makes the result possibly overlapping until it is removed
+    auto id = view.insert(ViewInput::LHS, overlapping_box(0));
+    EXPECT_FALSE(view.result()->is_known_disjoint());
+    view.erase(ViewInput::LHS, id);
+    EXPECT_TRUE(view.result()->is_known_disjoint());
+    EXPECT_EQ(view.ids(ViewInput::RHS), std::vector<size_t>{0});
+}
+
+TEST(MaterializedView, ComplementOfEmptyAndInvalidArguments) {
+    MaterializedView view(SetOperation::COMPLEMENT, make_shared_event());
+    EXPECT_TRUE(view.result()->is_empty());
+    auto id = view.insert(ViewInput::LHS, overlapping_box(0));
+    expect_equivalent(view.result(), boxes({0})->complement());
+    view.erase(ViewInput::LHS, id);
+    EXPECT_TRUE(view.result()->is_empty());
+
+    EXPECT_THROW(view.erase(ViewInput::LHS, id), std::invalid_argument);
+    EXPECT_THROW(view.insert(ViewInput::RHS, overlapping_box(1)), std::invalid_argument);
+    EXPECT_THROW(MaterializedView(SetOperation::DIFFERENCE, boxes({0})), std::invalid_argument);
+    EXPECT_THROW(MaterializedView(SetOperation::SIMPLIFY, boxes({0})), std::invalid_argument);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "parallel.h"
+#include "product_algebra.h"
+#include "interval.h"
+#include "variable.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Helper: Run a test body with some parallel options and restore the previous ones afterwards.
+template<typename Function>
+void with_parallel_options(size_t threads, size_t sequential_cutoff, Function &&function) {
+    auto previous = get_parallel_options();
+    ParallelOptions options;
+    options.threads = threads;
+    options.sequential_cutoff = sequential_cutoff;
+    set_parallel_options(options);
+    function();
+    set_parallel_options(previous);
+}
+
+TEST(Parallel, ForVisitsEveryIndexOnce) {
+    with_parallel_options(4, 2, []() {
+        std::vector<std::atomic<int>> visits(1000);
+        parallel_for(visits.size(), [&](size_t index) { visits[index] += 1; }, 7);
+        for (auto const &visit : visits) {
+            EXPECT_EQ(visit.load(), 1);
+        }
+
+        // nested loops wait only for running chunks and cannot deadlock
+        std::atomic<size_t> inner{0};
+        parallel_for(16, [&](size_t) {
+            parallel_for(16, [&](size_t) { inner += 1; });
+        });
+        EXPECT_EQ(inner.load(), 256);
+    });
+}
+
+TEST(Parallel, ForRethrows) {
+    with_parallel_options(4, 2, []() {
+        EXPECT_THROW(parallel_for(100, [](size_t index) {
+            if (index == 42) {
+                throw std::invalid_argument("42");
+            }
+        }), std::invalid_argument);
+    });
+}
+
+TEST(Parallel, MakeDisjointIsDeterministic) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    auto intervals = make_shared_simple_set_set();
+    auto boxes = make_shared_simple_set_set();
+    for (int k = 0; k < 200; ++k) {
+        double lower = (k * 37) % 150;
+        intervals->insert(SimpleInterval::make_shared(lower, lower + 3 + k % 5, BorderType::CLOSED, BorderType::OPEN));
+
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed(lower, lower + 10)});
+        map->insert({y, closed((k * 13) % 50, (k * 13) % 50 + 10)});
+        boxes->insert(make_shared_simple_event(map));
+    }
+
+    auto disjoint_pieces = [&]() {
+        auto interval = Interval::make_shared(make_shared_simple_set_set(*intervals))->make_disjoint();
+        auto event = make_shared_event(make_shared_simple_set_set(*boxes))->make_disjoint();
+        return std::make_pair(*interval->to_string(), *event->to_string());
+    };
+
+    std::pair<std::string, std::string> sequential;
+    with_parallel_options(1, 32, [&]() { sequential = disjoint_pieces(); });
+    with_parallel_options(4, 2, [&]() { EXPECT_EQ(disjoint_pieces(), sequential); });
+    with_parallel_options(0, 32, [&]() { EXPECT_EQ(disjoint_pieces(), sequential); });
+}
+
+TEST(Parallel, IntersectionAndDifferenceAreDeterministic) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    auto make_event = [&](int offset) {
+        auto boxes = make_shared_simple_set_set();
+        for (int k = 0; k < 60; ++k) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({x, closed(k * 2 + offset, k * 2 + offset + 1)});
+            map->insert({y, closed((k * 7 + offset) % 20, (k * 7 + offset) % 20 + 3)});
+            boxes->insert(make_shared_simple_event(map));
+        }
+        return make_shared_event(boxes);
+    };
+    auto lhs = make_event(0);
+    auto rhs = make_event(1);
+
+    auto results = [&]() {
+        return std::make_pair(*lhs->intersection_with(rhs)->to_string(), *lhs->difference_with(rhs)->to_string());
+    };
+
+    std::pair<std::string, std::string> sequential;
+    with_parallel_options(1, 32, [&]() { sequential = results(); });
+    with_parallel_options(4, 2, [&]() { EXPECT_EQ(results(), sequential); });
+    EXPECT_FALSE(lhs->intersection_with(rhs)->is_empty());
+}
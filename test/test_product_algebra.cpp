@@ -5,6 +5,7 @@
 #include "sigma_algebra.h"
 #include "variable.h"
 #include <memory>
+#include <thread>
 
 auto all_elements_int = make_shared_all_elements(std::set<long long>{0, 1, 2});
 
@@ -281,3 +282,554 @@ TEST(ProductAlgebra, UnionDifferentVariables) {
 
     ASSERT_TRUE(*union_event == *expected_result);
 }
+
+TEST(ProductAlgebra, ComplementOrdering) {
+    auto sab = make_shared_simple_set_set();
+    sab->insert(s0);
+    sab->insert(s1);
+
+    auto a = make_shared_continuous("a");
+    auto b = make_shared_symbolic(std::make_shared<std::string>("b"), all_elements_int);
+
+    auto a_assignment = closed(0, 1)->union_with(closed(2, 3));
+
+    auto variables = std::make_shared<VariableMap>();
+    variables->insert({a, a_assignment});
+    variables->insert({b, make_shared_set(sab, all_elements_int)});
+    auto event = make_shared_simple_event(variables);
+
+    auto by_name = event->complement(name_ordering);
+    auto by_cost = event->complement(cost_aware_ordering);
+    ASSERT_EQ(by_name->size(), 2);
+    ASSERT_EQ(by_cost->size(), 2);
+
+    // name order peels 'a' first, hence one piece has the complement of 'a' and the full domain of 'b'
+    auto by_name_expected = std::make_shared<VariableMap>();
+    by_name_expected->insert({a, a_assignment->complement()});
+    by_name_expected->insert({b, b->domain});
+    ASSERT_EQ(by_name->count(make_shared_simple_event(by_name_expected)), 1);
+
+    // the cheap complement of 'b' is peeled first, hence one piece leaves 'a' unconstrained
+    auto by_cost_expected = std::make_shared<VariableMap>();
+    by_cost_expected->insert({a, a->domain});
+    by_cost_expected->insert({b, make_shared_set(s2, all_elements_int)});
+    ASSERT_EQ(by_cost->count(make_shared_simple_event(by_cost_expected)), 1);
+
+    for (const auto &piece: *by_cost) {
+        ASSERT_TRUE(piece->intersection_with(event)->is_empty());
+    }
+}
+
+TEST(ProductAlgebra, SimpleEventDifference) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    auto map_a = std::make_shared<VariableMap>();
+    map_a->insert({x, closed(0, 2)});
+    map_a->insert({y, closed(0, 2)});
+    auto a = make_shared_simple_event(map_a);
+
+    auto map_b = std::make_shared<VariableMap>();
+    map_b->insert({x, closed(1, 3)});
+    map_b->insert({y, closed(-1, 1)});
+    auto b = make_shared_simple_event(map_b);
+
+    auto difference = a->difference_with(b);
+
+    auto expected_1 = std::make_shared<VariableMap>();
+    expected_1->insert({x, closed_open(0, 1)});
+    expected_1->insert({y, closed(0, 2)});
+
+    auto expected_2 = std::make_shared<VariableMap>();
+    expected_2->insert({x, closed(1, 2)});
+    expected_2->insert({y, open_closed(1, 2)});
+
+    auto expected = make_shared_simple_set_set();
+    expected->insert(make_shared_simple_event(expected_1));
+    expected->insert(make_shared_simple_event(expected_2));
+    ASSERT_TRUE(compare_sets(difference, expected));
+
+    // disjoint boxes leave a untouched
+    auto map_c = std::make_shared<VariableMap>();
+    map_c->insert({x, closed(5, 6)});
+    auto c = make_shared_simple_event(map_c);
+    auto untouched = a->difference_with(c);
+    ASSERT_EQ(untouched->size(), 1);
+    ASSERT_EQ(*untouched->begin(), a);
+
+    // a box that contains a removes everything; y is not constrained by d
+    auto map_d = std::make_shared<VariableMap>();
+    map_d->insert({x, closed(-1, 3)});
+    auto d = make_shared_simple_event(map_d);
+    ASSERT_TRUE(a->difference_with(d)->empty());
+
+    // the generic and the specialised kernel agree on the composite level
+    auto event_difference = make_shared_event(a)->difference_with(make_shared_event(b));
+    ASSERT_TRUE(event_difference->intersection_with(make_shared_event(b))->is_empty());
+    ASSERT_EQ(event_difference->simple_sets->size(), 2);
+}
+
+TEST(ProductAlgebra, ContainsPoints) {
+    auto x = make_shared_continuous("x");
+    auto n = make_shared_integer("n");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    // {x ∈ [0, 1), n ∈ [2, 4], a ∈ {0}} ∪ {x ∈ (5, 6] ∪ [7, 8], n ∈ R, a ∈ {1, 2}}
+    auto map1 = std::make_shared<VariableMap>();
+    map1->insert({x, closed_open(0, 1)});
+    map1->insert({n, closed(2, 4)});
+    map1->insert({a, make_shared_set(s0, all_elements_int)});
+
+    auto sbc = make_shared_simple_set_set();
+    sbc->insert(s1);
+    sbc->insert(s2);
+    auto map2 = std::make_shared<VariableMap>();
+    map2->insert({x, open_closed(5, 6)->union_with(closed(7, 8))});
+    map2->insert({n, n->domain});
+    map2->insert({a, make_shared_set(sbc, all_elements_int)});
+
+    auto simple_events = make_shared_simple_set_set();
+    simple_events->insert(make_shared_simple_event(map1));
+    simple_events->insert(make_shared_simple_event(map2));
+    auto event = make_shared_event(simple_events);
+
+    std::vector<double> xs =       {0.5, 1.0, 0.0, 5.0, 5.5, 7.0, 6.5, 0.5, 0.5};
+    std::vector<std::int64_t> ns = {3,   3,   2,   0,   100, -7,  0,   5,   3};
+    std::vector<std::int64_t> as = {0,   0,   0,   1,   2,   1,   1,   0,   1};
+    std::vector<std::uint8_t> expected = {1, 0, 1, 0, 1, 1, 0, 0, 0};
+
+    ColumnMap columns;
+    columns[x] = xs.data();
+    columns[n] = ns.data();
+    columns[a] = as.data();
+
+    ASSERT_EQ(event->contains_points(columns, xs.size()), expected);
+
+    // the second simple event does not constrain n, but the first one does
+    columns.erase(n);
+    ASSERT_THROW(event->contains_points(columns, xs.size()), std::invalid_argument);
+
+    // symbolic columns must be element indices
+    columns[n] = ns.data();
+    columns[a] = xs.data();
+    ASSERT_THROW(event->contains_points(columns, xs.size()), std::invalid_argument);
+}
+
+TEST(ProductAlgebra, MakeDisjoint) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    // overlapping boxes on a small grid, so that the result can be checked point by point
+    auto simple_events = make_shared_simple_set_set();
+    for (int k = 0; k < 12; ++k) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed((k * 7) % 10, (k * 7) % 10 + 4)});
+        map->insert({y, closed_open((k * 3) % 8, (k * 3) % 8 + 5)});
+        map->insert({a, make_shared_set(k % 2 == 0 ? s0 : s1, all_elements_int)});
+        simple_events->insert(make_shared_simple_event(map));
+    }
+    auto event = make_shared_event(simple_events);
+
+    auto disjoint = std::static_pointer_cast<Event>(event->make_disjoint());
+    ASSERT_TRUE(disjoint->is_disjoint());
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<std::int64_t> as;
+    for (int i = -2; i <= 30; ++i) {
+        for (int j = -2; j <= 28; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                xs.push_back(i / 2.);
+                ys.push_back(j / 2.);
+                as.push_back(k);
+            }
+        }
+    }
+    ColumnMap columns;
+    columns[x] = xs.data();
+    columns[y] = ys.data();
+    columns[a] = as.data();
+    ASSERT_EQ(disjoint->contains_points(columns, xs.size()), event->contains_points(columns, xs.size()));
+
+    // the input is left untouched
+    ASSERT_EQ(event->simple_sets->size(), 12);
+
+    // simple events that do not overlap are kept
+    auto separate = make_shared_event(std::static_pointer_cast<SimpleEvent>(*simple_events->begin()));
+    auto map = std::make_shared<VariableMap>();
+    map->insert({x, closed(20, 21)});
+    map->insert({y, closed(20, 21)});
+    map->insert({a, make_shared_set(s2, all_elements_int)});
+    separate->simple_sets->insert(make_shared_simple_event(map));
+    ASSERT_EQ(*separate->make_disjoint(), *separate);
+}
+
+TEST(ProductAlgebra, Marginal) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    // a 4 x 4 grid of disjoint boxes, all projections onto x repeat four times
+    auto simple_events = make_shared_simple_set_set();
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({x, closed_open(i, i + 1)});
+            map->insert({y, closed_open(j, j + 1)});
+            simple_events->insert(make_shared_simple_event(map));
+        }
+    }
+    auto event = make_shared_event(simple_events);
+    auto only_x = make_shared_variable_set(VariableSet{x});
+
+    auto expected_map = std::make_shared<VariableMap>();
+    expected_map->insert({x, closed_open(0, 4)});
+    auto expected = make_shared_event(make_shared_simple_event(expected_map));
+
+    auto marginal = event->marginal(only_x);
+    ASSERT_EQ(*marginal, *expected);
+
+    // cached results are handed out as new events
+    auto cached = event->marginal(only_x);
+    ASSERT_NE(cached, marginal);
+    ASSERT_EQ(*cached, *expected);
+    cached->simple_sets->clear();
+    ASSERT_EQ(*event->marginal(only_x), *expected);
+
+    // changing the simple events invalidates the cache
+    auto map = std::make_shared<VariableMap>();
+    map->insert({x, closed(10, 11)});
+    map->insert({y, closed(0, 1)});
+    event->simple_sets->insert(make_shared_simple_event(map));
+    ASSERT_EQ(event->marginal(only_x)->simple_sets->size(), 1);
+    ASSERT_TRUE(std::static_pointer_cast<Interval>(std::static_pointer_cast<SimpleEvent>(
+            *event->marginal(only_x)->simple_sets->begin())->variable_map->at(x))->contains(10.5));
+
+    // so does an edit that keeps the number of simple events
+    auto moved = std::make_shared<VariableMap>();
+    moved->insert({x, closed(20, 21)});
+    moved->insert({y, closed(0, 1)});
+    event->simple_sets->erase(make_shared_simple_event(map));
+    event->simple_sets->insert(make_shared_simple_event(moved));
+    auto moved_x = std::make_shared<VariableMap>();
+    moved_x->insert({x, closed_open(0, 4)->union_with(closed(20, 21))});
+    ASSERT_EQ(*event->marginal(only_x)->simplify(), *make_shared_event(make_shared_simple_event(moved_x)));
+
+    // projections that differ only in their borders are both kept
+    auto first = std::make_shared<VariableMap>();
+    first->insert({x, closed(0, 1)});
+    first->insert({y, closed_open(0, 1)});
+    auto second = std::make_shared<VariableMap>();
+    second->insert({x, closed_open(0, 1)});
+    second->insert({y, closed(1, 2)});
+    auto borders = make_shared_simple_set_set();
+    borders->insert(make_shared_simple_event(first));
+    borders->insert(make_shared_simple_event(second));
+    auto border_map = std::make_shared<VariableMap>();
+    border_map->insert({x, closed(0, 1)});
+    ASSERT_EQ(*make_shared_event(borders)->marginal(only_x), *make_shared_event(make_shared_simple_event(border_map)));
+}
+
+TEST(ProductAlgebra, RemoveDominated) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    // a containing a symbol and a box inside of it
+    auto outer_map = std::make_shared<VariableMap>();
+    outer_map->insert({x, closed(0, 10)});
+    outer_map->insert({a, a->domain});
+    auto outer = make_shared_simple_event(outer_map);
+    auto inner_map = std::make_shared<VariableMap>();
+    inner_map->insert({x, closed(2, 3)->union_with(open(5, 6))});
+    inner_map->insert({a, make_shared_set(s1, all_elements_int)});
+    auto inner = make_shared_simple_event(inner_map);
+    ASSERT_TRUE(inner->is_subset_of(outer));
+    ASSERT_FALSE(outer->is_subset_of(inner));
+
+    // y is missing in outer, hence unconstrained
+    inner_map->insert({y, closed(0, 1)});
+    ASSERT_TRUE(inner->is_subset_of(outer));
+    ASSERT_FALSE(outer->is_subset_of(inner));
+
+    // 20 rules, every one of them repeated by two nested copies
+    auto rules = make_shared_simple_set_set();
+    for (int k = 0; k < 20; ++k) {
+        for (int shrink = 0; shrink < 3; ++shrink) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({x, closed(3 * k + shrink * 0.25, 3 * k + 2 - shrink * 0.25)});
+            map->insert({y, closed_open(k % 4 + shrink * 0.25, k % 4 + 4)});
+            rules->insert(make_shared_simple_event(map));
+        }
+    }
+    auto event = make_shared_event(rules);
+    ASSERT_EQ(event->remove_dominated_simple_sets(), 40);
+    ASSERT_EQ(event->simple_sets->size(), 20);
+
+    // unions report the pruning
+    auto &statistics = operation_statistics();
+    statistics.reset();
+    auto first_half = make_shared_simple_set_set();
+    auto second_half = make_shared_simple_set_set();
+    for (int k = 0; k < 20; ++k) {
+        for (int shrink = 0; shrink < 3; ++shrink) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({x, closed(3 * k + shrink * 0.25, 3 * k + 2 - shrink * 0.25)});
+            map->insert({y, closed_open(k % 4 + shrink * 0.25, k % 4 + 4)});
+            (shrink == 0 ? first_half : second_half)->insert(make_shared_simple_event(map));
+        }
+    }
+    auto united = make_shared_event(make_shared_simple_set_set(*first_half))->union_with(
+            make_shared_event(second_half));
+    // nested unions of the assignments are counted as well
+    ASSERT_GE(statistics.union_calls, 1);
+    ASSERT_GE(statistics.union_inputs, 60);
+    ASSERT_GE(statistics.dominated_removed, 40);
+    auto expected = make_shared_event(first_half);
+    ASSERT_TRUE(united->is_disjoint());
+    ASSERT_TRUE(united->difference_with(expected)->is_empty());
+    ASSERT_TRUE(expected->difference_with(united)->is_empty());
+}
+
+TEST(ProductAlgebra, HullFastPaths) {
+    auto x = make_shared_continuous("x");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    auto make_box = [&](double lower, double upper, const SetElementPtr_t &element) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed(lower, upper)});
+        map->insert({a, make_shared_set(element, all_elements_int)});
+        return make_shared_event(make_shared_simple_event(map));
+    };
+
+    auto left = make_box(0, 1, s0)->union_with(make_box(0.5, 2, s1));
+    ASSERT_TRUE(left->is_known_disjoint());
+    auto hull = std::static_pointer_cast<SimpleEvent>(left->get_hull());
+    ASSERT_EQ(*hull->variable_map->at(x), *closed(0, 2));
+    ASSERT_EQ(hull->variable_map->at(a)->simple_sets->size(), 2);
+
+    auto &statistics = operation_statistics();
+    statistics.reset();
+
+    // apart on x; comparing the hulls uses the fast paths of the assignments as well
+    auto right = make_box(3, 4, s0);
+    auto united = left->union_with(right);
+    ASSERT_GE(statistics.hull_fast_paths, 1);
+    ASSERT_EQ(united->simple_sets->size(), left->simple_sets->size() + 1);
+    ASSERT_TRUE(united->is_disjoint());
+
+    // overlapping on x, apart on a
+    auto other = make_box(0, 2, s2);
+    auto before = statistics.hull_fast_paths.load();
+    ASSERT_TRUE(left->intersection_with(other)->is_empty());
+    ASSERT_EQ(*left->difference_with(other), *left);
+    ASSERT_GE(statistics.hull_fast_paths, before + 2);
+
+    // overlapping hulls take the regular path
+    auto overlapping = make_box(1.5, 3, s1);
+    auto intersection = left->intersection_with(overlapping);
+    ASSERT_EQ(intersection->simple_sets->size(), 1);
+    ASSERT_EQ(*intersection, *make_box(1.5, 2, s1));
+}
+
+TEST(ProductAlgebra, Predicates) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    auto make_box = [&](double x_lower, double x_upper, double y_lower, double y_upper, const SetElementPtr_t &element) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed_open(x_lower, x_upper)});
+        map->insert({y, closed_open(y_lower, y_upper)});
+        map->insert({a, make_shared_set(element, all_elements_int)});
+        return make_shared_simple_event(map);
+    };
+
+    // simple events
+    EXPECT_TRUE(make_box(0, 2, 0, 2, s0)->intersects(make_box(1, 3, 1, 3, s0)));
+    EXPECT_FALSE(make_box(0, 2, 0, 2, s0)->intersects(make_box(1, 3, 1, 3, s1)));
+    EXPECT_TRUE(make_box(0, 1, 0, 1, s0)->is_disjoint_from(make_box(1, 2, 0, 1, s0)));
+    auto only_x = std::make_shared<VariableMap>();
+    only_x->insert({x, closed(0.5, 0.7)});
+    EXPECT_TRUE(make_box(0, 1, 0, 1, s0)->intersects(make_shared_simple_event(only_x)));
+
+    // events; the left half and the right half cover the square together
+    auto halves = make_shared_simple_set_set();
+    halves->insert(make_box(0, 1, 0, 2, s0));
+    halves->insert(make_box(1, 2, 0, 2, s0));
+    auto square = make_shared_event(halves);
+    auto middle = make_shared_event(make_box(0.5, 1.5, 0.5, 1.5, s0));
+    auto sticking_out = make_shared_event(make_box(0.5, 2.5, 0.5, 1.5, s0));
+    auto other_symbol = make_shared_event(make_box(0.5, 1.5, 0.5, 1.5, s1));
+
+    EXPECT_TRUE(middle->is_subset_of(square));
+    EXPECT_TRUE(square->contains(middle));
+    EXPECT_FALSE(sticking_out->is_subset_of(square));
+    EXPECT_FALSE(other_symbol->is_subset_of(square));
+    EXPECT_TRUE(square->intersects(sticking_out));
+    EXPECT_TRUE(square->is_disjoint_from(other_symbol));
+
+    // the same answers with an index
+    square->build_index();
+    EXPECT_TRUE(middle->is_subset_of(square));
+    EXPECT_TRUE(square->is_disjoint_from(other_symbol));
+    EXPECT_TRUE(sticking_out->intersects(square));
+}
+
+TEST(ProductAlgebra, FingerprintOrdering) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), all_elements_int);
+
+    auto make_box = [&](const AbstractCompositeSetPtr_t &x_assignment, const SetElementPtr_t &element) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, x_assignment});
+        map->insert({a, make_shared_set(element, all_elements_int)});
+        return make_shared_simple_event(map);
+    };
+
+    // equivalent simple events have equal fingerprints, border types do not take part in ordering
+    EXPECT_EQ(make_box(closed(0, 1), s0)->fingerprint(), make_box(closed(0, 1), s0)->fingerprint());
+    EXPECT_EQ(make_box(closed(0, 1), s0)->fingerprint(), make_box(open(0, 1), s0)->fingerprint());
+    EXPECT_NE(make_box(closed(0, 1), s0)->fingerprint(), make_box(closed(0, 1), s1)->fingerprint());
+    EXPECT_TRUE(*make_box(closed(0, 1), s0) == *make_box(closed(0, 1), s0));
+    EXPECT_FALSE(*make_box(closed(0, 1), s0) == *make_box(closed(0, 2), s0));
+
+    // overwriting or modifying an assignment in place recomputes the fingerprint
+    auto edited = make_box(closed(0, 1), s0);
+    auto before = edited->fingerprint();
+    (*edited->variable_map)[x] = closed(5, 6);
+    EXPECT_EQ(edited->fingerprint(), make_box(closed(5, 6), s0)->fingerprint());
+    auto x_assignment = edited->variable_map->at(x);
+    x_assignment->simple_sets->erase(x_assignment->simple_sets->begin());
+    x_assignment->simple_sets->insert(SimpleInterval::make_shared(0, 1, BorderType::CLOSED, BorderType::CLOSED));
+    EXPECT_EQ(edited->fingerprint(), before);
+    edited->variable_map = std::make_shared<VariableMap>(*make_box(closed(0, 1), s1)->variable_map);
+    EXPECT_EQ(edited->fingerprint(), make_box(closed(0, 1), s1)->fingerprint());
+
+    // the ordering is strict and consistent
+    std::vector<AbstractSimpleSetPtr_t> boxes;
+    for (int k = 0; k < 30; ++k) {
+        boxes.push_back(make_box(closed(k % 5, k % 5 + 1)->union_with(closed(k, k + 10)), k % 2 ? s0 : s2));
+    }
+    for (auto const &lhs : boxes) {
+        EXPECT_FALSE(*lhs < *lhs);
+        for (auto const &rhs : boxes) {
+            EXPECT_FALSE(*lhs < *rhs && *rhs < *lhs);
+        }
+    }
+    auto simple_events = make_shared_simple_set_set(boxes.begin(), boxes.end());
+    simple_events->insert(make_box(closed(0, 1)->union_with(closed(0, 10)), s2));
+    EXPECT_EQ(simple_events->size(), 30);
+
+    // filling missing variables changes the fingerprints, the event stays searchable
+    auto with_y = std::make_shared<VariableMap>();
+    with_y->insert({x, closed(100, 101)});
+    with_y->insert({y, closed(0, 1)});
+    simple_events->insert(make_shared_simple_event(with_y));
+    auto event = make_shared_event(simple_events);
+    EXPECT_EQ(event->simple_sets->size(), 31);
+    for (auto const &simple_set : *event->simple_sets) {
+        EXPECT_EQ(event->simple_sets->count(simple_set), 1);
+        EXPECT_EQ(std::static_pointer_cast<SimpleEvent>(simple_set)->variable_map->size(), 3);
+    }
+}
+
+TEST(ProductAlgebra, FillMissingVariablesCopiesOnWrite) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    auto map = std::make_shared<VariableMap>();
+    map->insert({x, closed(0, 1)});
+    auto shared = make_shared_simple_event(map);
+    auto other = make_shared_simple_event(*shared);
+
+    // filling one simple event leaves the shared map and the other simple event alone
+    shared->fill_missing_variables(make_shared_variable_set(VariableSet{x, y}));
+    EXPECT_EQ(shared->variable_map->size(), 2);
+    EXPECT_EQ(map->size(), 1);
+    EXPECT_EQ(other->variable_map, map);
+
+    // events that share a simple event do not see each other filling it
+    auto simple_events = make_shared_simple_set_set();
+    simple_events->insert(other);
+    auto first = make_shared_event(make_shared_simple_set_set(*simple_events));
+    auto second = make_shared_event(make_shared_simple_set_set(*simple_events));
+    first->fill_missing_variables(make_shared_variable_set(VariableSet{x, y}));
+    EXPECT_EQ(std::static_pointer_cast<SimpleEvent>(*first->simple_sets->begin())->variable_map->size(), 2);
+    EXPECT_EQ(std::static_pointer_cast<SimpleEvent>(*second->simple_sets->begin())->variable_map->size(), 1);
+    EXPECT_EQ(other->variable_map->size(), 1);
+
+    // operations do not return their operands
+    auto empty = make_shared_event();
+    EXPECT_NE(second->union_with(empty).get(), second.get());
+    EXPECT_NE(second->difference_with(empty).get(), second.get());
+}
+
+TEST(ProductAlgebra, ConcurrentReadOnlyQueries) {
+    auto x = make_shared_continuous("x");
+    auto y = make_shared_continuous("y");
+
+    auto make_box = [&](double x_lower, double y_lower) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, closed(x_lower, x_lower + 2)});
+        map->insert({y, closed(y_lower, y_lower + 2)});
+        return make_shared_simple_event(map);
+    };
+
+    // one shared rule base and a few queries
+    auto rules = make_shared_simple_set_set();
+    for (int k = 0; k < 40; ++k) {
+        rules->insert(make_box(k % 7, k / 7));
+    }
+    const AbstractCompositeSetPtr_t rule_base = make_shared_event(rules)->make_disjoint();
+    std::vector<AbstractCompositeSetPtr_t> queries;
+    for (int k = 0; k < 8; ++k) {
+        queries.push_back(make_shared_event(make_box(k, k / 2.)));
+    }
+
+    // the answers to a query
+    auto answer = [](const AbstractCompositeSetPtr_t &base, const AbstractCompositeSetPtr_t &query) {
+        return std::vector<std::uint64_t>{
+                base->intersection_with(query)->fingerprint(),
+                base->difference_with(query)->fingerprint(),
+                query->difference_with(base)->fingerprint(),
+                base->intersects(query),
+                query->is_subset_of(base),
+                base->is_empty(),
+                base->get_hull()->fingerprint(),
+                base->fingerprint()};
+    };
+
+    std::vector<std::vector<std::uint64_t>> expected;
+    for (auto const &query : queries) {
+        expected.push_back(answer(rule_base, query));
+    }
+    auto rule_base_size = rule_base->simple_sets->size();
+
+    // many threads query the same rule base, starting with cold caches
+    AbstractCompositeSetPtr_t shared_base = make_shared_event(make_shared_simple_set_set(*rule_base->simple_sets));
+    std::vector<std::vector<std::vector<std::uint64_t>>> answers(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < answers.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int repetition = 0; repetition < 5; ++repetition) {
+                for (auto const &query : queries) {
+                    answers[t].push_back(answer(shared_base, query));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto const &thread_answers : answers) {
+        ASSERT_EQ(thread_answers.size(), 5 * queries.size());
+        for (size_t k = 0; k < thread_answers.size(); ++k) {
+            EXPECT_EQ(thread_answers[k], expected[k % queries.size()]);
+        }
+    }
+    EXPECT_EQ(shared_base->simple_sets->size(), rule_base_size);
+    EXPECT_EQ(rule_base->simple_sets->size(), rule_base_size);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "refinement.h"
+#include "product_algebra.h"
+#include "interval.h"
+#include "set.h"
+#include "variable.h"
+#include <memory>
+
+auto refinement_elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+auto refinement_x = make_shared_continuous("x");
+auto refinement_y = make_shared_continuous("y");
+auto refinement_a = make_shared_symbolic(std::make_shared<std::string>("a"), refinement_elements);
+
+EventPtr_t make_refinement_box(double x_lower, double x_upper, double y_lower, double y_upper, int element) {
+    auto map = std::make_shared<VariableMap>();
+    map->insert({refinement_x, closed(x_lower, x_upper)});
+    map->insert({refinement_y, closed_open(y_lower, y_upper)});
+    map->insert({refinement_a, make_shared_set(make_shared_set_element(element, refinement_elements),
+                                               refinement_elements)});
+    return make_shared_event(make_shared_simple_event(map));
+}
+
+EventPtr_t make_refinement_interval(const IntervalPtr_t &interval) {
+    auto map = std::make_shared<VariableMap>();
+    map->insert({refinement_x, interval});
+    return make_shared_event(make_shared_simple_event(map));
+}
+
+TEST(CommonRefinement, OneDimensional) {
+    auto first = make_refinement_interval(closed(0, 2));
+    auto second = make_refinement_interval(closed(1, 3));
+
+    auto atoms = common_refinement({first, second});
+    ASSERT_EQ(atoms.size(), 4);
+
+    // atoms are ordered by signature: outside, only second, only first, both
+    ASSERT_EQ(atoms[0].signature, (std::vector<bool>{false, false}));
+    ASSERT_EQ(atoms[0].event->simple_sets->size(), 1);
+    ASSERT_EQ(*atoms[1].event, *make_refinement_interval(open_closed(2, 3)));
+    ASSERT_EQ(*atoms[2].event, *make_refinement_interval(closed_open(0, 1)));
+    ASSERT_EQ(*atoms[3].event, *make_refinement_interval(closed(1, 2)));
+
+    ASSERT_EQ(common_refinement({first, second}, false).size(), 3);
+}
+
+TEST(CommonRefinement, AtomsRespectEvents) {
+    std::vector<EventPtr_t> events;
+    for (int k = 0; k < 6; ++k) {
+        auto event = make_refinement_box(k, k + 3, 2 * k, 2 * k + 5, k % 3)->union_with(
+                make_refinement_box(10 - k, 12 - k, 0, 1, (k + 1) % 3));
+        events.push_back(std::static_pointer_cast<Event>(event));
+    }
+
+    auto atoms = common_refinement(events);
+    ASSERT_GT(atoms.size(), 2);
+
+    auto whole = make_refinement_box(0, 0, 0, 0, 0)->complement()->union_with(make_refinement_box(0, 0, 0, 0, 0));
+    AbstractCompositeSetPtr_t covered = make_shared_event();
+    for (size_t k = 0; k < atoms.size(); ++k) {
+        auto const &atom = atoms[k];
+        ASSERT_FALSE(atom.event->is_empty());
+
+        // every atom is inside or outside of every event
+        for (size_t label = 0; label < events.size(); ++label) {
+            if (atom.signature[label]) {
+                ASSERT_TRUE(atom.event->difference_with(events[label])->is_empty());
+            } else {
+                ASSERT_TRUE(atom.event->intersection_with(events[label])->is_empty());
+            }
+        }
+
+        // atoms are pairwise disjoint and consist of disjoint simple events
+        ASSERT_TRUE(atom.event->is_disjoint());
+        ASSERT_TRUE(covered->intersection_with(atom.event)->is_empty());
+        covered = covered->union_with(atom.event);
+    }
+
+    // the atoms cover the whole space
+    ASSERT_TRUE(whole->difference_with(covered)->is_empty());
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "interval.h"
+#include "serialization.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+// Helper: An event over a continuous, an integer and a symbolic variable.
+static EventPtr_t mixed_event(int count) {
+    auto x = make_shared_continuous("x");
+    auto n = make_shared_integer("n");
+    auto elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+    auto a = make_shared_symbolic(std::make_shared<std::string>("a"), elements);
+    auto simple_events = make_shared_simple_set_set();
+    for (int k = 0; k < count; ++k) {
+        auto map = std::make_shared<VariableMap>();
+        map->insert({x, open_closed(k * 0.25, k * 0.25 + 1)});
+        map->insert({n, closed(k, k + 3)});
+        map->insert({a, make_shared_set(make_shared_set_element(k % 3, elements), elements)});
+        simple_events->insert(make_shared_simple_event(map));
+    }
+    return make_shared_event(simple_events);
+}
+
+TEST(Serialization, IntervalRoundTrip) {
+    auto interval = closed(-3, 5)->union_with(open(7.5, std::numeric_limits<double>::infinity()));
+    auto interval_ = std::dynamic_pointer_cast<Interval>(interval);
+    auto restored = deserialize(serialize(interval_));
+    ASSERT_NE(std::dynamic_pointer_cast<Interval>(restored), nullptr);
+    ASSERT_EQ(restored->simple_sets->size(), interval_->simple_sets->size());
+    for (size_t k = 0; k < restored->simple_sets->size(); ++k) {
+        EXPECT_TRUE(*(*restored->simple_sets)[k] == *(*interval_->simple_sets)[k]);
+    }
+
+    // small integral endpoints take one byte each, infinite ones none
+    EXPECT_LT(serialize(closed(1, 2)).size(), 12u);
+    EXPECT_EQ(deserialize(serialize(empty()))->simple_sets->size(), 0u);
+    auto zero = deserialize(serialize(singleton(-0.)));
+    EXPECT_TRUE(std::signbit(std::static_pointer_cast<SimpleInterval>((*zero->simple_sets)[0])->lower));
+}
+
+TEST(Serialization, SetAndEventRoundTrip) {
+    auto elements = make_shared_all_elements(std::set<long long>{-5, 4, 1000});
+    auto set = make_shared_set(make_shared_set_element(2, elements), elements);
+    auto restored_set = std::dynamic_pointer_cast<Set>(deserialize(serialize(set)));
+    ASSERT_NE(restored_set, nullptr);
+    EXPECT_EQ(*restored_set->all_elements, *elements);
+    EXPECT_TRUE(restored_set->contains(2));
+
+    auto event = std::dynamic_pointer_cast<Event>(mixed_event(5)->make_disjoint());
+    auto restored = std::dynamic_pointer_cast<Event>(deserialize(serialize(event)));
+    ASSERT_NE(restored, nullptr);
+    EXPECT_TRUE(restored->is_known_disjoint());
+    expect_equivalent(restored, event);
+
+    // the variables keep their kinds
+    auto variables = restored->get_variables_from_simple_events();
+    EXPECT_EQ(variables.size(), 3u);
+    for (auto const &variable : variables) {
+        if (*variable->name == "n") {
+            EXPECT_NE(std::dynamic_pointer_cast<Integer>(variable), nullptr);
+        }
+    }
+}
+
+TEST(Serialization, StreamSharesDictionaries) {
+    auto event = mixed_event(3);
+    auto simple_event = std::static_pointer_cast<SimpleEvent>((*event->simple_sets)[0]);
+
+    std::stringstream stream;
+    Serializer serializer(stream);
+    serializer.write(make_shared_variable_set(event->get_variables_from_simple_events()));
+    auto after_schema = stream.str().size();
+    serializer.write(simple_event);
+    auto first = stream.str().size() - after_schema;
+    serializer.write(event);
+
+    // once the schema is known, a simple event only references its variables and universes
+    EXPECT_LT(first, 24u);
+
+    Deserializer deserializer(stream);
+    EXPECT_EQ(deserializer.next_kind(), RecordKind::VARIABLES);
+    auto variables = deserializer.read_variables();
+    EXPECT_EQ(variables->size(), 3u);
+    auto restored_simple_event = deserializer.read_simple_event();
+    EXPECT_TRUE(*restored_simple_event == *simple_event);
+    EXPECT_EQ(restored_simple_event->variable_map->begin()->first, *variables->begin());
+    expect_equivalent(deserializer.read_set(), event);
+    EXPECT_TRUE(deserializer.at_end());
+}
+
+TEST(Serialization, RejectsMalformedData) {
+    auto data = serialize(mixed_event(2));
+    EXPECT_THROW(deserialize("XYZ"), std::invalid_argument);
+    EXPECT_THROW(deserialize(data.substr(0, data.size() - 3)), std::invalid_argument);
+
+    auto newer = data;
+    newer[3] = 2;
+    EXPECT_THROW(deserialize(newer), std::invalid_argument);
+
+    // a huge declared length behind the header of a record fails on the missing bytes, it is not allocated
+    for (std::uint64_t length: {std::uint64_t{1} << 40, std::uint64_t{1} << 62, ~std::uint64_t{0} >> 1}) {
+        auto huge = data.substr(0, 4);
+        huge.push_back(static_cast<char>(RecordKind::INTERVAL));
+        for (; length >= 0x80; length >>= 7) {
+            huge.push_back(static_cast<char>((length & 0x7F) | 0x80));
+        }
+        huge.push_back(static_cast<char>(length));
+        huge += "\x01\x02\x03";
+        EXPECT_THROW(deserialize(huge), std::invalid_argument);
+    }
+
+    std::stringstream stream;
+    Serializer(stream).write(closed(0, 1));
+    Deserializer deserializer(stream);
+    EXPECT_THROW(deserializer.read_simple_event(), std::invalid_argument);
+}
@@ -44,6 +44,23 @@ TEST(SetElement, Complement) {
     EXPECT_EQ(result->count(set_element2), 1);
 }
 
+TEST(SetElement, DifferenceWith) {
+    AllSetElementsPtr_t all_elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+    auto set_element1 = make_shared_set_element(1, all_elements);
+    auto set_element2 = make_shared_set_element(2, all_elements);
+    auto set_element3 = make_shared_set_element(1, all_elements);
+
+    auto result = set_element1->difference_with(set_element2);
+    EXPECT_EQ(result->size(), 1);
+    EXPECT_EQ(*result->begin(), set_element1);
+
+    result = set_element1->difference_with(set_element3);
+    EXPECT_TRUE(result->empty());
+
+    auto empty_element = make_shared_set_element(all_elements);
+    EXPECT_TRUE(empty_element->difference_with(set_element1)->empty());
+}
+
 TEST(Set, Simplify){
     AllSetElementsPtr_t all_elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
     auto set_element1 = make_shared_set_element(1, all_elements);
@@ -93,4 +110,27 @@ TEST(Set, UnionWith){
     auto element = make_shared_set_element(0, all_elements);
     auto a_ = a->union_with(element);
     EXPECT_EQ(a_->simple_sets->size(), 1);
-}
\ No newline at end of file
+}
+TEST(Set, Predicates){
+    auto all_elements = make_shared_all_elements(std::set<long long>{0, 1, 2, 3});
+    auto ab = make_shared_set(all_elements);
+    ab->add_new_simple_set(make_shared_set_element(0, all_elements));
+    ab->add_new_simple_set(make_shared_set_element(1, all_elements));
+    auto bcd = make_shared_set(all_elements);
+    bcd->add_new_simple_set(make_shared_set_element(1, all_elements));
+    bcd->add_new_simple_set(make_shared_set_element(2, all_elements));
+    bcd->add_new_simple_set(make_shared_set_element(3, all_elements));
+    auto d = make_shared_set(make_shared_set_element(3, all_elements), all_elements);
+    auto empty = make_shared_set(all_elements);
+
+    EXPECT_TRUE(ab->intersects(bcd));
+    EXPECT_FALSE(ab->intersects(d));
+    EXPECT_TRUE(ab->is_disjoint_from(d));
+    EXPECT_FALSE(ab->intersects(empty));
+
+    EXPECT_TRUE(d->is_subset_of(bcd));
+    EXPECT_FALSE(ab->is_subset_of(bcd));
+    EXPECT_TRUE(empty->is_subset_of(d));
+    EXPECT_TRUE(bcd->contains(d));
+    EXPECT_FALSE(d->contains(bcd));
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "spatial_index.h"
+#include "product_algebra.h"
+#include "interval.h"
+#include "set.h"
+#include "variable.h"
+#include <memory>
+
+auto grid_elements = make_shared_all_elements(std::set<long long>{0, 1, 2});
+auto grid_x = make_shared_continuous("x");
+auto grid_y = make_shared_continuous("y");
+auto grid_a = make_shared_symbolic(std::make_shared<std::string>("a"), grid_elements);
+
+// A 10 x 10 grid of unit boxes, alternating the symbol between 0 and 1
+EventPtr_t make_grid_event() {
+    auto simple_events = make_shared_simple_set_set();
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            auto map = std::make_shared<VariableMap>();
+            map->insert({grid_x, closed_open(i, i + 1)});
+            map->insert({grid_y, closed_open(j, j + 1)});
+            map->insert({grid_a, make_shared_set(make_shared_set_element((i + j) % 2, grid_elements), grid_elements)});
+            simple_events->insert(make_shared_simple_event(map));
+        }
+    }
+    return make_shared_event(simple_events);
+}
+
+SimpleEventPtr_t make_query(double x_lower, double x_upper, double y_lower, double y_upper) {
+    auto map = std::make_shared<VariableMap>();
+    map->insert({grid_x, closed(x_lower, x_upper)});
+    map->insert({grid_y, closed(y_lower, y_upper)});
+    map->insert({grid_a, grid_a->domain});
+    return make_shared_simple_event(map);
+}
+
+TEST(SpatialIndex, OverlappingIsSupersetOfIntersecting) {
+    auto event = make_grid_event();
+    auto index = make_shared_spatial_index(event->simple_sets);
+    ASSERT_EQ(index->size(), 100);
+    ASSERT_TRUE(index->is_built_from(event->simple_sets));
+
+    auto query = make_query(2.5, 4.5, 7.5, 8.5);
+    auto candidates = index->overlapping(query);
+
+    size_t intersecting = 0;
+    for (const auto &simple_event: *event->simple_sets) {
+        if (!simple_event->intersection_with(query)->is_empty()) {
+            ++intersecting;
+            ASSERT_NE(std::find(candidates.begin(), candidates.end(), simple_event), candidates.end());
+        }
+    }
+    ASSERT_EQ(intersecting, 6);
+    // the closed hull of [x, x + 1) touches the next box, nothing beyond that
+    ASSERT_LE(candidates.size(), 12);
+}
+
+TEST(SpatialIndex, Containing) {
+    auto event = make_grid_event();
+    auto index = make_shared_spatial_index(event->simple_sets);
+    ASSERT_EQ(index->get_variables().size(), 3);
+
+    // variables are name ordered: a, x, y
+    auto inside = index->containing({1, 3.5, 4.5});
+    ASSERT_EQ(inside.size(), 1);
+    ASSERT_TRUE(std::static_pointer_cast<Interval>(
+            std::static_pointer_cast<SimpleEvent>(inside[0])->variable_map->at(grid_x))->contains(3.5));
+
+    // the symbol of box (3, 4) is 1, not 0
+    ASSERT_TRUE(index->containing({0, 3.5, 4.5}).empty());
+
+    // right borders are open, so the corner belongs to exactly one box
+    ASSERT_EQ(index->containing({0, 3, 3}).size(), 1);
+    ASSERT_THROW(index->containing({0, 3}), std::invalid_argument);
+}
+
+TEST(SpatialIndex, IndexedEventOperations) {
+    auto event = make_grid_event();
+    auto indexed = make_grid_event();
+    indexed->build_index();
+    ASSERT_NE(indexed->get_index(), nullptr);
+
+    auto other = make_shared_event(make_query(2.5, 4.5, 7.5, 8.5));
+
+    auto intersection = event->intersection_with(other);
+    auto indexed_intersection = indexed->intersection_with(other);
+    ASSERT_EQ(*intersection, *indexed_intersection);
+
+    auto difference = other->difference_with(event);
+    auto indexed_difference = other->difference_with(indexed);
+    ASSERT_EQ(*difference, *indexed_difference);
+    ASSERT_TRUE(indexed_difference->intersection_with(indexed)->is_empty());
+
+    // modifying the simple events makes the index stale
+    indexed->simple_sets->insert(make_query(20, 21, 20, 21));
+    ASSERT_EQ(indexed->get_index(), nullptr);
+
+    // so does an edit that keeps the number of simple events
+    indexed->build_index();
+    indexed->simple_sets->erase(indexed->simple_sets->begin());
+    indexed->simple_sets->insert((*other->simple_sets)[0]);
+    ASSERT_EQ(indexed->get_index(), nullptr);
+    ASSERT_TRUE(other->difference_with(indexed)->is_empty());
+}